@@ -17,6 +17,24 @@
  *	 compiler will detect OS and enable these features for you
  *
  * - Tested with g++ on ubuntu
+ *
+ * - The server and load generator modes use epoll and are linux only.
+ *   Build with threads enabled, e.g. g++ -std=c++17 -O2 -pthread minesweeper.cpp
+ *
+ * - Build with -Dtracing to record where a session spends its time. The trace is written to
+ *   minesweeper.trace.json on exit, or when (t) is pressed during a game, and opens in
+ *   chrome://tracing or Perfetto. Without the flag the tracing code is not compiled at all
+ *
+ * - --fuzz plays random games on every core and checks the rules after every move, and that every square
+ *   matches the ReferenceGame playing the same moves, with the parallel flood turned on. Build with -Dfuzzing
+ *   to drop main() for libFuzzer instead, e.g. clang++ -std=c++17 -g -O1 -Dfuzzing -fsanitize=fuzzer,address
+ *
+ * - Every mode shares one pool of worker threads, one per core. Put --threads <count> and --pin before the
+ *   mode to size it and to tie each worker to its own core (linux and windows)
+ *
+ * - Built as C++20 (-std=c++20) the console's menu, game and result steps are coroutines that wait for keys
+ *   instead of blocking on the keyboard, and --sessions plays thousands of bot or scripted consoles interleaved
+ *   on one thread
  */
 
 #include <iostream>
@@ -26,6 +44,27 @@
 #include <algorithm>
 #include <chrono>
 #include <iomanip>
+#include <memory>
+#include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <sstream>
+#include <iterator>
+#include <random>
+#include <cmath>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <map>
+
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#include <exception>
+#define coroutines
+#endif
 
 #include <time.h>
 
@@ -35,6 +74,8 @@
 #define bash
 #elif defined(__linux__)
 #define bash
+#define epoll_server
+#define core_pinning
 #endif
 
 #ifdef windows
@@ -44,6 +85,40 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <termios.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#endif
+
+#ifdef epoll_server
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#include <string.h>
+#endif
+
+#ifdef core_pinning
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef tracing
+#define TRACE_FILE "minesweeper.trace.json"
+#define TRACE_SCOPE(scope, name, argument) Logic::TraceScope scope(name, argument)
+#define TRACE_VALUE(scope, value) scope.setValue(static_cast<int64_t>(value))
+#define TRACE_COUNTER(name, value) Logic::Tracer::counter(name, static_cast<int64_t>(value))
+#else
+#define TRACE_SCOPE(scope, name, argument)
+#define TRACE_VALUE(scope, value)
+#define TRACE_COUNTER(name, value)
 #endif
 
 constexpr const char* RED = "\u001b[31;1m";
@@ -55,49 +130,122 @@ constexpr const char* YELLOW_HILIGHT = "\u001b[33;1m";
 namespace Logic { // Logic forward declerations
 	// INCOMPLETE CLASS HEADERS
 	class Game; class GameOptions; class GameLoop;  class Board; class Space; class Point;
+	class BoardSnapshot; class GameSnapshot;
+	class PlayerView; class Hint; class Solver; class Advisor; class CancelToken; class WorkerPool;
+	class Constraint; class SampleEstimate; class MineSampler;
+	class DisjointSets; class DifficultyProfile; class DifficultyRater; class OpeningIndex;
+	template <int W, int H> class NeighbourTable; template <int W, int H> class FixedGrid; class SquareGrid; class DynamicGrid;
+	class GameArena; class ArenaScope; template <typename T> class ArenaAllocator;
+	class NeighbourRange; class NeighbourIndex; class GameSerializer;
+	class LayoutCodec; class CorpusWriter; class CorpusReader;
+	class Strategy; class SolverStrategy; class SamplerStrategy; class RandomStrategy;
+	class TournamentGame; class Tournament; class RaceStanding; class Race; class Fuzzer;
+	class ReferenceGame; class DiffAction; class Differential;
+#ifdef tracing
+	class Tracer; class TraceScope;
+#endif
 
 	///////////
 	// ENUMS //
 	///////////
 
-	enum class SpaceType {
+	enum class SpaceType : unsigned char {
 		REVEALED, EMPTY, MINE, EXPLODED_MINE, FLAGGED_MINE, FALSE_FLAG, INVALID
 	};
 
 	enum class ActionResult {
-		OK, INVALID, NO_FLAGS, EXPLODED, ALREADY_REVEALED, NOT_HIDDEN
+		OK, INVALID, NO_FLAGS, EXPLODED, ALREADY_REVEALED, NOT_HIDDEN, NOT_REVEALED, NOT_SATISFIED
 	};
 
 	enum class MinePlacerType {
-		RANDOM
+		RANDOM, PARALLEL_RANDOM
 	};
 
 	enum class GameState {
 		PLAYING, WIN, LOSS
 	};
 
+	enum class HintAction {
+		NONE, REVEAL, FLAG, CHORD
+	};
+
+	enum class Topology {
+		SQUARE, TORUS, HEX, KNIGHT
+	};
+
+	enum class BoardFormat {
+		BINARY, JSON, SAVE
+	};
+
 	// STATELESS FUNCTIONS
 	int64_t currentTimeSeconds();
+	int popCount(unsigned int value);
+	int lowestBit(uint64_t value);
+	double logChoose(int n, int k);
+	int sampleHypergeometric(std::mt19937_64& random, int population, int successes, int draws);
+	std::string topologyName(Topology topology);
+	bool parseTopology(std::string name, Topology& topology);
+	int runCalibration(int argc, char** argv);
+	ActionResult playStrategyMove(Game& game, Strategy& strategy, Hint& played);
+	int runTournament(int argc, char** argv);
+	int runRace(int argc, char** argv);
+	int runFuzz(int argc, char** argv);
+	int runDifferential(int argc, char** argv);
+	int runExport(int argc, char** argv);
+	int runConvert(int argc, char** argv);
+	int runCorpus(int argc, char** argv);
+	int runLayout(int argc, char** argv);
 }
 
 namespace Render { // Render forward declerations
 	// INCOMPLETE CLASS HEADERS
-	class OptionsSelector;
+	class OptionsSelector; class FrameWriter; class TerminalSink; class ScriptedTerminal; class SessionTask;
+#ifdef coroutines
+	class SessionDriver; class KeyboardDriver; class ScriptDriver; class BotDriver; class SessionScheduler;
+#endif
 
 	///////////
 	// ENUMS //
 	///////////
 	enum class RenderType {
-		CONSOLE
+		CONSOLE, HEADLESS
 	};
 
 	enum class SelectionMode {
-		REVEAL, FLAG, NONE
+		REVEAL, FLAG, CHORD, NONE
+	};
+
+	enum class SessionPrompt {
+		MENU, OPTIONS, VALUE, PAGE, COMMAND, TARGET, RESULT, FINISHED
 	};
 
 	// STATELESS FUNCTIONS
 	char getCharacter();
+	bool getTerminalSize(int& columns, int& rows);
+	int runScript(int argc, char** argv);
+#ifdef coroutines
+	std::ostream& nowhere();
+	int runSessions(int argc, char** argv);
+#endif
+}
+
+#ifdef epoll_server
+namespace Server { // Server forward declerations
+	// INCOMPLETE CLASS HEADERS
+	class Address; class Session; class GameServer; class LoadGenerator;
+
+	///////////
+	// ENUMS //
+	///////////
+	enum class AddressType {
+		UNIX, TCP
+	};
+
+	// STATELESS FUNCTIONS
+	int runServer(int argc, char** argv);
+	int runLoadGenerator(int argc, char** argv);
 }
+#endif
 
 namespace Logic { // Logic class declarations
 	////////////////////////
@@ -114,8 +262,79 @@ namespace Logic { // Logic class declarations
 	public:
 		int width, height, mines;
 		MinePlacerType minePlacerType;
+		uint64_t seed = 0; // 0 picks a random seed when the mines are placed
+		Topology topology = Topology::SQUARE;
+		int parallelReveal = 1 << 16; // a cascade this big finishes on every core, 0 keeps it on one thread
+	};
+
+	/* Class Name: GameArena
+	 *
+	 * Class Description:
+	 * This Class is a bump allocator for the storage of one game: board chunks, flood fill queues,
+	 * mine placement and rater scratch. Freeing does nothing; reset() rewinds it between games and keeps
+	 * the blocks, so a thread that plays game after game stops calling malloc once the blocks are big enough.
+	 * Nothing allocated from it, snapshots included, may outlive a reset()
+	 *
+	 * Every thread also has a scratch arena for the Solver and the MineSampler. They take an ArenaScope on it
+	 * for the length of a call, so their working vectors are handed back when the call returns
+	 */
+	class GameArena {
+	private:
+		friend class ArenaScope;
+		static constexpr size_t MAX_SCRATCH = size_t(1) << 24; // a bigger scratch arena is given back once it is idle
+		std::vector<std::unique_ptr<char[]>> blocks;
+		std::vector<size_t> sizes;
+		size_t current, used, blockSize;
+	public:
+		GameArena(size_t blockSize);
+		GameArena(const GameArena&) = delete;
+		GameArena& operator = (const GameArena&) = delete;
+		void* allocate(size_t bytes, size_t alignment);
+		void reset();
+		void release();
+		size_t getCapacity();
+		static GameArena& scratch();
+	};
+
+	/* Class Name: ArenaScope
+	 *
+	 * Class Description:
+	 * This Class rewinds an arena to where it was when the scope began. Scopes on one arena must end in the
+	 * reverse order they began, which blocks on one thread do. The outermost scope resets the arena instead
+	 */
+	class ArenaScope {
+	private:
+		GameArena& arena;
+		size_t current, used;
+	public:
+		ArenaScope(GameArena& arena);
+		ArenaScope(const ArenaScope&) = delete;
+		ArenaScope& operator = (const ArenaScope&) = delete;
+		~ArenaScope();
+	};
+
+	/* Class Name: ArenaAllocator
+	 *
+	 * Class Description:
+	 * This Class lets standard containers and allocate_shared use a GameArena.
+	 * With no arena it falls back to the normal heap, so the same types serve games that do not use one
+	 */
+	template <typename T>
+	class ArenaAllocator {
+	public:
+		using value_type = T;
+		GameArena* arena;
+		ArenaAllocator(GameArena* arena) noexcept;
+		template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) noexcept;
+		T* allocate(size_t count);
+		void deallocate(T* pointer, size_t count) noexcept;
+		template <typename U> bool operator == (const ArenaAllocator<U>& other) const noexcept;
+		template <typename U> bool operator != (const ArenaAllocator<U>& other) const noexcept;
 	};
 
+	template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+	template <typename T> using ArenaDeque = std::deque<T, ArenaAllocator<T>>;
+
 	/* Class Name: Point
 	 *
 	 * Class Description:
@@ -130,17 +349,83 @@ namespace Logic { // Logic class declarations
 		bool operator == (Point p);
 	};
 
+	/* Class Name: TopologyPolicy
+	 *
+	 * Class Description:
+	 * This Class template says which squares neighbour a square. Every Topology is its own specialization,
+	 * run once per board shape to fill a NeighbourIndex, so game code never branches on the topology
+	 */
+	template <Topology T>
+	class TopologyPolicy {
+	public:
+		static int neighbours(int x, int y, int width, int height, int* result);
+	};
+
+	/* Class Name: NeighbourRange
+	 *
+	 * Class Description:
+	 * This Class is the list of neighbours of one square, for use in a range based for loop
+	 */
+	class NeighbourRange {
+	private:
+		const int* first;
+		const int* last;
+	public:
+		NeighbourRange(const int* first, const int* last);
+		const int* begin() const;
+		const int* end() const;
+		int size() const;
+	};
+
+	/* Class Name: NeighbourIndex
+	 *
+	 * Class Description:
+	 * This Class holds the neighbours of every square of a board shape, as square numbers (y * width + x)
+	 * packed one square after another. Tables are built once per width, height and topology and shared
+	 * by every board, view and rater of that shape. A table lives as long as something uses it, and the
+	 * last few shapes up to a million squares are also kept between games so a run of games does not rebuild them.
+	 * The table is split into bands of rows that are filled the first time a square in them is asked
+	 * about, so a huge board only pays for the rows that are actually played.
+	 * forEachNeighbour() walks the beginner, intermediate and expert square boards with FixedGrid instead,
+	 * so the game, solver and advisor loops on those sizes unroll with the offsets known at compile time
+	 */
+	class NeighbourIndex {
+	private:
+		static constexpr int BAND_BITS = 6; // 64 rows to a band
+		static constexpr size_t RECENT_SHAPES = 4;
+		static constexpr long long RECENT_SQUARES = 1 << 20; // bigger tables are freed with their last board
+		struct Band {
+			std::atomic<bool> ready{ false };
+			std::once_flag built;
+			std::vector<int> starts, cells;
+		};
+		int (*policy)(int x, int y, int width, int height, int* result);
+		std::unique_ptr<Band[]> bands;
+		const int* none = nullptr;
+		int preset; // the width of a 9x9, 16x16 or 30x16 square board, 0 for any other shape
+		const Band& band(int row) const;
+	public:
+		const int width, height;
+		const Topology topology;
+		NeighbourIndex(int width, int height, Topology topology);
+		NeighbourRange neighboursOf(int cell) const;
+		NeighbourRange neighboursOf(Point location) const;
+		template <typename Visit> void forEachNeighbour(int cell, Visit visit) const;
+		bool adjacent(int a, int b) const;
+		static std::shared_ptr<const NeighbourIndex> get(int width, int height, Topology topology);
+	};
+
 	/* Class Name: Space
 	 *
 	 * Class Description:
 	 * This Class defines the Space object. This is used for referencing each
 	 * space on the board, getting its location and type.
+	 * The type itself is stored by the Board so that spaces are cheap handles
 	 */
 	class Space {
 	private:
 		Board& board;
 		Point location;
-		SpaceType type;
 	public:
 		Space(Board& board, Point location);
 		int getAdjacentMines();
@@ -153,26 +438,147 @@ namespace Logic { // Logic class declarations
 		void setType(SpaceType type);
 	};
 
+	/* Class Name: DifficultyProfile
+	 *
+	 * Class Description:
+	 * This Class describes how hard a generated board is:
+	 * threeBV is the least number of clicks that clears it, openings the number of connected zero areas,
+	 * forcedGuesses how often the solver rules get stuck, and ruleDepth the strongest rule needed
+	 * (0 when the first click clears the board, 1 for single numbers, 2 when comparing two numbers)
+	 */
+	class DifficultyProfile {
+	public:
+		int threeBV, openings, forcedGuesses, ruleDepth;
+		DifficultyProfile();
+	};
+
+	/* Class Name: BoardSnapshot
+	 *
+	 * Class Description:
+	 * This Class is a saved copy of the squares of a Board. It shares storage with the board
+	 * until either side changes, so taking and restoring one costs the same for any board size
+	 */
+	class BoardSnapshot {
+	private:
+		friend class Board;
+		int width, height;
+		std::shared_ptr<const void> table;
+		std::shared_ptr<std::vector<unsigned char>> overlay;
+		std::shared_ptr<const OpeningIndex> openings;
+		std::array<int, 3> marks;
+		bool counted;
+	public:
+		BoardSnapshot();
+	};
+
 	/* Class Name: Board
 	 *
 	 * Class Description:
 	 * This Class defines the Board object. This is to create each board
 	 *
+	 * The squares are stored row by row in fixed size chunks. Chunks and the table that lists them
+	 * are shared with snapshots and are only copied when they are written while shared (copy-on-write)
+	 *
+	 * The board is not a template on its size. Snapshots, saves, the mmap load and the parallel flood all work on
+	 * the shared chunks whatever the size, and a std::array board per preset would need its own copy of each of them.
+	 * Instead the neighbour loops of the beginner, intermediate and expert sizes go through FixedGrid (see
+	 * NeighbourIndex::forEachNeighbour()), and those boards fit in one chunk, which countAdjacentMines() reads directly
+	 *
+	 * After startOverlay() the chunks are a plane that is never written, and what the board changes is kept as two bits
+	 * a square in an overlay: revealed, flagged or exploded. A race gives each player one over the same plane.
+	 * A change the overlay cannot hold, or anything that writes the chunks directly, turns it back into chunks first
 	 */
 	class Board {
 	private:
+		friend class GameSerializer;
+		friend class CorpusReader;
+		static constexpr int CHUNK_BITS = 12;
+		static constexpr int CHUNK_SIZE = 1 << CHUNK_BITS;
+		class Chunk {
+		public:
+			SpaceType types[CHUNK_SIZE];
+		};
+		class ChunkTable {
+		public:
+			ArenaVector<std::shared_ptr<Chunk>> chunks;
+			ChunkTable(GameArena* arena);
+		};
+		class ChunkCheck { // the chunks of a mapped save file that have not been read yet
+		public:
+			std::unique_ptr<std::atomic<bool>[]> checked;
+			std::mutex mutex;
+			size_t left;
+			std::array<int, 3> expected, marks; // the counts in the header, and those found in the chunks checked so far
+			int mines;
+			bool firstMove;
+			std::atomic<bool> damaged;
+			ChunkCheck(size_t chunks, std::array<int, 3> expected, bool firstMove);
+		};
 		Game& game;
 		GameOptions options;
-		std::vector<std::vector<Space>> cols;
-		Space invalid;
+		GameArena* arena;
+		std::shared_ptr<const NeighbourIndex> neighbours;
+		std::shared_ptr<ChunkTable> table;
+		std::shared_ptr<const OpeningIndex> openings; // set when the mines are placed
+		std::array<int, 3> marks; // how many squares are EXPLODED_MINE, FLAGGED_MINE and FALSE_FLAG
+		bool counted; // false after a load wrote the chunks directly, until marks are counted again
+		std::unique_ptr<ChunkCheck> unchecked; // set by a mapped load, whose chunks are checked the first time they are used
+		std::shared_ptr<std::vector<unsigned char>> overlay; // four squares a byte over the chunks, see startOverlay()
+		DifficultyProfile difficulty;
+		static bool checkChunk(const Chunk& chunk, size_t squares, bool firstMove, std::array<int, 3>& marks, int& mines);
+		void check(size_t chunk);
+		void checkMapped(size_t chunk);
+		SpaceType overlaid(size_t index, SpaceType plane);
+		bool setOverlaid(size_t index, SpaceType plane, SpaceType type);
+		void recount(SpaceType before, SpaceType after);
+		void materialize();
+		bool revealOpening(int opening, int& opened);
+		void flood(ArenaDeque<Point>& pending);
+		int floodParallel(ArenaDeque<Point>& pending);
 	public:
-		Board(Game& game, GameOptions options);
-		Space& getSpaceAt(Point location);
-		Space& getSpaceAt(int x, int y);
+		Board(Game& game, GameOptions options, GameArena* arena);
+		Board(const Board&) = delete;
+		Board& operator = (const Board&) = delete;
+		Space getSpaceAt(Point location);
+		Space getSpaceAt(int x, int y);
+		SpaceType getType(Point location);
+		SpaceType getType(int cell);
+		int countAdjacentMines(int cell);
+		void setType(Point location, SpaceType type);
+		void unshare();
+		bool isDamaged();
+		bool contains(Point location);
+		int countMarked(SpaceType type);
+		int countSharedChunks(BoardSnapshot& snapshot);
+		void startOverlay();
+		size_t getOverlayBytes();
+		void reveal(Point seed);
+		void reveal(std::vector<Point> seeds);
 		int getUsedFlags();
+		GameArena* getArena();
+		const NeighbourIndex& getNeighbours();
 		GameOptions getOptions();
-		std::vector<std::vector<Space>>& getCols();
 		Game& getGame();
+		void setSeed(uint64_t seed);
+		DifficultyProfile getDifficulty();
+		void setDifficulty(DifficultyProfile difficulty);
+		void setOpenings(std::shared_ptr<const OpeningIndex> openings);
+		BoardSnapshot snapshot();
+		bool restore(BoardSnapshot snapshot);
+	};
+
+	/* Class Name: GameSnapshot
+	 *
+	 * Class Description:
+	 * This Class is a saved state of a Game, used for undo and for trying out moves
+	 */
+	class GameSnapshot {
+	private:
+		friend class Game;
+		BoardSnapshot board;
+		bool firstMove;
+	public:
+		GameSnapshot();
 	};
 
 	/* Class Name: Game
@@ -182,6 +588,8 @@ namespace Logic { // Logic class declarations
 	 */
 	class Game {
 	private:
+		friend class GameSerializer;
+		friend class CorpusReader;
 		GameLoop& loop;
 		GameOptions options;
 		Board board;
@@ -189,15 +597,19 @@ namespace Logic { // Logic class declarations
 		int64_t startTime;
 	public:
 		Game(GameLoop& loop, GameOptions options);
+		Game(GameLoop& loop, GameOptions options, GameArena* arena);
 		int getRemainingFlags();
 		ActionResult clickSpace(Point location);
 		ActionResult flagSpace(Point location);
+		ActionResult chordSpace(Point location);
 		Board& getBoard();
 		GameOptions getOptions();
 		GameState getState();
 		int64_t getStartTime();
 		GameLoop& getLoop();
 		bool isFirstMove();
+		GameSnapshot snapshot();
+		bool restore(GameSnapshot snapshot);
 	};
 
 	/* Class Name: MinePlacer
@@ -218,10 +630,16 @@ namespace Logic { // Logic class declarations
 	/* Class Name: RandomMinePlacer
 	 *
 	 * Class Description:
-	 * This Class is a derived class of Mineplacer and places all the mines on the board
+	 * This Class is a derived class of Mineplacer and places all the mines on the board.
+	 * With MinePlacerType::PARALLEL_RANDOM the board is cut into tiles that are filled at the same time,
+	 * giving a different layout for a seed than RANDOM but the same one on any number of threads
 	 *
 	 */
 	class RandomMinePlacer : MinePlacer {
+	private:
+		static constexpr int TILE_CELLS = 1 << 16; // a whole number of board chunks
+		void placeTiles(int minesToPlace, Point clear, uint64_t seed);
+		void rate(Point clear);
 	public:
 		RandomMinePlacer(Board& board);
 		void placeMines(Logic::Point clear);
@@ -237,13 +655,16 @@ namespace Logic { // Logic class declarations
 	private:
 		Render::RenderType renderType;
 		Render::OptionsSelector* optionsSelector;
+		Render::ScriptedTerminal* terminal; // a console loop played from a script, nullptr for the keyboard
 		std::vector<int64_t> winTimes, lossTimes;
 		int wins, losses, flagged, exploded, revealed;
 	public:
 		GameLoop(Render::RenderType renderType);
+		GameLoop(Render::RenderType renderType, Render::ScriptedTerminal* terminal);
 		~GameLoop();
 		void start();
 		void addRevealed();
+		void addRevealed(int count);
 		void addExploded();
 		void addFlagged();
 		void addWin(int64_t time);
@@ -255,1456 +676,11989 @@ namespace Logic { // Logic class declarations
 		int getFlagged();
 		int getExploded();
 		int getRevealed();
+		WorkerPool& getScheduler();
 	};
-}
-
-namespace Render { // Render class declarations
-	////////////////////////
-	// CLASS DECLARATIONS //
-	////////////////////////
 
-	/* Class Name: Renderer
+	/* Class Name: PlayerView
 	 *
 	 * Class Description:
-	 * This virtual Class renders is the base class to keep all inputs and outputs and keeps it organized
-	 *
+	 * This Class is a copy of what a player can see of a board: hidden squares, flags and the
+	 * numbers on revealed squares. Solvers and bots only ever work from this view, never the Board
+	 */
+	class PlayerView {
+	public:
+		static constexpr signed char HIDDEN = -1;
+		static constexpr signed char FLAG = -2;
+		static constexpr signed char MINE = -3;
+		int width, height, mines;
+		std::vector<signed char> cells;
+		std::shared_ptr<const NeighbourIndex> neighbours;
+		PlayerView(int width, int height, int mines, Topology topology);
+		PlayerView(Board& board);
+		signed char at(int x, int y);
+		std::string encode();
+		static bool decode(int width, int height, int mines, std::string text, PlayerView& view);
+	};
+
+	/* Class Name: Hint
 	 *
+	 * Class Description:
+	 * This Class is a suggested move produced by the Solver
 	 */
-	class Renderer {
+	class Hint {
 	public:
-		virtual ~Renderer();
-		virtual void initializeRender() = 0;
-		virtual void drawBoard(Logic::Game& game) = 0;
-		virtual bool promptForInput(Logic::Game& game) = 0;
-		virtual void clear() = 0;
-		virtual bool promptPlayAgain() = 0;
-		virtual bool hasAdvancedRendering() = 0;
-		virtual void displayStats(Logic::GameLoop& loop) = 0;
-		virtual void playGame(Logic::GameLoop& loop, Logic::Game& game) = 0;
-		virtual void displayMenu(Logic::GameLoop& loop) = 0;
+		HintAction action;
+		Point location;
+		bool certain;
+		double mineProbability;
+		Hint();
+		Hint(HintAction action, Point location, bool certain, double mineProbability);
 	};
 
-	/* Class Name: ConsoleRenderer
+	/* Class Name: Constraint
 	 *
 	 * Class Description:
-	 * This derived Class is derived from the Renderer Class and renders all inputs and outputs and keeps it organized
+	 * This Class is what one revealed number says about its hidden neighbours:
+	 * exactly need of the listed squares are mines
+	 */
+	class Constraint {
+	public:
+		int source, need;
+		ArenaVector<int> cells;
+		Constraint(GameArena* arena);
+	};
+
+	/* Class Name: Solver
 	 *
+	 * Class Description:
+	 * This Class finds the next move from a PlayerView using the counting rules a human would use:
+	 * a satisfied number clears its other neighbours with one chord, a number with exactly as many hidden
+	 * neighbours as missing mines flags them, and one number contained in another gives the difference.
+	 * When nothing is certain it falls back to the square with the lowest local mine estimate.
+	 * Its working vectors come from the thread's scratch arena and are handed back when it is destroyed
 	 */
-	class ConsoleRenderer : public Renderer {
+	class Solver {
 	private:
-		Logic::Point selection;
-		SelectionMode selectionMode;
-		SelectionMode lastAction;
+		ArenaScope scope;
+		PlayerView& view;
+		ArenaVector<Constraint> constraints;
+		Hint guess();
 	public:
-		ConsoleRenderer();
-		void initializeRender();
-		void drawBoard(Logic::Game& game);
-		bool promptForInput(Logic::Game& game);
-		void clear();
-		void displayStats(Logic::GameLoop& loop);
-		bool promptPlayAgain();
-		bool hasAdvancedRendering();
-		void playGame(Logic::GameLoop& loop, Logic::Game& game);
-		void displayMenu(Logic::GameLoop& loop);
+		Solver(PlayerView& view);
+		Hint findHint();
+		static ArenaVector<Constraint> findConstraints(PlayerView& view, GameArena* arena);
 	};
 
-	/* Class Name: OptionsSelector
+	/* Class Name: Advisor
 	 *
 	 * Class Description:
-	 * This virtual Class is used as a base to allow the user to select the options
-	 *
+	 * This Class keeps exact mine chances for a game up to date while it is played. The hidden squares next to
+	 * numbers are split into components that share no number, and the layouts of each component are counted once,
+	 * by how many mines they use. After a move only the squares it changed are looked at, and only the components
+	 * they touch are counted again. A query joins the components and the squares away from the numbers through the
+	 * number of mines left. A component with too many layouts to count uses the local estimate of the Solver instead
 	 */
-	class OptionsSelector {
+	class Advisor {
+	private:
+		static constexpr long long MAX_NODES = 1 << 18; // search steps allowed for one component
+		static constexpr int MAX_COMPONENT = 400;
+		class Counter;
+		class Component {
+		public:
+			std::vector<int> cells, sources;
+			std::vector<double> ways;     // layouts by their number of mines, scaled so the largest is 1
+			std::vector<double> cellWays; // cellWays[index * (cells.size() + 1) + mines]: those with cells[index] a mine
+			bool exact;
+		};
+		Board& board;
+		PlayerView view;
+		std::vector<int> componentOf; // the component of a hidden square next to a number, -1 for every other square
+		std::vector<Component> components;
+		std::vector<int> unused;      // components that were split up or joined, free to be reused
+		std::vector<int> indexOf;
+		std::vector<unsigned> visited;
+		unsigned visit;
+		std::vector<double> probability;
+		double interiorProbability;
+		int hidden, flags, frontier;
+		bool solved;
+		bool observe(int cell);
+		void regroup(std::vector<int>& changed);
+		void release(int component, std::vector<int>& sources);
+		void count(Component& component);
+		double localEstimate(int cell);
+		void solve();
+		double expectedReveal(int cell);
 	public:
-		virtual Logic::GameOptions promptForOptions() = 0;
-		virtual ~OptionsSelector();
+		Advisor(Board& board);
+		void rebuild();
+		void moved(Point location);
+		double getProbability(Point location);
+		Hint safest();
+		Hint mostRevealing(double& expected);
 	};
 
-	/* Class Name: ConsoleOptionsSelector
+	/* Class Name: CancelToken
 	 *
 	 * Class Description:
-	 * This derived Class is derived from the OptionsSelector Classs and is used to allow the user to select the options
-	 *
+	 * This Class is shared by a group of tasks on a WorkerPool, and copies of it all refer to the same group.
+	 * Once it is cancelled, tasks of the group that have not started are dropped and running ones can check it
+	 * to stop early. It counts the tasks of the group still to finish, so the group can be waited for
 	 */
-	class ConsoleOptionsSelector : public OptionsSelector {
+	class CancelToken {
+	private:
+		friend class WorkerPool;
+		class State {
+		public:
+			std::atomic<bool> cancelled;
+			std::atomic<int> pending;
+			std::mutex mutex;
+			std::condition_variable finished;
+			State();
+		};
+		std::shared_ptr<State> state;
 	public:
-		Logic::GameOptions promptForOptions();
+		CancelToken();
+		void cancel();
+		bool isCancelled() const;
+		int getPending() const;
 	};
-}
-
-namespace Logic { // Logic class implementations
 
-	/////////////////////////////////////////////
-	// CLASS DEFINITION: Point
-	/////////////////////////////////////////////
+	/* Class Name: WorkerPool
+	 *
+	 * Class Description:
+	 * This Class is a small fixed set of threads that run queued tasks in the background.
+	 * Every worker has its own queue and takes work from the others when it runs dry (work stealing).
+	 * Tasks from threads outside the pool go on a bounded global queue that any worker takes from.
+	 * runAll() and wait() let the calling thread help, so they are safe to use from inside a task.
+	 * The engine shares one pool, shared(), so work started from anywhere never needs more threads than cores
+	 */
+	class WorkerPool {
+	private:
+		class Task {
+		public:
+			std::function<void()> body;
+			CancelToken token;
+		};
+		class Queue {
+		public:
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+		static constexpr size_t GLOBAL_LIMIT = 1 << 12; // past this a task from outside the pool runs on the thread that submits it
+		static std::mutex sharedMutex;
+		static unsigned int sharedThreads;
+		static bool sharedPinned, sharedStarted;
+		std::vector<std::unique_ptr<Queue>> queues;
+		Queue global;
+		std::vector<std::thread> threads;
+		std::mutex sleepMutex;
+		std::condition_variable available;
+		int queued;
+		bool stopping, pinned;
+		void work(unsigned int index);
+		void pin();
+		void push(Queue& queue, Task task);
+		bool runOne(int worker);
+		void run(Task& task);
+	public:
+		WorkerPool(unsigned int threadCount);
+		WorkerPool(unsigned int threadCount, bool pinned);
+		~WorkerPool();
+		unsigned int getThreadCount();
+		bool isPinned();
+		void submit(std::function<void()> task);
+		void submit(std::function<void()> task, CancelToken token);
+		void defer(std::function<void()> task, CancelToken token);
+		void runAll(std::vector<std::function<void()>> tasks);
+		void runAll(std::vector<std::function<void()>> tasks, CancelToken token);
+		void wait(CancelToken token);
+		static bool configure(unsigned int threadCount, bool pinned);
+		static WorkerPool& shared();
+	};
 
-	Point::Point(int x, int y) : x(x), y(y) {}
+	/* Class Name: SampleEstimate
+	 *
+	 * Class Description:
+	 * This Class is the result of a MineSampler run: for every square the chance that it is a mine
+	 * and the expected information, in bits, that revealing it would give
+	 */
+	class SampleEstimate {
+	public:
+		int samples;
+		std::vector<double> mineProbability;
+		std::vector<double> information;
+		SampleEstimate();
+		Hint bestMove(PlayerView& view);
+	};
 
-	inline Point Point::add(int x, int y) {
-		return Point(this->x + x, this->y + y);
-	}
+	/* Class Name: MineSampler
+	 *
+	 * Class Description:
+	 * This Class estimates mine chances when there are too many possibilities to count exactly.
+	 * It draws random mine layouts that agree with every revealed number: a valid starting layout
+	 * is found by randomised backtracking, then small groups of squares around one or two numbers
+	 * are re-drawn from all of their valid assignments (a block Gibbs sampler), so no sample is ever
+	 * rejected. Squares away from the numbers are only counted, weighted by the ways to place the rest.
+	 * Independent chains run as batches on a WorkerPool until the time budget runs out. The model lives on the
+	 * calling thread's scratch arena and every batch works on the scratch arena of the thread that runs it
+	 */
+	class MineSampler {
+	private:
+		class Chain; class Tally;
+		ArenaScope scope;
+		GameArena* arena;
+		PlayerView& view;
+		WorkerPool& pool;
+		ArenaVector<int> frontier, frontierIndex, order;
+		ArenaVector<Constraint> constraints;
+		ArenaVector<ArenaVector<int>> constraintsOf, frontierNeighbours;
+		ArenaVector<int> flagNeighbours, interiorNeighbours;
+		ArenaVector<double> interiorWays;
+		int interior, minesLeft;
+		void buildModel();
+	public:
+		MineSampler(PlayerView& view, WorkerPool& pool);
+		SampleEstimate estimate(int budgetMillis);
+	};
 
-	/* Function Name: operator == ()
+	/* Class Name: Strategy
 	 *
-	 * Function Description:
-	 * This function changes the operator == to get location and check against the location
+	 * Class Description:
+	 * This Class is an automated player. It is only ever shown a PlayerView, never the Board,
+	 * and answers with the move it wants to make next
+	 */
+	class Strategy {
+	public:
+		virtual ~Strategy();
+		virtual std::string getName() = 0;
+		virtual void newGame(uint64_t seed);
+		virtual Hint nextMove(PlayerView& view) = 0;
+		static std::unique_ptr<Strategy> create(std::string name);
+	};
+
+	/* Class Name: SolverStrategy
 	 *
-	 * Parameters:
-	 * The p parameter is a point type which indecates the position
+	 * Class Description:
+	 * This Class plays the Solver's hint every move: certain moves first, then the square the
+	 * constraints rate safest
+	 */
+	class SolverStrategy : public Strategy {
+	public:
+		std::string getName();
+		Hint nextMove(PlayerView& view);
+	};
+
+	/* Class Name: SamplerStrategy
 	 *
-	 * return value:
-	 * the updated operator
+	 * Class Description:
+	 * This Class plays the Solver's certain moves and asks the MineSampler whenever it has to guess,
+	 * the same way the console hint does but with a shorter budget
 	 */
-	inline bool Point::operator == (Point p) {
-		return p.x == x && p.y == y;
-	}
+	class SamplerStrategy : public Strategy {
+	private:
+		int budgetMillis;
+	public:
+		SamplerStrategy(int budgetMillis);
+		std::string getName();
+		Hint nextMove(PlayerView& view);
+	};
 
-	/////////////////////////////////////////////
-	// CLASS DEFINITION: Space
-	/////////////////////////////////////////////
+	/* Class Name: RandomStrategy
+	 *
+	 * Class Description:
+	 * This Class plays the Solver's certain moves and guesses a random hidden square otherwise.
+	 * It is the baseline the others should beat
+	 */
+	class RandomStrategy : public Strategy {
+	private:
+		std::mt19937_64 random;
+	public:
+		std::string getName();
+		void newGame(uint64_t seed);
+		Hint nextMove(PlayerView& view);
+	};
 
-	Space::Space(Board& board, Point location) : board(board), location(location) {
-		type = SpaceType::EMPTY;
-	}
+	/* Class Name: TournamentGame
+	 *
+	 * Class Description:
+	 * This Class is the result of one strategy playing one board
+	 */
+	class TournamentGame {
+	public:
+		bool played = false;
+		bool won = false;
+		int guesses = 0;
+		int moves = 0;
+		int64_t micros = 0;
+	};
 
-	/* Function Name: getAdjacentMines()
+	/* Class Name: Tournament
 	 *
-	 * Function Description:
-	 * This function returns the number of adjacent mines
+	 * Class Description:
+	 * This Class plays several strategies on the same seeded boards, in parallel on the shared WorkerPool,
+	 * and reports how they compare. Every finished game is appended to a checkpoint file, so a long
+	 * tournament that is stopped carries on where it left off when it is started again
+	 */
+	class Tournament {
+	private:
+		static constexpr int BATCH = 16; // boards per task
+		GameOptions options;
+		int boards;
+		uint64_t firstSeed;
+		std::vector<std::string> strategies;
+		std::vector<std::vector<TournamentGame>> results; // [strategy][board]
+		std::string checkpoint;
+		std::mutex checkpointMutex;
+		TournamentGame play(Strategy& strategy, GameLoop& loop, GameArena& arena, uint64_t seed);
+		bool loadCheckpoint();
+	public:
+		Tournament(GameOptions options, int boards, uint64_t firstSeed, std::vector<std::string> strategies, std::string checkpoint);
+		bool run();
+		void report(std::ostream& out);
+	};
+
+	/* Class Name: RaceStanding
 	 *
-	 * Parameters:
-	 * none
+	 * Class Description:
+	 * This Class is one line of a race's leaderboard
+	 */
+	class RaceStanding {
+	public:
+		int player;
+		std::string name;
+		GameState state;
+		int revealed, safe, moves;
+		int64_t millis; // time played, or time taken to finish
+	};
+
+	/* Class Name: Race
 	 *
-	 * return value:
-	 * The number of adjacent mines
+	 * Class Description:
+	 * This Class lets several players race on one board. The mines are placed and the first click is
+	 * made once, and every player's game starts from a snapshot of that board. Each player's board plays over
+	 * the snapshot's chunks with an overlay (see Board::startOverlay()), so the board is held once and a player
+	 * only adds two bits a square. Players move from any worker thread; the standings can be read from any thread
+	 */
+	class Race {
+	private:
+		class Progress {
+		public:
+			std::atomic<int> state, revealed, moves;
+			std::atomic<int64_t> finished;
+		};
+		GameLoop startLoop;
+		std::unique_ptr<Game> startGame;
+		GameSnapshot start;
+		BoardSnapshot startBoard; // the board in start, to compare the players' boards with
+		int opened, safe;
+		std::vector<std::string> names;
+		std::vector<std::unique_ptr<GameLoop>> loops; // a loop each, its counters are not atomic
+		std::vector<std::unique_ptr<Game>> players;
+		std::unique_ptr<Progress[]> progress;
+		std::chrono::steady_clock::time_point started;
+	public:
+		Race(GameOptions options, Point firstClick, std::vector<std::string> names);
+		int getPlayerCount();
+		GameOptions getOptions();
+		Game& getGame(int player);
+		void recordMove(int player);
+		std::vector<RaceStanding> getStandings();
+		int countPrivateChunks();
+		int getChunkCount();
+		size_t getOverlayBytes(int player);
+	};
+
+	/* Class Name: Fuzzer
+	 *
+	 * Class Description:
+	 * This Class turns a string of bytes into a game and a list of moves, plays them and checks the rules of
+	 * the game after every step. A ReferenceGame plays the same moves in lockstep, as in --diff, and after every
+	 * step the results, the state, the flags and every square and its number must match it. The game has
+	 * parallelReveal 1, so where there are cores every cascade goes through floodParallel() as well.
+	 * The first bytes pick the board: width, height, mines, topology and placer, then the seed.
+	 * Every three bytes after that are a move: a click, flag, chord, undo or save and load, some of them off the board
+	 */
+	class Fuzzer {
+	private:
+		static constexpr int HEADER = 12;
+		static constexpr int MAX_MOVES = 256;
+		std::string failure;
+		bool expect(bool condition, int step, const std::string& what);
+		bool checkGame(Game& game, std::vector<SpaceType>& before, std::vector<bool>& mines, int step, bool moved);
+		bool checkSave(Game& game, int step);
+		bool checkReference(Game& game, ReferenceGame& reference, int step);
+	public:
+		bool run(const uint8_t* data, size_t size);
+		std::string getFailure();
+		static std::vector<uint8_t> generate(std::mt19937_64& random);
+	};
+
+	/* Class Name: ReferenceGame
+	 *
+	 * Class Description:
+	 * This Class plays by the rules in the plainest way there is: one vector of squares, neighbours asked
+	 * from the topology policy every time, a queue for the flood fill and a full scan for the state.
+	 * It shares nothing with Board and Game but the topology policies, and is kept as the reference the
+	 * optimised game is compared with. The mines are copied in from the game it is compared with
+	 */
+	class ReferenceGame {
+	private:
+		GameOptions options;
+		std::vector<SpaceType> squares;
+		bool firstMove;
+		int (*policy)(int x, int y, int width, int height, int* result);
+		int neighbours(int cell, int* result);
+		void explode();
+		void reveal(std::vector<int> seeds);
+	public:
+		ReferenceGame(GameOptions options);
+		void setMines(std::vector<bool> mines);
+		ActionResult clickSpace(Point location);
+		ActionResult flagSpace(Point location);
+		ActionResult chordSpace(Point location);
+		GameState getState();
+		SpaceType getType(int cell);
+		int getAdjacentMines(int cell);
+		int getUsedFlags();
+		bool isFirstMove();
+	};
+
+	/* Class Name: DiffAction
+	 *
+	 * Class Description:
+	 * This Class is one move of a differential run: c to click, f to flag, h to chord or u to undo
+	 */
+	class DiffAction {
+	public:
+		char kind;
+		Point location;
+		DiffAction(char kind, Point location);
+	};
+
+	/* Class Name: Differential
+	 *
+	 * Class Description:
+	 * This Class plays the same moves on a Game and on a ReferenceGame in lockstep and compares the results,
+	 * the state and every square after each move. When they differ, shrink() cuts the moves down to a short
+	 * list that still makes them differ (delta debugging), which is written out as a reproducer file
+	 */
+	class Differential {
+	private:
+		GameOptions options;
+		std::string divergence;
+		int step;
+		std::vector<SpaceType> shown; // the squares at the last compare, only squares that changed have their numbers checked
+		bool compare(Game& game, ReferenceGame& reference, ActionResult result, ActionResult expected);
+	public:
+		Differential(GameOptions options);
+		bool replay(std::vector<DiffAction>& actions, GameLoop& loop, GameArena* arena);
+		std::vector<DiffAction> shrink(std::vector<DiffAction> actions, GameLoop& loop, GameArena* arena);
+		std::string getDivergence();
+		int getStep();
+		static std::vector<DiffAction> generate(GameOptions options, int count);
+		static void write(GameOptions options, std::vector<DiffAction>& actions, std::ostream& out);
+		static bool read(std::istream& in, GameOptions& options, std::vector<DiffAction>& actions);
+	};
+
+	/* Class Name: DisjointSets
+	 *
+	 * Class Description:
+	 * This Class is a union-find structure over numbered items, with path halving and union by size
+	 */
+	class DisjointSets {
+	private:
+		ArenaVector<int> parent, size;
+	public:
+		DisjointSets(int count, GameArena* arena);
+		int find(int item);
+		bool join(int a, int b);
+	};
+
+	/* Class Name: OpeningIndex
+	 *
+	 * Class Description:
+	 * This Class lists the openings of a mine layout, the areas of connected squares with no mines around them,
+	 * each with the numbers on its edge. The rater builds it from its union-find when the mines are placed,
+	 * and a click on a zero square then opens the whole area in one pass over the list instead of a flood fill
+	 */
+	class OpeningIndex {
+	public:
+		ArenaVector<int> labels;  // the opening of each zero square, -1 for every other square
+		ArenaVector<int> starts;  // where each opening begins in members, with one extra entry for the end
+		ArenaVector<int> edges;   // where each opening's numbers begin in members
+		ArenaVector<int> members; // each opening's zero squares, then the numbers around them
+		int openings;
+		OpeningIndex(GameArena* arena);
+	};
+
+	/* Class Name: NeighbourTable
+	 *
+	 * Class Description:
+	 * This Class lists the squares around every square of a W x H board. It is built by the compiler,
+	 * so border squares cost a table lookup instead of bounds checks
+	 */
+	template <int W, int H>
+	class NeighbourTable {
+	public:
+		std::array<std::array<int, 8>, W * H> cells;
+		std::array<unsigned char, W * H> counts;
+		constexpr NeighbourTable();
+	};
+
+	/* Class Name: FixedGrid
+	 *
+	 * Class Description:
+	 * This Class is the shape of a board whose size is known at compile time. Cells are std::array and the
+	 * neighbour offsets are constants, so loops over the squares around an inner square unroll completely.
+	 * visitGrid() picks it for the beginner, intermediate and expert sizes
+	 */
+	template <int W, int H>
+	class FixedGrid {
+	public:
+		static constexpr int width = W, height = H, size = W * H;
+		static constexpr int offsets[8] = { -W - 1, -W, -W + 1, -1, 1, W - 1, W, W + 1 };
+		static constexpr NeighbourTable<W, H> table{};
+		template <typename T> using Cells = std::array<T, W * H>;
+		FixedGrid(int width, int height);
+		template <typename T> Cells<T> makeCells(T value, GameArena* arena) const;
+		template <typename Visit> void forEachNeighbour(int cell, Visit visit) const;
+	};
+
+	/* Class Name: SquareGrid
+	 *
+	 * Class Description:
+	 * This Class is the shape of a square board of any other size. Neighbours are worked out from the
+	 * width, so rating a giant board reads no neighbour table, which would be far bigger than the board
+	 */
+	class SquareGrid {
+	public:
+		int width, height, size;
+		template <typename T> using Cells = ArenaVector<T>;
+		SquareGrid(int width, int height);
+		template <typename T> Cells<T> makeCells(T value, GameArena* arena) const;
+		template <typename Visit> void forEachNeighbour(int cell, Visit visit) const;
+	};
+
+	/* Class Name: DynamicGrid
+	 *
+	 * Class Description:
+	 * This Class is the shape of a board of any size and topology, read from the shared NeighbourIndex.
+	 * visitGrid() uses it for the topologies other than square
+	 */
+	class DynamicGrid {
+	public:
+		int width, height, size;
+		std::shared_ptr<const NeighbourIndex> neighbours;
+		template <typename T> using Cells = ArenaVector<T>;
+		DynamicGrid(int width, int height, Topology topology);
+		template <typename T> Cells<T> makeCells(T value, GameArena* arena) const;
+		template <typename Visit> void forEachNeighbour(int cell, Visit visit) const;
+	};
+
+	/* Class Name: DifficultyRater
+	 *
+	 * Class Description:
+	 * This Class computes the DifficultyProfile of a mine layout. Zero squares are grouped into
+	 * openings with a union-find, then the solver's two rules are replayed from the first click with
+	 * work lists, so only numbers next to a change are looked at again. When the rules are stuck the
+	 * rater counts a forced guess and opens a safe square, as a lucky player would
+	 */
+	class DifficultyRater {
+	private:
+		int width, height;
+		Topology topology;
+		static constexpr int PARALLEL_CELLS = 1 << 16; // boards this big count their numbers in tiles on every core
+		ArenaVector<char> mines;
+		template <typename Grid> DifficultyProfile rateOn(const Grid& grid, Point firstClick, std::shared_ptr<const OpeningIndex>* openings);
+	public:
+		DifficultyRater(int width, int height, Topology topology, ArenaVector<char> mines);
+		static DifficultyRater fromBoard(Board& board);
+		DifficultyProfile rate(Point firstClick);
+		DifficultyProfile rate(Point firstClick, std::shared_ptr<const OpeningIndex>& openings);
+	};
+
+	/* Class Name: GameSerializer
+	 *
+	 * Class Description:
+	 * This Class writes a game to a stream and reads it back, as compact binary or as JSON.
+	 * Both formats hold the options, the seed, the clock, the difficulty and for every square its
+	 * state and number. Writing goes square by square straight into the stream, and reading checks
+	 * the numbers against the mines so a damaged file is refused instead of loaded.
+	 * Save files use a third format laid out like the board's chunks, so load() can map them into
+	 * memory and let the squares page in as they are used
+	 */
+	class GameSerializer {
+	private:
+		static constexpr const char* TYPE_CODES = "REMXFW"; // one letter per SpaceType, in enum order
+		static constexpr int HEADER_SIZE = 52;
+		static constexpr int MARKS_SIZE = 12; // a save file's header goes on with the three counts Board::marks keeps
+		static constexpr int SAVE_HEADER = 4096; // save files keep their squares page aligned
+		static constexpr long long MAX_SQUARES = 1LL << 27; // bigger boards are refused before anything is allocated for them
+		static void writeHeader(Game& game, std::ostream& out, int version);
+		static void writeBinary(Game& game, std::ostream& out);
+		static void writeSave(Game& game, std::ostream& out);
+		static void writeJson(Game& game, std::ostream& out);
+		static bool readHeader(std::istream& in, int64_t length, GameLoop& loop, std::unique_ptr<Game>& game, int& version);
+		static bool readBinary(std::istream& in, GameLoop& loop, std::unique_ptr<Game>& game);
+		static bool readJson(std::istream& in, GameLoop& loop, std::unique_ptr<Game>& game);
+		static bool finish(Game& game, std::vector<unsigned char>& counts);
+		static bool finishChunks(Game& game);
+	public:
+		static void write(Game& game, std::ostream& out, BoardFormat format);
+		static bool read(std::istream& in, GameLoop& loop, std::unique_ptr<Game>& game);
+		static bool save(Game& game, std::string path);
+		static bool load(std::string path, GameLoop& loop, std::unique_ptr<Game>& game);
+		static bool fits(GameOptions options);
+		static long long getMaxSquares();
+	};
+
+	/* Class Name: LayoutCodec
+	 *
+	 * Class Description:
+	 * This Class turns a set of mines into a number and back. The layouts with a given number of squares and mines
+	 * are numbered in the combinatorial number system, so a layout takes the bits of the largest number,
+	 * log2 C(squares, mines) rounded up, which is as small as a layout with nothing else known can be.
+	 * The number is written little endian. Shapes small enough keep a shared table of every C(square, mines)
+	 * the numbering needs, so a layout is read with a comparison per square and a subtraction per mine
+	 */
+	class LayoutCodec {
+	private:
+		static constexpr size_t TABLE_BYTES = 1 << 26; // bigger shapes work each C(square, mines) out from the last
+		class Number;
+		class Table;
+		static Number start(int cells, int mines);
+		static std::shared_ptr<const Table> table(int cells, int mines);
+	public:
+		static constexpr int MAX_CELLS = 1 << 16; // rankBytes() grows with the square of the squares, about half a second here
+		static int rankBytes(int cells, int mines);
+		static double boundBits(int cells, int mines);
+		static void encode(const std::vector<char>& mines, unsigned char* out, int bytes);
+		static bool decode(const unsigned char* in, int bytes, int cells, int mines, std::vector<int>& found);
+	};
+
+	/* Class Name: CorpusWriter
+	 *
+	 * Class Description:
+	 * This Class writes a corpus of mine layouts that share a size, mine count and shape. A layout the
+	 * seeded placer gives back is stored as its seed and first click, any other as its LayoutCodec number.
+	 * The file is a header, the records, and an index of where each record starts, so a board can be read by number
+	 */
+	class CorpusWriter {
+	private:
+		static constexpr int HEADER_SIZE = 36;
+		std::ofstream out;
+		GameOptions options;
+		std::vector<uint64_t> offsets;
+		uint64_t written;
+		int rankBytes;
+		std::vector<unsigned char> record;
+		GameLoop loop;
+		GameArena arena;
+		void writeRecord();
+	public:
+		CorpusWriter();
+		bool create(std::string path, GameOptions options);
+		void addSeeded(uint64_t seed, Point firstClick);
+		bool addLayout(const std::vector<char>& mines, Point firstClick);
+		bool add(Board& board, Point firstClick);
+		size_t size();
+		bool close();
+	};
+
+	/* Class Name: CorpusReader
+	 *
+	 * Class Description:
+	 * This Class reads a corpus written by CorpusWriter. The index is read when the file is opened, so any board is one
+	 * seek away. A board is rebuilt as a game with its mines placed and its first click not yet made: its
+	 * first move is over, so the click given with it opens the board without placing the mines again
+	 */
+	class CorpusReader {
+	private:
+		static constexpr int HEADER_SIZE = 36; // as CorpusWriter writes it
+		std::ifstream in;
+		GameOptions options;
+		std::vector<uint64_t> offsets; // where each record starts, and where the index starts at the end
+		int rankBytes;
+		bool build(const unsigned char* record, size_t size, GameLoop& loop, std::unique_ptr<Game>& game, Point& firstClick);
+	public:
+		CorpusReader();
+		bool open(std::string path);
+		size_t size();
+		GameOptions getOptions();
+		bool isSeeded(size_t id);
+		bool load(size_t id, GameLoop& loop, std::unique_ptr<Game>& game, Point& firstClick);
+		bool loadAll(size_t first, size_t count, GameLoop& loop, std::vector<std::unique_ptr<Game>>& games, std::vector<Point>& firstClicks);
+	};
+
+#ifdef tracing
+	/* Class Name: Tracer
+	 *
+	 * Class Description:
+	 * This Class records timed scopes and counters from any thread into a fixed ring buffer without
+	 * locking, and writes them in the Chrome trace event format. Each slot carries the ticket that
+	 * filled it, so a slot being overwritten while the trace is written is skipped instead of torn.
+	 * Once the buffer is full the oldest events are replaced
+	 */
+	class Tracer {
+	private:
+		static constexpr size_t CAPACITY = 1 << 16;
+		struct Event {
+			std::atomic<uint64_t> ticket{ 0 };
+			std::atomic<const char*> name{ nullptr };
+			std::atomic<const char*> argument{ nullptr };
+			std::atomic<int64_t> start{ 0 }, duration{ 0 }, value{ 0 };
+			std::atomic<uint32_t> thread{ 0 };
+			std::atomic<char> phase{ 0 };
+		};
+		std::unique_ptr<Event[]> events;
+		std::atomic<uint64_t> next{ 0 };
+		std::atomic<uint32_t> threads{ 0 };
+		std::chrono::steady_clock::time_point epoch;
+		Tracer();
+		static Tracer& get();
+	public:
+		static int64_t now();
+		static void record(char phase, const char* name, const char* argument, int64_t start, int64_t duration, int64_t value);
+		static void counter(const char* name, int64_t value);
+		static bool dump(std::string path);
+	};
+
+	/* Class Name: TraceScope
+	 *
+	 * Class Description:
+	 * This Class times the block it lives in and records it when the block ends, with an optional
+	 * named value such as the number of squares a cascade opened
+	 */
+	class TraceScope {
+	private:
+		const char* name;
+		const char* argument;
+		int64_t start;
+		int64_t value = 0;
+	public:
+		TraceScope(const char* name, const char* argument);
+		~TraceScope();
+		void setValue(int64_t value);
+	};
+#endif
+}
+
+namespace Render { // Render class declarations
+	////////////////////////
+	// CLASS DECLARATIONS //
+	////////////////////////
+
+	/* Class Name: Renderer
+	 *
+	 * Class Description:
+	 * This virtual Class renders is the base class to keep all inputs and outputs and keeps it organized
+	 *
+	 *
+	 */
+	class Renderer {
+	public:
+		virtual ~Renderer();
+		virtual void initializeRender() = 0;
+		virtual void drawBoard(Logic::Game& game) = 0;
+		virtual bool promptForInput(Logic::Game& game) = 0;
+		virtual void clear() = 0;
+		virtual bool promptPlayAgain() = 0;
+		virtual bool hasAdvancedRendering() = 0;
+		virtual void displayStats(Logic::GameLoop& loop) = 0;
+		virtual void playGame(Logic::GameLoop& loop, Logic::Game& game) = 0;
+		virtual void displayMenu(Logic::GameLoop& loop) = 0;
+	};
+
+	/* Class Name: FrameWriter
+	 *
+	 * Class Description:
+	 * This Class writes frames to the terminal on its own thread, so a slow terminal never holds up the game.
+	 * Frames go through a triple buffer: the game fills one slot and swaps it with the middle one, the writer
+	 * swaps its slot with the middle one when that holds a frame it has not seen. Neither side ever waits
+	 * for the other, and a frame the writer had no time for is replaced by the next one. Only the lines that
+	 * differ from what is on the screen are written
+	 */
+	class FrameWriter {
+	private:
+		static constexpr int FRESH = 4; // set on middle while it holds a frame the writer has not taken
+		struct Frame {
+			std::string text;
+			uint64_t sequence = 0;
+		};
+		Frame frames[3];
+		int back, front; // the game's slot and the writer's slot
+		std::atomic<int> middle;
+		uint64_t sequence;
+		std::atomic<uint64_t> written;
+		std::atomic<bool> running, sleeping, stale, settling;
+		std::mutex sleepMutex, settleMutex;
+		std::condition_variable wake, settled;
+		ScriptedTerminal* terminal; // the script the terminal is measured for, or nullptr
+		std::vector<std::string> shown; // the lines on the screen, and the row each starts on
+		std::vector<int> shownRows;
+		std::thread thread;
+		void run();
+		void write(const std::string& text);
+	public:
+		FrameWriter(ScriptedTerminal* terminal);
+		~FrameWriter();
+		void publish(std::string text);
+		void settle();
+		void flush();
+	};
+
+	/* Class Name: TerminalSink
+	 *
+	 * Class Description:
+	 * This Class is a terminal that only counts what is written to it. A scripted run points std::cout at it
+	 */
+	class TerminalSink : public std::streambuf {
+	private:
+		std::atomic<uint64_t> bytes;
+	protected:
+		int_type overflow(int_type character);
+		std::streamsize xsputn(const char* text, std::streamsize count);
+	public:
+		TerminalSink();
+		uint64_t getBytes();
+	};
+
+	/* Class Name: ScriptedTerminal
+	 *
+	 * Class Description:
+	 * This Class stands in for the keyboard and the terminal while the console game is played from a script.
+	 * runScript() hands it to the GameLoop, which hands it to the ConsoleRenderer and its FrameWriter: keys
+	 * come from the script, the terminal has a fixed size and the output goes to a TerminalSink.
+	 * Each time the game asks for a key, the frames for the last key are first waited for, so the time between
+	 * handing out a key and being asked for the next one is the latency of that key, and what the sink received
+	 * in between is its bytes. Games are seeded from the script's seed. When the script runs out every key is
+	 * KEY_CLOSED, which backs the console out to the end the same way a closed keyboard does
+	 */
+	class ScriptedTerminal {
+	private:
+		class KeyRecord {
+		public:
+			char key;
+			int64_t nanos;
+			uint64_t bytes;
+		};
+		std::streambuf& script;
+		TerminalSink& sink;
+		int columns, rows;
+		uint64_t seed;
+		std::vector<FrameWriter*> writers;
+		std::vector<KeyRecord> records;
+		bool waiting; // a key has been handed out and its frames are not measured yet
+		std::chrono::steady_clock::time_point handedOut;
+		uint64_t bytesBefore;
+	public:
+		ScriptedTerminal(std::streambuf& script, TerminalSink& sink, int columns, int rows, uint64_t seed);
+		char nextKey();
+		void finish();
+		bool getSize(int& columns, int& rows);
+		uint64_t nextSeed();
+		void watch(FrameWriter* writer);
+		void forget(FrameWriter* writer);
+		void report(std::ostream& out);
+		void writeRecords(std::ostream& out);
+	};
+
+#ifdef coroutines
+	/* Class Name: SessionTask
+	 *
+	 * Class Description:
+	 * This Class is a coroutine of a console session. It starts suspended and runs when it is awaited or started.
+	 * When it finishes it goes back to the task that awaited it, so a session is a tree of tasks of which
+	 * only the innermost one is ever suspended, waiting for a key
+	 */
+	class SessionTask {
+	public:
+		class promise_type;
+		class FinalAwaiter;
+		SessionTask();
+		SessionTask(std::coroutine_handle<promise_type> handle);
+		SessionTask(SessionTask&& other) noexcept;
+		SessionTask(const SessionTask&) = delete;
+		SessionTask& operator = (SessionTask&& other) noexcept;
+		~SessionTask();
+		void start();
+		bool isDone();
+		void rethrow();
+		bool await_ready();
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting);
+		void await_resume();
+		static size_t getFrameBytes();
+	private:
+		std::coroutine_handle<promise_type> handle;
+	};
+#else
+	// SessionTask: without coroutines a console step runs to its end when it is called, and returns this
+	class SessionTask {};
+#endif
+
+	/* Class Name: ConsoleRenderer
+	 *
+	 * Class Description:
+	 * This derived Class is derived from the Renderer Class and renders all inputs and outputs and keeps it organized.
+	 * Its main menu, games and the pages between them are steps that wait for keys. Built as C++20 each step is a
+	 * SessionTask that awaits the next key, the blocking console runs them in a one-session SessionScheduler that
+	 * reads the keyboard, and --sessions runs thousands of consoles the same way with their keys typed by drivers.
+	 * Without coroutines a step blocks on the keyboard instead. A session console draws to its own stream, or
+	 * nowhere, and keeps its saved game in memory
+	 *
+	 */
+	class ConsoleRenderer : public Renderer {
+	private:
+#ifdef coroutines
+		class KeyAwaiter;
+#endif
+		static constexpr int MENU_ITEMS = 6; // Start Game, Resume Game, Options, Statistics, Rules, Exit
+		Logic::Point selection;
+		SelectionMode selectionMode;
+		SelectionMode lastAction;
+		Logic::GameArena arena; // new games are built here; declared first, so it outlives the undo history and advisor pointing into it
+		std::vector<Logic::GameSnapshot> history;
+		std::unique_ptr<Logic::Advisor> advisor; // made at a game's first (p)robability hint, then follows it move by move
+		Logic::Point viewOrigin; // top left square shown when the board is bigger than the terminal
+		std::ostringstream screen; // what is on the screen during a game, the board and the text under it
+		size_t presented;
+		std::unique_ptr<FrameWriter> writer;
+		ScriptedTerminal* terminal; // the script standing in for the keyboard and the terminal, or nullptr
+		std::ostream& out; // where the console draws: std::cout, or a session's own stream
+		bool session; // a session of --sessions, which never touches the terminal or CONSOLE_SAVE_FILE
+		uint64_t seed; // the seed of a session's next game
+		std::string saved; // the game a script or a session quit last, in the save format
+		Logic::GameOptions options; // what Start Game plays, changed in Options
+		SessionPrompt prompt;
+		int menuSelected, gamesStarted;
+		Logic::Game* playing; // the game being played, or nullptr
+		bool leaving; // set by turn() when the game is left where it is
+#ifdef coroutines
+		char key;
+		std::coroutine_handle<> waiting; // the step waiting for the next key
+		SessionTask task; // declared last, so the steps, and the games in them, end before the arena
+		KeyAwaiter nextKey(SessionPrompt prompt);
+		void begin(SessionTask step);
+#else
+		char nextKey(SessionPrompt prompt);
+#endif
+		bool measure(int& columns, int& rows);
+		uint64_t nextSeed();
+		bool saveGame(Logic::Game& game);
+		bool loadGame(Logic::GameLoop& loop, std::unique_ptr<Logic::Game>& game);
+		void removeSave();
+		void drive(SessionTask step);
+		SessionTask menu(Logic::GameLoop& loop);
+		SessionTask editOptions();
+		SessionTask enterValue(int& value, int minValue, int maxValue);
+		SessionTask play(Logic::GameLoop& loop, Logic::Game& game);
+		SessionTask turn(Logic::Game& game);
+		SessionTask result(SessionPrompt prompt);
+		void showHint(Logic::Game& game);
+		void showOdds(Logic::Game& game);
+		void present();
+		int drawFullBoard(Logic::Game& game, std::ostringstream& frame);
+		int drawCompactBoard(Logic::Game& game, std::ostringstream& frame, int columns, int rows);
+	public:
+		ConsoleRenderer(ScriptedTerminal* terminal);
+		char readKey();
+		void initializeRender();
+		void drawBoard(Logic::Game& game);
+		bool promptForInput(Logic::Game& game);
+		void clear();
+		void displayStats(Logic::GameLoop& loop);
+		bool promptPlayAgain();
+		bool hasAdvancedRendering();
+		void playGame(Logic::GameLoop& loop, Logic::Game& game);
+		void displayMenu(Logic::GameLoop& loop);
+#ifdef coroutines
+		ConsoleRenderer(Logic::GameOptions options, uint64_t seed, std::ostream* out);
+		void start(Logic::GameLoop& loop);
+		void feed(char key);
+		bool isFinished();
+		SessionPrompt getPrompt();
+		Logic::Game* getGame();
+		Logic::Point getSelection();
+		int getMenuSelected();
+		int getMenuItems();
+		int getGamesStarted();
+#endif
+	};
+
+	/* Class Name: OptionsSelector
+	 *
+	 * Class Description:
+	 * This virtual Class is used as a base to allow the user to select the options
+	 *
+	 */
+	class OptionsSelector {
+	public:
+		virtual Logic::GameOptions promptForOptions() = 0;
+		virtual ~OptionsSelector();
+	};
+
+	/* Class Name: ConsoleOptionsSelector
+	 *
+	 * Class Description:
+	 * This derived Class is derived from the OptionsSelector Classs and is used to allow the user to select the options
+	 *
+	 */
+	class ConsoleOptionsSelector : public OptionsSelector {
+	public:
+		Logic::GameOptions promptForOptions();
+	};
+
+#ifdef coroutines
+	/* Class Name: SessionDriver
+	 *
+	 * Class Description:
+	 * This virtual Class gives a console its keys, a key of 0 ends the session where it is
+	 */
+	class SessionDriver {
+	public:
+		virtual ~SessionDriver();
+		virtual char nextKey(ConsoleRenderer& console) = 0;
+	};
+
+	/* Class Name: KeyboardDriver
+	 *
+	 * Class Description:
+	 * This derived Class types what is typed on the keyboard, or the keys of the script standing in for it
+	 */
+	class KeyboardDriver : public SessionDriver {
+	public:
+		char nextKey(ConsoleRenderer& console);
+	};
+
+	/* Class Name: ScriptDriver
+	 *
+	 * Class Description:
+	 * This derived Class types a fixed string of keys, shared by every session that plays it
+	 */
+	class ScriptDriver : public SessionDriver {
+	private:
+		std::shared_ptr<const std::string> keys;
+		size_t position;
+	public:
+		ScriptDriver(std::shared_ptr<const std::string> keys);
+		char nextKey(ConsoleRenderer& console);
+	};
+
+	/* Class Name: BotDriver
+	 *
+	 * Class Description:
+	 * This derived Class plays a number of games with a Strategy, typing what a player would: the menu keys,
+	 * the action key, the moves to the square and (ENTER). It plans the keys for a prompt when it is shown
+	 */
+	class BotDriver : public SessionDriver {
+	private:
+		std::unique_ptr<Logic::Strategy> strategy;
+		int gamesLeft, gamesSeen;
+		std::string planned;
+		size_t position;
+		void plan(ConsoleRenderer& console);
+	public:
+		BotDriver(std::unique_ptr<Logic::Strategy> strategy, int games);
+		char nextKey(ConsoleRenderer& console);
+	};
+
+	/* Class Name: SessionScheduler
+	 *
+	 * Class Description:
+	 * This Class plays started consoles on one thread. It takes them in turn, gives each the next key from its
+	 * driver and resumes it until it waits for another key. A console it was given that finishes, or whose driver
+	 * has no more keys, is freed at once. The blocking console runs in a scheduler of its own, which is only lent it
+	 */
+	class SessionScheduler {
+	private:
+		class Entry {
+		public:
+			ConsoleRenderer* console;
+			std::unique_ptr<ConsoleRenderer> owned; // nullptr for a console that is only lent
+			std::unique_ptr<SessionDriver> driver;
+		};
+		std::deque<Entry> ready;
+		uint64_t keys;
+		int finished, stopped;
+	public:
+		SessionScheduler();
+		void add(std::unique_ptr<ConsoleRenderer> console, std::unique_ptr<SessionDriver> driver);
+		void add(ConsoleRenderer& console, std::unique_ptr<SessionDriver> driver);
+		void run();
+		uint64_t getKeys();
+		int getFinished();
+		int getStopped();
+	};
+#endif
+}
+
+#ifdef epoll_server
+namespace Server { // Server class declarations
+	////////////////////////
+	// CLASS DECLARATIONS //
+	////////////////////////
+
+	/* Class Name: Address
+	 *
+	 * Class Description:
+	 * This Class is where the server listens, either a unix domain socket ("unix:/path")
+	 * or a TCP port on localhost ("tcp:7777")
+	 */
+	class Address {
+	public:
+		AddressType type;
+		std::string path;
+		int port;
+		Address();
+		static bool parse(std::string text, Address& address);
+		int listenOn();
+		int connectTo();
+		std::string toString();
+	};
+
+	/* Class Name: Session
+	 *
+	 * Class Description:
+	 * This Class is one connected client and the game it is playing.
+	 * Sessions are kept in a slab by the server and reused when a client disconnects.
+	 * Each game is built in the session's arena, which is rewound for the next one
+	 */
+	class Session {
+	public:
+		int fd;
+		uint32_t generation;
+		std::string input, output;
+		std::unique_ptr<Logic::GameArena> arena;
+		std::unique_ptr<Logic::Game> game;
+		bool hintPending, writeBlocked, closing;
+		Session();
+		void reset(int fd);
+	};
+
+	/* Class Name: GameServer
+	 *
+	 * Class Description:
+	 * This Class hosts many independent games on one non-blocking epoll event loop.
+	 * Clients send one command per line and get one reply line back. Solver hints run on the
+	 * loop's scheduler and are handed back to the event loop through an eventfd
+	 */
+	class GameServer {
+	private:
+		class HintResult {
+		public:
+			uint32_t session, generation;
+			Logic::Hint hint;
+		};
+		Logic::GameLoop& loop;
+		Address address;
+		int hintBudget;
+		Logic::CancelToken hints; // the hints queued or running, dropped or waited for before the eventfd is closed
+		int listenFd, epollFd, wakeFd;
+		std::vector<std::unique_ptr<Session>> sessions;
+		std::vector<uint32_t> freeSessions, closedSessions;
+		std::mutex completedMutex;
+		std::vector<HintResult> completed;
+		int activeSessions;
+		uint64_t gamesStarted, commandsHandled;
+		void acceptSessions();
+		void readSession(uint32_t id);
+		void processInput(uint32_t id);
+		void handleCommand(uint32_t id, std::string line);
+		void flush(uint32_t id);
+		void closeSession(uint32_t id);
+		void deliverHints();
+	public:
+		GameServer(Logic::GameLoop& loop, Address address, int hintBudget);
+		~GameServer();
+		bool open();
+		void run();
+		void printStats();
+	};
+
+	/* Class Name: LoadGenerator
+	 *
+	 * Class Description:
+	 * This Class opens many client connections to a GameServer and plays games on all of them
+	 * at once by following the server's hints, then reports throughput and latency
+	 */
+	class LoadGenerator {
+	private:
+		class Client {
+		public:
+			int fd;
+			std::string input, output;
+			int gamesLeft;
+			int64_t sentAt;
+			bool writeBlocked;
+		};
+		Address address;
+		int clientCount, gamesPerClient;
+		Logic::GameOptions options;
+		int epollFd;
+		std::vector<Client> clients;
+		std::vector<int64_t> latencies;
+		int wins, losses, errors, finished;
+		uint64_t requests;
+		void request(Client& client, std::string line);
+		void flush(Client& client);
+		void handleReply(Client& client, std::string line);
+	public:
+		LoadGenerator(Address address, int clientCount, int gamesPerClient, Logic::GameOptions options);
+		int run();
+	};
+}
+#endif
+
+namespace Logic { // Logic class implementations
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Point
+	/////////////////////////////////////////////
+
+	Point::Point(int x, int y) : x(x), y(y) {}
+
+	inline Point Point::add(int x, int y) {
+		return Point(this->x + x, this->y + y);
+	}
+
+	/* Function Name: operator == ()
+	 *
+	 * Function Description:
+	 * This function changes the operator == to get location and check against the location
+	 *
+	 * Parameters:
+	 * The p parameter is a point type which indecates the position
+	 *
+	 * return value:
+	 * the updated operator
+	 */
+	inline bool Point::operator == (Point p) {
+		return p.x == x && p.y == y;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Topology
+	/////////////////////////////////////////////
+
+	template <>
+	int TopologyPolicy<Topology::SQUARE>::neighbours(int x, int y, int width, int height, int* result) {
+		int found = 0;
+		for (int yOffset = -1; yOffset <= 1; yOffset++) {
+			for (int xOffset = -1; xOffset <= 1; xOffset++) {
+				int nx = x + xOffset, ny = y + yOffset;
+				if ((xOffset != 0 || yOffset != 0) && nx >= 0 && ny >= 0 && nx < width && ny < height) {
+					result[found++] = ny * width + nx;
+				}
+			}
+		}
+		return found;
+	}
+
+	// the square neighbourhood, with the edges joined left to right and top to bottom
+	template <>
+	int TopologyPolicy<Topology::TORUS>::neighbours(int x, int y, int width, int height, int* result) {
+		int found = 0;
+		for (int yOffset = -1; yOffset <= 1; yOffset++) {
+			for (int xOffset = -1; xOffset <= 1; xOffset++) {
+				int cell = ((y + yOffset + height) % height) * width + (x + xOffset + width) % width;
+				if (cell != y * width + x && std::find(result, result + found, cell) == result + found) {
+					result[found++] = cell; // narrow boards would otherwise meet the same square twice
+				}
+			}
+		}
+		return found;
+	}
+
+	// hexagons in rows, odd rows pushed half a square to the right
+	template <>
+	int TopologyPolicy<Topology::HEX>::neighbours(int x, int y, int width, int height, int* result) {
+		const int shift = y % 2; // the rows above and below reach one square further right on odd rows
+		const int offsets[6][2] = { { -1, 0 }, { 1, 0 }, { shift - 1, -1 }, { shift, -1 }, { shift - 1, 1 }, { shift, 1 } };
+		int found = 0;
+		for (const int* offset : offsets) {
+			int nx = x + offset[0], ny = y + offset[1];
+			if (nx >= 0 && ny >= 0 && nx < width && ny < height) {
+				result[found++] = ny * width + nx;
+			}
+		}
+		return found;
+	}
+
+	// the eight squares a chess knight can jump to
+	template <>
+	int TopologyPolicy<Topology::KNIGHT>::neighbours(int x, int y, int width, int height, int* result) {
+		const int offsets[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+		int found = 0;
+		for (const int* offset : offsets) {
+			int nx = x + offset[0], ny = y + offset[1];
+			if (nx >= 0 && ny >= 0 && nx < width && ny < height) {
+				result[found++] = ny * width + nx;
+			}
+		}
+		return found;
+	}
+
+	NeighbourRange::NeighbourRange(const int* first, const int* last) : first(first), last(last) {}
+
+	inline const int* NeighbourRange::begin() const {
+		return first;
+	}
+
+	inline const int* NeighbourRange::end() const {
+		return last;
+	}
+
+	inline int NeighbourRange::size() const {
+		return static_cast<int>(last - first);
+	}
+
+	NeighbourIndex::NeighbourIndex(int width, int height, Topology topology) : preset(0), width(width), height(height), topology(topology) {
+		if (topology == Topology::SQUARE && ((width == 9 && height == 9) || (width == 16 && height == 16) || (width == 30 && height == 16))) {
+			preset = width;
+		}
+		bands.reset(new Band[static_cast<size_t>(((height - 1) >> BAND_BITS) + 1)]);
+		switch (topology) {
+		case Topology::TORUS:
+			policy = &TopologyPolicy<Topology::TORUS>::neighbours;
+			break;
+		case Topology::HEX:
+			policy = &TopologyPolicy<Topology::HEX>::neighbours;
+			break;
+		case Topology::KNIGHT:
+			policy = &TopologyPolicy<Topology::KNIGHT>::neighbours;
+			break;
+		default:
+			policy = &TopologyPolicy<Topology::SQUARE>::neighbours;
+		}
+		band(0); // the first band is always filled, which keeps small boards off the lazy path
+	}
+
+	/* Function Name: band()
+	 *
+	 * Function Description:
+	 * This function returns a band of rows, filling it from the topology policy the first time
+	 * any thread asks for it
+	 *
+	 * Parameters:
+	 * The row parameter is the number of the band
+	 *
+	 * return value:
+	 * the filled band
+	 */
+	inline const NeighbourIndex::Band& NeighbourIndex::band(int row) const {
+		Band& result = bands[static_cast<size_t>(row)];
+		if (result.ready.load(std::memory_order_acquire)) {
+			return result;
+		}
+		std::call_once(result.built, [this, &result, row] {
+			int first = row << BAND_BITS, last = std::min(first + (1 << BAND_BITS), height);
+			result.starts.assign(1, 0);
+			result.starts.reserve(static_cast<size_t>(width) * (last - first) + 1);
+			result.cells.reserve(static_cast<size_t>(width) * (last - first) * 8);
+			int found[8];
+			for (int y = first; y < last; y++) {
+				for (int x = 0; x < width; x++) {
+					int count = policy(x, y, width, height, found);
+					result.cells.insert(result.cells.end(), found, found + count);
+					result.starts.push_back(static_cast<int>(result.cells.size()));
+				}
+			}
+			result.ready.store(true, std::memory_order_release);
+		});
+		return result;
+	}
+
+	inline NeighbourRange NeighbourIndex::neighboursOf(int cell) const {
+		int row = height > 1 << BAND_BITS ? cell / width >> BAND_BITS : 0;
+		const Band& rows = row == 0 ? bands[0] : band(row);
+		size_t offset = static_cast<size_t>(cell - (row << BAND_BITS) * width);
+		return NeighbourRange(rows.cells.data() + rows.starts[offset], rows.cells.data() + rows.starts[offset + 1]);
+	}
+
+	/* Function Name: neighboursOf()
+	 *
+	 * Function Description:
+	 * This function returns the neighbours of a location, none if it is off the board
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 *
+	 * return value:
+	 * the neighbours
+	 */
+	inline NeighbourRange NeighbourIndex::neighboursOf(Point location) const {
+		if (location.x < 0 || location.y < 0 || location.x >= width || location.y >= height) {
+			return NeighbourRange(none, none);
+		}
+		return neighboursOf(location.y * width + location.x);
+	}
+
+	inline bool NeighbourIndex::adjacent(int a, int b) const {
+		NeighbourRange range = neighboursOf(a);
+		return std::find(range.begin(), range.end(), b) != range.end();
+	}
+
+	/* Function Name: get()
+	 *
+	 * Function Description:
+	 * This function returns the shared table for a board shape, building it when no board is using one.
+	 * Tables nothing uses any more are forgotten, apart from the most recently asked for small shapes
+	 *
+	 * Parameters:
+	 * The width parameter is the width of the board
+	 * The height parameter is the height of the board
+	 * The topology parameter is how squares neighbour each other
+	 *
+	 * return value:
+	 * the shared table
+	 */
+	std::shared_ptr<const NeighbourIndex> NeighbourIndex::get(int width, int height, Topology topology) {
+		static std::mutex mutex;
+		static std::vector<std::weak_ptr<const NeighbourIndex>> tables; // every table still in use
+		static std::deque<std::shared_ptr<const NeighbourIndex>> recent; // most recently asked for first
+		std::lock_guard<std::mutex> lock(mutex);
+		std::shared_ptr<const NeighbourIndex> found;
+		for (size_t index = 0; index < tables.size();) {
+			std::shared_ptr<const NeighbourIndex> table = tables[index].lock();
+			if (!table) {
+				tables[index] = tables.back();
+				tables.pop_back();
+				continue;
+			}
+			if (table->width == width && table->height == height && table->topology == topology) {
+				found = table;
+			}
+			index++;
+		}
+		if (!found) {
+			found = std::make_shared<const NeighbourIndex>(width, height, topology);
+			tables.push_back(found);
+		}
+		recent.erase(std::remove(recent.begin(), recent.end(), found), recent.end());
+		if (static_cast<long long>(width) * height <= RECENT_SQUARES) {
+			recent.push_front(found);
+			if (recent.size() > RECENT_SHAPES) {
+				recent.pop_back();
+			}
+		}
+		return found;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Grids
+	/////////////////////////////////////////////
+
+	template <int W, int H>
+	constexpr NeighbourTable<W, H>::NeighbourTable() : cells(), counts() {
+		for (int cell = 0; cell < W * H; cell++) {
+			int x = cell % W, y = cell / W, found = 0;
+			for (int yOffset = -1; yOffset <= 1; yOffset++) {
+				for (int xOffset = -1; xOffset <= 1; xOffset++) {
+					int nx = x + xOffset, ny = y + yOffset;
+					if ((xOffset != 0 || yOffset != 0) && nx >= 0 && ny >= 0 && nx < W && ny < H) {
+						cells[static_cast<size_t>(cell)][static_cast<size_t>(found++)] = ny * W + nx;
+					}
+				}
+			}
+			counts[static_cast<size_t>(cell)] = static_cast<unsigned char>(found);
+		}
+	}
+
+	template <int W, int H>
+	FixedGrid<W, H>::FixedGrid(int, int) {}
+
+	template <int W, int H>
+	template <typename T>
+	typename FixedGrid<W, H>::template Cells<T> FixedGrid<W, H>::makeCells(T value, GameArena*) const {
+		Cells<T> result;
+		result.fill(value);
+		return result;
+	}
+
+	/* Function Name: forEachNeighbour()
+	 *
+	 * Function Description:
+	 * This function calls visit with every square around a square. Inner squares use the constant
+	 * offsets, squares on the edge use the compile time table
+	 *
+	 * Parameters:
+	 * The cell parameter is the square, as y * width + x
+	 * The visit parameter is the function called with each neighbouring square
+	 *
+	 * return value:
+	 * none
+	 */
+	template <int W, int H>
+	template <typename Visit>
+	inline void FixedGrid<W, H>::forEachNeighbour(int cell, Visit visit) const {
+		int x = cell % W, y = cell / W;
+		if (x > 0 && y > 0 && x < W - 1 && y < H - 1) {
+			for (int index = 0; index < 8; index++) {
+				visit(cell + offsets[index]);
+			}
+			return;
+		}
+		for (int index = 0; index < table.counts[static_cast<size_t>(cell)]; index++) {
+			visit(table.cells[static_cast<size_t>(cell)][static_cast<size_t>(index)]);
+		}
+	}
+
+	SquareGrid::SquareGrid(int width, int height) : width(width), height(height), size(width * height) {}
+
+	template <typename T>
+	SquareGrid::Cells<T> SquareGrid::makeCells(T value, GameArena* arena) const {
+		return Cells<T>(static_cast<size_t>(size), value, ArenaAllocator<T>(arena));
+	}
+
+	// forEachNeighbour(): the squares around a square in the order NeighbourIndex gives them, row by row
+	template <typename Visit>
+	inline void SquareGrid::forEachNeighbour(int cell, Visit visit) const {
+		int x = cell % width, y = cell / width;
+		if (x > 0 && y > 0 && x < width - 1 && y < height - 1) {
+			visit(cell - width - 1); visit(cell - width); visit(cell - width + 1);
+			visit(cell - 1); visit(cell + 1);
+			visit(cell + width - 1); visit(cell + width); visit(cell + width + 1);
+			return;
+		}
+		for (int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ny++) {
+			for (int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); nx++) {
+				if (nx != x || ny != y) {
+					visit(ny * width + nx);
+				}
+			}
+		}
+	}
+
+	DynamicGrid::DynamicGrid(int width, int height, Topology topology) : width(width), height(height), size(width * height),
+		neighbours(NeighbourIndex::get(width, height, topology)) {}
+
+	template <typename T>
+	DynamicGrid::Cells<T> DynamicGrid::makeCells(T value, GameArena* arena) const {
+		return Cells<T>(static_cast<size_t>(size), value, ArenaAllocator<T>(arena));
+	}
+
+	template <typename Visit>
+	inline void DynamicGrid::forEachNeighbour(int cell, Visit visit) const {
+		for (int other : neighbours->neighboursOf(cell)) {
+			visit(other);
+		}
+	}
+
+	/* Function Name: visitGrid()
+	 *
+	 * Function Description:
+	 * This function calls visit with the FixedGrid for the standard square board sizes, a SquareGrid for other
+	 * square boards, or a DynamicGrid otherwise
+	 *
+	 * Parameters:
+	 * The width parameter is the width of the board
+	 * The height parameter is the height of the board
+	 * The topology parameter is how squares neighbour each other
+	 * The visit parameter is a generic lambda taking the grid
+	 *
+	 * return value:
+	 * whatever visit returns
+	 */
+	template <typename Visitor>
+	auto visitGrid(int width, int height, Topology topology, Visitor visit) {
+		if (topology == Topology::SQUARE) {
+			if (width == 9 && height == 9) return visit(FixedGrid<9, 9>(width, height));
+			if (width == 16 && height == 16) return visit(FixedGrid<16, 16>(width, height));
+			if (width == 30 && height == 16) return visit(FixedGrid<30, 16>(width, height));
+			return visit(SquareGrid(width, height));
+		}
+		return visit(DynamicGrid(width, height, topology));
+	}
+
+	/* Function Name: forEachNeighbour()
+	 *
+	 * Function Description:
+	 * This function calls visit with every square around a square, in the same order as neighboursOf().
+	 * The standard square sizes go through their FixedGrid, every other shape reads the table
+	 *
+	 * Parameters:
+	 * The cell parameter is the square, as y * width + x
+	 * The visit parameter is the function called with each neighbouring square
+	 *
+	 * return value:
+	 * none
+	 */
+	template <typename Visit>
+	inline void NeighbourIndex::forEachNeighbour(int cell, Visit visit) const {
+		switch (preset) {
+		case 9:
+			FixedGrid<9, 9>(width, height).forEachNeighbour(cell, visit);
+			break;
+		case 16:
+			FixedGrid<16, 16>(width, height).forEachNeighbour(cell, visit);
+			break;
+		case 30:
+			FixedGrid<30, 16>(width, height).forEachNeighbour(cell, visit);
+			break;
+		default:
+			for (int other : neighboursOf(cell)) {
+				visit(other);
+			}
+		}
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Space
+	/////////////////////////////////////////////
+
+	Space::Space(Board& board, Point location) : board(board), location(location) {}
+
+	/* Function Name: getAdjacentMines()
+	 *
+	 * Function Description:
+	 * This function returns the number of adjacent mines
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * The number of adjacent mines
 	 */
 	int Space::getAdjacentMines() {
+		if (!board.contains(location)) {
+			return 0;
+		}
+		return board.countAdjacentMines(location.y * board.getOptions().width + location.x);
+	}
+
+	/* Function Name: click()
+	 *
+	 * Function Description:
+	 * This function updates the state after the the point is chosen
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * true if someting was updated, false if not
+	 */
+	inline bool Space::click() {
+		TRACE_SCOPE(scope, "click", nullptr);
+		SpaceType type = getType();
+		if (type == SpaceType::MINE) {
+			board.getGame().getLoop().addExploded();
+			GameOptions options = board.getOptions();
+			for (int y = 0; y < options.height; y++) {
+				for (int x = 0; x < options.width; x++) {
+					Point access(x, y);
+					SpaceType other = board.getType(access);
+					if (other == SpaceType::MINE) {
+						board.setType(access, SpaceType::EXPLODED_MINE);
+					}
+					if (other == SpaceType::EMPTY || other == SpaceType::FALSE_FLAG) {
+						board.setType(access, SpaceType::REVEALED);
+					}
+				}
+			}
+			return true;
+		}
+		if (type == SpaceType::EMPTY) {
+			board.reveal(location);
+			return true;
+		}
+		return false;
+	}
+
+	/* Function Name: flag()
+	 *
+	 * Function Description:
+	 * This function updates the state for the flags after the the point is chosen
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * true if someting was updated, false if not
+	 */
+	inline bool Space::flag() {
+		SpaceType type = getType();
+		if (type == SpaceType::MINE) {
+			board.getGame().getLoop().addFlagged();
+			setType(SpaceType::FLAGGED_MINE);
+			return true;
+		}
+		if (type == SpaceType::EMPTY) {
+			board.getGame().getLoop().addFlagged();
+			setType(SpaceType::FALSE_FLAG);
+			return true;
+		}
+		if (type == SpaceType::FALSE_FLAG) {
+			setType(SpaceType::EMPTY);
+			return true;
+		}
+		if (type == SpaceType::FLAGGED_MINE) {
+			setType(SpaceType::MINE);
+			return true;
+		}
+		return false;
+	}
+
+	/* Function Name: adjacentTo()
+	 *
+	 * Function Description:
+	 * This function checks if the space is adjacent to the spaces location
+	 *
+	 * Parameters:
+	 * The space parameter is the position of the space object on the board
+	 *
+	 * return value:
+	 * if the location is adjacent to the current space
+	 */
+	inline bool Space::adjacentTo(Space space) {
+		const NeighbourIndex& neighbours = board.getNeighbours();
+		Point other = space.getLocation();
+		if (neighbours.neighboursOf(location).size() == 0 || neighbours.neighboursOf(other).size() == 0) {
+			return false;
+		}
+		return neighbours.adjacent(location.y * neighbours.width + location.x, other.y * neighbours.width + other.x);
+	}
+
+	/* Function Name: operator == ()
+	 *
+	 * Function Description:
+	 * This function changes the operator == to get location and check against the location
+	 *
+	 * Parameters:
+	 * The space parameter is the position of the space object on the board
+	 *
+	 * return value:
+	 * the updated operator
+	 */
+	inline bool Space::operator == (Space space) {
+		return space.getLocation() == location;
+	}
+
+	/* Function Name: getType()
+	 *
+	 * Function Description:
+	 * This function gets the type of space
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * type
+	 */
+	inline SpaceType Space::getType() {
+		return board.getType(location);
+	}
+
+	/* Function Name: getLocation()
+	 *
+	 * Function Description:
+	 * This function gets the location
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * type
+	 */
+	inline Point Space::getLocation() {
+		return location;
+	}
+
+	/* Function Name: setType()
+	 *
+	 * Function Description:
+	 * This function sets the type of space
+	 *
+	 * Parameters:
+	 * The type parameter is the type of space object on the board
+	 *
+	 * return value:
+	 * none
+	 */
+	inline void Space::setType(SpaceType type) {
+		board.setType(location, type);
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Game Arena
+	/////////////////////////////////////////////
+
+	GameArena::GameArena(size_t blockSize) : current(0), used(0), blockSize(blockSize) {}
+
+	/* Function Name: allocate()
+	 *
+	 * Function Description:
+	 * This function hands out the next aligned piece of the current block, moving on to the next block,
+	 * or adding one, when it does not fit
+	 *
+	 * Parameters:
+	 * The bytes parameter is how much memory is needed
+	 * The alignment parameter is the alignment it needs, a power of two
+	 *
+	 * return value:
+	 * the memory
+	 */
+	void* GameArena::allocate(size_t bytes, size_t alignment) {
+		while (current < blocks.size()) {
+			size_t start = (used + alignment - 1) & ~(alignment - 1);
+			if (start + bytes <= sizes[current]) {
+				used = start + bytes;
+				return blocks[current].get() + start;
+			}
+			current++;
+			used = 0;
+		}
+		size_t size = std::max(blockSize, bytes + alignment);
+		blocks.emplace_back(new char[size]);
+		sizes.push_back(size);
+		current = blocks.size() - 1;
+		used = bytes;
+		return blocks[current].get(); // new[] memory is aligned for any standard type
+	}
+
+	/* Function Name: reset()
+	 *
+	 * Function Description:
+	 * This function makes all the memory free again. When the last game needed several blocks they are
+	 * swapped for one block as big as all of them, so the next game fits without allocating
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameArena::reset() {
+		if (blocks.size() > 1) {
+			size_t total = 0;
+			for (size_t size : sizes) total += size;
+			blocks.clear();
+			sizes.clear();
+			blocks.emplace_back(new char[total]);
+			sizes.push_back(total);
+		}
+		current = 0;
+		used = 0;
+	}
+
+	// release(): gives every block back to the heap, for an arena that grew much bigger than it usually needs
+	void GameArena::release() {
+		blocks.clear();
+		sizes.clear();
+		current = 0;
+		used = 0;
+	}
+
+	inline size_t GameArena::getCapacity() {
+		size_t total = 0;
+		for (size_t size : sizes) total += size;
+		return total;
+	}
+
+	// scratch(): the calling thread's scratch arena
+	GameArena& GameArena::scratch() {
+		thread_local GameArena arena(1 << 16);
+		return arena;
+	}
+
+	ArenaScope::ArenaScope(GameArena& arena) : arena(arena), current(arena.current), used(arena.used) {}
+
+	/* Function Name: ~ArenaScope()
+	 *
+	 * Function Description:
+	 * This function hands back everything allocated since the scope began. When nothing was allocated before it,
+	 * the arena is reset, so overflow blocks are joined, or given back if they grew past MAX_SCRATCH
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	ArenaScope::~ArenaScope() {
+		if (current != 0 || used != 0) {
+			arena.current = current;
+			arena.used = used;
+		}
+		else if (arena.getCapacity() > GameArena::MAX_SCRATCH) {
+			arena.release();
+		}
+		else {
+			arena.reset();
+		}
+	}
+
+	template <typename T>
+	ArenaAllocator<T>::ArenaAllocator(GameArena* arena) noexcept : arena(arena) {}
+
+	template <typename T>
+	template <typename U>
+	ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+	template <typename T>
+	inline T* ArenaAllocator<T>::allocate(size_t count) {
+		if (arena == nullptr) {
+			return static_cast<T*>(::operator new(count * sizeof(T)));
+		}
+		return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	template <typename T>
+	inline void ArenaAllocator<T>::deallocate(T* pointer, size_t) noexcept {
+		if (arena == nullptr) {
+			::operator delete(pointer);
+		}
+	}
+
+	template <typename T>
+	template <typename U>
+	inline bool ArenaAllocator<T>::operator == (const ArenaAllocator<U>& other) const noexcept {
+		return arena == other.arena;
+	}
+
+	template <typename T>
+	template <typename U>
+	inline bool ArenaAllocator<T>::operator != (const ArenaAllocator<U>& other) const noexcept {
+		return arena != other.arena;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Board
+	/////////////////////////////////////////////
+
+	/* Function Name: Board()
+	 *
+	 * Function Description:
+	 * This function creates the board
+	 *
+	 * Parameters:
+	 * The options parameter is the options of the board
+	 * The game parameter is the reference to the game class
+	 * The arena parameter is where the storage comes from, nullptr for the heap
+	 *
+	 * return value:
+	 * none
+	 */
+	Board::Board(Game& game, GameOptions options, GameArena* arena) : game(game), options(options), arena(arena),
+		neighbours(NeighbourIndex::get(options.width, options.height, options.topology)), table(std::allocate_shared<ChunkTable>(ArenaAllocator<ChunkTable>(arena), arena)),
+		marks{ { 0, 0, 0 } }, counted(true) {
+		size_t size = static_cast<size_t>(options.width) * options.height;
+		size_t chunkCount = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		// every chunk starts as one shared empty chunk, copy-on-write gives it its own storage at the first change
+		static const std::shared_ptr<Chunk> empty = [] {
+			std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+			std::fill(chunk->types, chunk->types + CHUNK_SIZE, SpaceType::EMPTY);
+			return chunk;
+		}();
+		table->chunks.assign(chunkCount, empty);
+	}
+
+	/* Function Name: getSpaceAt()
+	 *
+	 * Function Description:
+	 * This gets the Space type at a location. A location off the board is a bug in the caller,
+	 * so it throws std::out_of_range rather than hand back a square that is not there
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 *
+	 * return value:
+	 * space
+	 */
+	Space Board::getSpaceAt(Point location) {
+		if (!contains(location)) {
+			throw std::out_of_range("square (" + std::to_string(location.x) + ", " + std::to_string(location.y) + ") is off the board");
+		}
+		return Space(*this, location);
+	}
+
+	inline bool Board::contains(Point location) {
+		return location.x >= 0 && location.y >= 0 && location.x < options.width && location.y < options.height;
+	}
+
+	/* Function Name: countMarked()
+	 *
+	 * Function Description:
+	 * This counts the squares of one of the types the game state depends on. setType() keeps the counts,
+	 * so this is free unless a load has just filled the chunks directly
+	 *
+	 * Parameters:
+	 * The type parameter is EXPLODED_MINE, FLAGGED_MINE or FALSE_FLAG
+	 *
+	 * return value:
+	 * the number of squares of that type
+	 */
+	int Board::countMarked(SpaceType type) {
+		if (!counted) {
+			if (overlay) {
+				materialize();
+			}
+			marks = { { 0, 0, 0 } };
+			for (size_t index = 0; index < table->chunks.size(); index++) {
+				check(index);
+				for (SpaceType square : table->chunks[index]->types) {
+					unsigned mark = static_cast<unsigned>(square) - static_cast<unsigned>(SpaceType::EXPLODED_MINE);
+					if (mark < 3) {
+						marks[mark]++; // the unused end of the last chunk is EMPTY, or zero in a save file
+					}
+				}
+			}
+			counted = true;
+		}
+		return marks[static_cast<size_t>(type) - static_cast<size_t>(SpaceType::EXPLODED_MINE)];
+	}
+
+	/* Function Name: getType()
+	 *
+	 * Function Description:
+	 * This gets the type of the square at a location
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 *
+	 * return value:
+	 * the type, INVALID if the location is off the board
+	 */
+	inline SpaceType Board::getType(Point location) {
+		if (location.x < 0 || location.y < 0 || location.x >= options.width || location.y >= options.height) {
+			return SpaceType::INVALID;
+		}
+		size_t index = static_cast<size_t>(location.y) * options.width + location.x;
+		check(index >> CHUNK_BITS);
+		SpaceType type = table->chunks[index >> CHUNK_BITS]->types[index & (CHUNK_SIZE - 1)];
+		return overlay ? overlaid(index, type) : type;
+	}
+
+	// the same by square number, for squares taken from the neighbour table
+	inline SpaceType Board::getType(int cell) {
+		check(static_cast<size_t>(cell) >> CHUNK_BITS);
+		SpaceType type = table->chunks[static_cast<size_t>(cell) >> CHUNK_BITS]->types[static_cast<size_t>(cell) & (CHUNK_SIZE - 1)];
+		return overlay ? overlaid(static_cast<size_t>(cell), type) : type;
+	}
+
+	/* Function Name: countAdjacentMines()
+	 *
+	 * Function Description:
+	 * This function counts the mines around a square. A board of one chunk, which every preset is,
+	 * reads its squares straight from that chunk instead of looking the chunk up for each neighbour,
+	 * unless an overlay changes them
+	 *
+	 * Parameters:
+	 * The cell parameter is the square, as y * width + x
+	 *
+	 * return value:
+	 * the number of adjacent mines
+	 */
+	inline int Board::countAdjacentMines(int cell) {
+		int count = 0;
+		if (table->chunks.size() == 1 && !overlay) {
+			check(0);
+			const SpaceType* types = table->chunks[0]->types;
+			neighbours->forEachNeighbour(cell, [types, &count](int other) {
+				count += types[other] == SpaceType::MINE || types[other] == SpaceType::FLAGGED_MINE;
+			});
+			return count;
+		}
+		neighbours->forEachNeighbour(cell, [this, &count](int other) {
+			SpaceType type = getType(other);
+			count += type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE;
+		});
+		return count;
+	}
+
+	/* Function Name: setType()
+	 *
+	 * Function Description:
+	 * This sets the type of the square at a location. Storage still shared with a snapshot
+	 * is copied first, so snapshots never change
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 * The type parameter is the new type
+	 *
+	 * return value:
+	 * none
+	 */
+	inline void Board::setType(Point location, SpaceType type) {
+		if (location.x < 0 || location.y < 0 || location.x >= options.width || location.y >= options.height) {
+			return;
+		}
+		size_t index = static_cast<size_t>(location.y) * options.width + location.x;
+		check(index >> CHUNK_BITS);
+		if (overlay) {
+			SpaceType plane = table->chunks[index >> CHUNK_BITS]->types[index & (CHUNK_SIZE - 1)];
+			SpaceType before = overlaid(index, plane);
+			if (setOverlaid(index, plane, type)) {
+				recount(before, type);
+				return;
+			}
+			materialize();
+		}
+		if (table.use_count() > 1) {
+			table = std::allocate_shared<ChunkTable>(ArenaAllocator<ChunkTable>(arena), *table);
+		}
+		std::shared_ptr<Chunk>& chunk = table->chunks[index >> CHUNK_BITS];
+		if (chunk.use_count() > 1) {
+			chunk = std::allocate_shared<Chunk>(ArenaAllocator<Chunk>(arena), *chunk);
+		}
+		SpaceType& square = chunk->types[index & (CHUNK_SIZE - 1)];
+		recount(square, type);
+		square = type;
+	}
+
+	// recount(): EXPLODED_MINE, FLAGGED_MINE and FALSE_FLAG are counted; mines and reveals written from other threads are not
+	inline void Board::recount(SpaceType before, SpaceType after) {
+		unsigned from = static_cast<unsigned>(before) - static_cast<unsigned>(SpaceType::EXPLODED_MINE);
+		unsigned to = static_cast<unsigned>(after) - static_cast<unsigned>(SpaceType::EXPLODED_MINE);
+		if (from < 3) {
+			marks[from]--;
+		}
+		if (to < 3) {
+			marks[to]++;
+		}
+	}
+
+	/* Function Name: unshare()
+	 *
+	 * Function Description:
+	 * This gives the board its own copy of every chunk still shared with a snapshot, a save file,
+	 * the empty board or the plane under an overlay. Afterwards setType() never allocates, so threads may
+	 * set different squares at once
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void Board::unshare() {
+		if (overlay) {
+			materialize(); // threads may set squares next to each other, which share a byte of the overlay
+		}
+		if (table.use_count() > 1) {
+			table = std::allocate_shared<ChunkTable>(ArenaAllocator<ChunkTable>(arena), *table);
+		}
+		for (size_t index = 0; index < table->chunks.size(); index++) {
+			check(index);
+			if (table->chunks[index].use_count() > 1) {
+				table->chunks[index] = std::allocate_shared<Chunk>(ArenaAllocator<Chunk>(arena), *table->chunks[index]);
+			}
+		}
+	}
+
+	/* Function Name: check()
+	 *
+	 * Function Description:
+	 * This checks a chunk of a mapped save file before it is first read or copied. Every other board,
+	 * and every chunk already checked, costs one test
+	 *
+	 * Parameters:
+	 * The chunk parameter is the number of the chunk
+	 *
+	 * return value:
+	 * none
+	 */
+	inline void Board::check(size_t chunk) {
+		if (unchecked && !unchecked->checked[chunk].load(std::memory_order_acquire)) {
+			checkMapped(chunk);
+		}
+	}
+
+	/* Function Name: checkMapped()
+	 *
+	 * Function Description:
+	 * This checks a chunk of a mapped save file as the whole file used to be checked at load. A chunk with
+	 * squares that are not valid states has them cleared, so nothing reads past the end of a table, and the
+	 * board is marked damaged, which ends the game. Once the last chunk is checked the marks and mines found
+	 * must match the header and the first move, or the board is marked damaged too. Threads in the parallel
+	 * flood may check chunks at the same time
+	 *
+	 * Parameters:
+	 * The chunk parameter is the number of the chunk
+	 *
+	 * return value:
+	 * none
+	 */
+	void Board::checkMapped(size_t chunk) {
+		std::lock_guard<std::mutex> lock(unchecked->mutex);
+		if (unchecked->checked[chunk].load(std::memory_order_relaxed)) {
+			return;
+		}
+		size_t squares = static_cast<size_t>(options.width) * options.height - chunk * CHUNK_SIZE;
+		Chunk& types = *table->chunks[chunk]; // still the mapping: it is checked before anything copies it
+		if (!checkChunk(types, std::min<size_t>(squares, CHUNK_SIZE), unchecked->firstMove, unchecked->marks, unchecked->mines)) {
+			for (SpaceType& square : types.types) {
+				square = square > SpaceType::FALSE_FLAG ? SpaceType::EMPTY : square; // the mapping is private, the file does not change
+			}
+			unchecked->damaged.store(true, std::memory_order_relaxed);
+		}
+		if (--unchecked->left == 0 && (unchecked->marks != unchecked->expected || (unchecked->firstMove ? unchecked->mines != 0 : unchecked->mines == 0))) {
+			unchecked->damaged.store(true, std::memory_order_relaxed);
+		}
+		unchecked->checked[chunk].store(true, std::memory_order_release);
+	}
+
+	/* Function Name: checkChunk()
+	 *
+	 * Function Description:
+	 * This checks the squares of one chunk that came straight from a save file: each must hold a valid state,
+	 * and before the first move none may be a mine. The marks of the whole chunk and the mines of its squares
+	 * on the board are added to the running counts
+	 *
+	 * Parameters:
+	 * The chunk parameter is the chunk to check
+	 * The squares parameter is how many of its squares are on the board
+	 * The firstMove parameter is whether the game has not had its first move
+	 * The marks parameter is the running count of each marked type
+	 * The mines parameter is the running count of mines
+	 *
+	 * return value:
+	 * true if every square is valid
+	 */
+	bool Board::checkChunk(const Chunk& chunk, size_t squares, bool firstMove, std::array<int, 3>& marks, int& mines) {
+		int found = 0;
+		for (size_t index = 0; index < CHUNK_SIZE; index++) {
+			SpaceType type = chunk.types[index];
+			if (type > SpaceType::FALSE_FLAG) {
+				return false;
+			}
+			unsigned mark = static_cast<unsigned>(type) - static_cast<unsigned>(SpaceType::EXPLODED_MINE);
+			if (mark < 3) {
+				marks[mark]++;
+			}
+			if (index < squares) {
+				found += type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE || type == SpaceType::EXPLODED_MINE;
+			}
+		}
+		mines += found;
+		return !firstMove || found == 0;
+	}
+
+	/* Function Name: startOverlay()
+	 *
+	 * Function Description:
+	 * This keeps the squares as they are as a plane that is never written, and records what changes from here on
+	 * in an overlay of two bits a square. Boards that play over the same snapshot then share all of its chunks
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void Board::startOverlay() {
+		if (!overlay) {
+			overlay = std::make_shared<std::vector<unsigned char>>((static_cast<size_t>(options.width) * options.height + 3) / 4, 0);
+		}
+	}
+
+	// getOverlayBytes(): what the overlay takes, 0 for a board that is only chunks
+	size_t Board::getOverlayBytes() {
+		return overlay ? overlay->size() : 0;
+	}
+
+	// overlaid(): a square of the plane as the overlay changes it, 0 leaving it, then revealed, flagged and exploded
+	inline SpaceType Board::overlaid(size_t index, SpaceType plane) {
+		switch (((*overlay)[index >> 2] >> ((index & 3) * 2)) & 3) {
+		case 1:
+			return SpaceType::REVEALED;
+		case 2:
+			return plane == SpaceType::MINE || plane == SpaceType::FLAGGED_MINE || plane == SpaceType::EXPLODED_MINE ? SpaceType::FLAGGED_MINE : SpaceType::FALSE_FLAG;
+		case 3:
+			return SpaceType::EXPLODED_MINE;
+		default:
+			return plane;
+		}
+	}
+
+	/* Function Name: setOverlaid()
+	 *
+	 * Function Description:
+	 * This records a square in the overlay, copying the overlay first if a snapshot shares it.
+	 * Only a mine can be flagged as FLAGGED_MINE or exploded and only a square that is not one can be revealed
+	 * or flagged as FALSE_FLAG, so anything else, such as placing a mine, does not fit the overlay
+	 *
+	 * Parameters:
+	 * The index parameter is the square, as y * width + x
+	 * The plane parameter is the square in the plane
+	 * The type parameter is what the square becomes
+	 *
+	 * return value:
+	 * false if the overlay cannot hold it
+	 */
+	bool Board::setOverlaid(size_t index, SpaceType plane, SpaceType type) {
+		bool mine = plane == SpaceType::MINE || plane == SpaceType::FLAGGED_MINE || plane == SpaceType::EXPLODED_MINE;
+		unsigned state;
+		if (type == plane) {
+			state = 0;
+		}
+		else if (type == SpaceType::REVEALED && !mine) {
+			state = 1;
+		}
+		else if (type == (mine ? SpaceType::FLAGGED_MINE : SpaceType::FALSE_FLAG)) {
+			state = 2;
+		}
+		else if (type == SpaceType::EXPLODED_MINE && mine) {
+			state = 3;
+		}
+		else {
+			return false;
+		}
+		if (overlay.use_count() > 1) {
+			overlay = std::make_shared<std::vector<unsigned char>>(*overlay);
+		}
+		unsigned char& bits = (*overlay)[index >> 2];
+		unsigned shift = static_cast<unsigned>(index & 3) * 2;
+		bits = static_cast<unsigned char>((bits & ~(3u << shift)) | state << shift);
+		return true;
+	}
+
+	/* Function Name: materialize()
+	 *
+	 * Function Description:
+	 * This turns a board with an overlay back into chunks. Chunks the overlay does not change stay shared with the plane
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void Board::materialize() {
+		std::shared_ptr<ChunkTable> own = std::allocate_shared<ChunkTable>(ArenaAllocator<ChunkTable>(arena), *table);
+		size_t size = static_cast<size_t>(options.width) * options.height;
+		for (size_t chunk = 0; chunk < own->chunks.size(); chunk++) {
+			size_t first = chunk * CHUNK_SIZE, last = std::min(size, first + CHUNK_SIZE);
+			auto bytes = overlay->begin() + static_cast<std::ptrdiff_t>(first / 4);
+			if (std::all_of(bytes, overlay->begin() + static_cast<std::ptrdiff_t>((last + 3) / 4), [](unsigned char bits) { return bits == 0; })) {
+				continue;
+			}
+			std::shared_ptr<Chunk>& copy = own->chunks[chunk];
+			copy = std::allocate_shared<Chunk>(ArenaAllocator<Chunk>(arena), *copy);
+			for (size_t index = first; index < last; index++) {
+				copy->types[index - first] = overlaid(index, copy->types[index - first]);
+			}
+		}
+		table = own;
+		overlay.reset();
+	}
+
+	// isDamaged(): true once a chunk of a mapped save file turned out not to be a valid game
+	inline bool Board::isDamaged() {
+		return unchecked && unchecked->damaged.load(std::memory_order_relaxed);
+	}
+
+	Board::ChunkCheck::ChunkCheck(size_t chunks, std::array<int, 3> expected, bool firstMove) : checked(new std::atomic<bool>[chunks]()), left(chunks),
+		expected(expected), marks{ { 0, 0, 0 } }, mines(0), firstMove(firstMove), damaged(false) {}
+
+	/* Function Name: countSharedChunks()
+	 *
+	 * Function Description:
+	 * This counts the chunks the board still shares with a snapshot
+	 *
+	 * Parameters:
+	 * The snapshot parameter is the snapshot to compare with
+	 *
+	 * return value:
+	 * the number of chunks both point to
+	 */
+	int Board::countSharedChunks(BoardSnapshot& snapshot) {
+		if (!snapshot.table || snapshot.width != options.width || snapshot.height != options.height) {
+			return 0;
+		}
+		std::shared_ptr<const ChunkTable> other = std::static_pointer_cast<const ChunkTable>(snapshot.table);
+		int count = 0;
+		for (size_t chunk = 0; chunk < table->chunks.size(); chunk++) {
+			count += table->chunks[chunk] == other->chunks[chunk];
+		}
+		return count;
+	}
+
+	/* Function Name: reveal()
+	 *
+	 * Function Description:
+	 * This function reveals hidden squares and cascades through every square with no adjacent mines.
+	 * All seeds share one queue so a chord opens its neighbours with a single flood fill
+	 *
+	 * Parameters:
+	 * The seeds parameter is the list of squares to reveal
+	 *
+	 * return value:
+	 * none
+	 */
+	void Board::reveal(std::vector<Point> seeds) {
+		ArenaDeque<Point> pending(seeds.begin(), seeds.end(), ArenaAllocator<Point>(arena));
+		flood(pending);
+	}
+
+	void Board::reveal(Point seed) {
+		ArenaAllocator<Point> allocator(arena);
+		ArenaDeque<Point> pending(allocator);
+		pending.push_back(seed);
+		flood(pending);
+	}
+
+	/* Function Name: flood()
+	 *
+	 * Function Description:
+	 * This function runs the flood fill of reveal() over a queue of squares.
+	 * Once it has opened options.parallelReveal squares the rest is handed to floodParallel()
+	 *
+	 * Parameters:
+	 * The pending parameter is the queue, emptied by the time it returns
+	 *
+	 * return value:
+	 * none
+	 */
+	void Board::flood(ArenaDeque<Point>& pending) {
+		TRACE_SCOPE(scope, "cascade", "squares");
+		static const bool multicore = WorkerPool::shared().getThreadCount() > 1;
+		int limit = multicore && options.parallelReveal > 0 ? options.parallelReveal : INT32_MAX;
+		int opened = 0;
+		while (!pending.empty()) {
+			if (opened >= limit) {
+				opened += floodParallel(pending);
+				break;
+			}
+			Point location = pending.front();
+			pending.pop_front();
+			if (getType(location) != SpaceType::EMPTY) {
+				continue; // already opened by another branch, flagged, or a mine
+			}
+			int opening = openings ? openings->labels[static_cast<size_t>(location.y) * options.width + location.x] : -1;
+			if (opening >= 0 && revealOpening(opening, opened)) {
+				continue;
+			}
+			setType(location, SpaceType::REVEALED);
+			game.getLoop().addRevealed();
+			opened++;
+			if (Space(*this, location).getAdjacentMines() != 0) {
+				continue;
+			}
+			neighbours->forEachNeighbour(location.y * options.width + location.x, [this, &pending](int cell) {
+				if (getType(cell) == SpaceType::EMPTY) {
+					pending.push_back(Point(cell % options.width, cell / options.width));
+				}
+			});
+		}
+		TRACE_VALUE(scope, opened);
+		TRACE_COUNTER("cascade squares", opened);
+	}
+
+	/* Function Name: revealOpening()
+	 *
+	 * Function Description:
+	 * This function opens a whole opening from the index in one pass: its zero squares and the numbers
+	 * around them. That is what the flood fill would open as long as every zero square in it is still hidden;
+	 * a flag or an earlier partial flood changes where the fill stops, so then it is left to the flood fill
+	 *
+	 * Parameters:
+	 * The opening parameter is the opening to reveal
+	 * The opened parameter counts the squares revealed
+	 *
+	 * return value:
+	 * false if the flood fill has to open it
+	 */
+	bool Board::revealOpening(int opening, int& opened) {
+		const int* first = openings->members.data() + openings->starts[static_cast<size_t>(opening)];
+		const int* edge = openings->members.data() + openings->edges[static_cast<size_t>(opening)];
+		const int* last = openings->members.data() + openings->starts[static_cast<size_t>(opening) + 1];
+		for (const int* cell = first; cell != edge; cell++) {
+			if (getType(*cell) != SpaceType::EMPTY) {
+				return false;
+			}
+		}
+		int count = 0;
+		for (const int* cell = first; cell != last; cell++) {
+			if (getType(*cell) == SpaceType::EMPTY) {
+				setType(Point(*cell % options.width, *cell / options.width), SpaceType::REVEALED);
+				count++;
+			}
+		}
+		game.getLoop().addRevealed(count);
+		opened += count;
+		return true;
+	}
+
+	/* Function Name: floodParallel()
+	 *
+	 * Function Description:
+	 * This function finishes a large flood fill on the game's scheduler, one breadth first level at a time.
+	 * Each level is cut into slices that idle workers steal, and a square is claimed by atomically setting
+	 * its bit in a visited bitmap, so every square is expanded once. The board is only read while the
+	 * levels run; the claimed squares are revealed afterwards, so the result is exactly what flood() gives
+	 *
+	 * Parameters:
+	 * The pending parameter is the rest of flood()'s queue, emptied by the time it returns
+	 *
+	 * return value:
+	 * the number of squares revealed
+	 */
+	int Board::floodParallel(ArenaDeque<Point>& pending) {
+		constexpr size_t SLICE = 4096; // squares per task, small enough to spread a level over every core
+		size_t size = static_cast<size_t>(options.width) * options.height;
+		std::unique_ptr<std::atomic<uint64_t>[]> visited(new std::atomic<uint64_t>[(size + 63) / 64]());
+		auto claim = [&visited](int cell) {
+			uint64_t bit = uint64_t(1) << (cell & 63);
+			return (visited[static_cast<size_t>(cell) >> 6].fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+		};
+		std::vector<int> frontier;
+		for (Point location : pending) {
+			if (getType(location) == SpaceType::EMPTY && claim(location.y * options.width + location.x)) {
+				frontier.push_back(location.y * options.width + location.x);
+			}
+		}
+		pending.clear();
+		WorkerPool& pool = game.getLoop().getScheduler();
+		int opened = static_cast<int>(frontier.size());
+		while (!frontier.empty()) {
+			size_t slices = std::min<size_t>((frontier.size() + SLICE - 1) / SLICE, static_cast<size_t>(pool.getThreadCount()) * 4);
+			std::vector<std::vector<int>> next(slices);
+			std::vector<std::function<void()>> tasks;
+			for (size_t slice = 0; slice < slices; slice++) {
+				tasks.push_back([this, &frontier, &next, &claim, slice, slices] {
+					size_t first = frontier.size() * slice / slices, last = frontier.size() * (slice + 1) / slices;
+					for (size_t index = first; index < last; index++) {
+						int cell = frontier[index];
+						if (countAdjacentMines(cell) != 0) {
+							continue;
+						}
+						neighbours->forEachNeighbour(cell, [this, &claim, &found = next[slice]](int neighbour) {
+							if (getType(neighbour) == SpaceType::EMPTY && claim(neighbour)) {
+								found.push_back(neighbour);
+							}
+						});
+					}
+				});
+			}
+			if (slices == 1) {
+				tasks[0]();
+			}
+			else {
+				pool.runAll(tasks);
+			}
+			frontier.clear();
+			for (std::vector<int>& found : next) {
+				frontier.insert(frontier.end(), found.begin(), found.end());
+			}
+			opened += static_cast<int>(frontier.size());
+		}
+		// unshare the touched chunks here, since the arena is not thread safe, then write them in parallel
+		if (overlay) {
+			materialize();
+		}
+		if (table.use_count() > 1) {
+			table = std::allocate_shared<ChunkTable>(ArenaAllocator<ChunkTable>(arena), *table);
+		}
+		size_t wordsPerChunk = CHUNK_SIZE / 64, words = (size + 63) / 64;
+		std::vector<size_t> touched;
+		for (size_t chunk = 0; chunk * wordsPerChunk < words; chunk++) {
+			for (size_t word = chunk * wordsPerChunk; word < std::min(words, (chunk + 1) * wordsPerChunk); word++) {
+				if (visited[word].load(std::memory_order_relaxed) != 0) {
+					touched.push_back(chunk);
+					break;
+				}
+			}
+		}
+		for (size_t chunk : touched) {
+			check(chunk);
+			if (table->chunks[chunk].use_count() > 1) {
+				table->chunks[chunk] = std::allocate_shared<Chunk>(ArenaAllocator<Chunk>(arena), *table->chunks[chunk]);
+			}
+		}
+		std::vector<std::function<void()>> writes;
+		size_t groups = std::min(touched.size(), static_cast<size_t>(pool.getThreadCount()) * 4);
+		for (size_t group = 0; group < groups; group++) {
+			writes.push_back([this, &visited, &touched, group, groups, wordsPerChunk, words] {
+				for (size_t index = touched.size() * group / groups; index < touched.size() * (group + 1) / groups; index++) {
+					Chunk& chunk = *table->chunks[touched[index]];
+					for (size_t word = touched[index] * wordsPerChunk; word < std::min(words, (touched[index] + 1) * wordsPerChunk); word++) {
+						uint64_t bits = visited[word].load(std::memory_order_relaxed);
+						for (size_t bit = 0; bits != 0 && bit < 64; bit++) {
+							if (bits >> bit & 1) {
+								chunk.types[(word * 64 + bit) & (CHUNK_SIZE - 1)] = SpaceType::REVEALED;
+							}
+						}
+					}
+				}
+			});
+		}
+		pool.runAll(writes);
+		game.getLoop().addRevealed(opened);
+		return opened;
+	}
+
+	/* Function Name: getUsedFlags()
+	 *
+	 * Function Description:
+	 * This gets the number of flags used
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * space
+	 */
+	int Board::getUsedFlags() {
+		return countMarked(SpaceType::FALSE_FLAG) + countMarked(SpaceType::FLAGGED_MINE);
+	}
+
+	/* Function Name: snapshot()
+	 *
+	 * Function Description:
+	 * This saves the squares of the board. Only a pointer is copied; the storage becomes
+	 * shared and is copied chunk by chunk when the board is next written
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the snapshot
+	 */
+	BoardSnapshot Board::snapshot() {
+		BoardSnapshot snapshot;
+		snapshot.width = options.width;
+		snapshot.height = options.height;
+		snapshot.table = table;
+		snapshot.overlay = overlay;
+		snapshot.openings = openings;
+		snapshot.marks = marks;
+		snapshot.counted = counted;
+		return snapshot;
+	}
+
+	/* Function Name: restore()
+	 *
+	 * Function Description:
+	 * This puts the board back to a snapshot, which may come from another board of the same size
+	 *
+	 * Parameters:
+	 * The snapshot parameter is the state to restore
+	 *
+	 * return value:
+	 * true if the snapshot fits this board
+	 */
+	bool Board::restore(BoardSnapshot snapshot) {
+		if (!snapshot.table || snapshot.width != options.width || snapshot.height != options.height) {
+			return false;
+		}
+		// the snapshot's table is never written through; setType copies it before any change
+		table = std::const_pointer_cast<ChunkTable>(std::static_pointer_cast<const ChunkTable>(snapshot.table));
+		overlay = snapshot.overlay; // shared too, setOverlaid() copies it before any change
+		openings = snapshot.openings;
+		marks = snapshot.marks;
+		counted = snapshot.counted;
+		return true;
+	}
+
+	inline Space Board::getSpaceAt(int x, int y) {
+		Point location(x, y);
+		return getSpaceAt(location);
+	}
+
+	inline GameOptions Board::getOptions() {
+		return options;
+	}
+
+	inline Game& Board::getGame() {
+		return game;
+	}
+
+	inline GameArena* Board::getArena() {
+		return arena;
+	}
+
+	inline const NeighbourIndex& Board::getNeighbours() {
+		return *neighbours;
+	}
+
+	Board::ChunkTable::ChunkTable(GameArena* arena) : chunks(ArenaAllocator<std::shared_ptr<Chunk>>(arena)) {}
+
+	inline void Board::setSeed(uint64_t seed) {
+		options.seed = seed;
+	}
+
+	inline DifficultyProfile Board::getDifficulty() {
+		return difficulty;
+	}
+
+	inline void Board::setOpenings(std::shared_ptr<const OpeningIndex> openings) {
+		this->openings = openings;
+	}
+
+	inline void Board::setDifficulty(DifficultyProfile difficulty) {
+		this->difficulty = difficulty;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Snapshots
+	/////////////////////////////////////////////
+
+	BoardSnapshot::BoardSnapshot() : width(0), height(0), marks{ { 0, 0, 0 } }, counted(true) {}
+
+	GameSnapshot::GameSnapshot() : firstMove(true) {}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Game
+	/////////////////////////////////////////////
+
+	Game::Game(GameLoop& loop, GameOptions options) : Game(loop, options, nullptr) {}
+
+	Game::Game(GameLoop& loop, GameOptions options, GameArena* arena) : loop(loop), options(options), board(*this, options, arena) {
+		this->firstMove = true;
+		this->startTime = currentTimeSeconds();
+	}
+
+	/* Function Name: clickSpace()
+	 *
+	 * Function Description:
+	 * This determines what happens when you select a space. A square off the board, or any move once
+	 * the game is over, is INVALID
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	ActionResult Game::clickSpace(Point location) {
+		if (!board.contains(location) || getState() != GameState::PLAYING) {
+			return ActionResult::INVALID;
+		}
+		if (firstMove) {
+			this->firstMove = false;
+			if (options.minePlacerType == MinePlacerType::RANDOM || options.minePlacerType == MinePlacerType::PARALLEL_RANDOM) {
+				RandomMinePlacer placer(board);
+				placer.placeMines(location);
+			}
+		}
+		Space target = board.getSpaceAt(location);
+		if (!target.click()) {
+			return ActionResult::ALREADY_REVEALED;
+		}
+		if (target.getType() == SpaceType::EXPLODED_MINE) {
+			return ActionResult::EXPLODED;
+		}
+		return ActionResult::OK;
+	}
+
+	/* Function Name: flagSpace()
+	 *
+	 * Function Description:
+	 * This checks if there is a flag placed at a certain location. Flags need the mines to be placed,
+	 * so a flag before the first click is INVALID, as is one off the board or after the game is over
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	ActionResult Game::flagSpace(Point location) {
+		if (firstMove || !board.contains(location) || getState() != GameState::PLAYING) {
+			return ActionResult::INVALID;
+		}
+		Space target = board.getSpaceAt(location);
+		if (!target.flag()) {
+			return ActionResult::NOT_HIDDEN;
+		}
+		return ActionResult::OK;
+	}
+
+	/* Function Name: chordSpace()
+	 *
+	 * Function Description:
+	 * This chords a revealed number: once as many neighbours are flagged as the number shows,
+	 * all of its other hidden neighbours are opened together. A wrong flag means one of them is a mine.
+	 * A square off the board, or any move once the game is over, is INVALID
+	 *
+	 * Parameters:
+	 * The location parameter is a point type
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	ActionResult Game::chordSpace(Point location) {
+		if (!board.contains(location) || getState() != GameState::PLAYING) {
+			return ActionResult::INVALID;
+		}
+		Space target = board.getSpaceAt(location);
+		if (target.getType() != SpaceType::REVEALED) {
+			return ActionResult::NOT_REVEALED;
+		}
+		int flags = 0;
+		std::vector<Point> hidden;
+		Point mine(-1, -1);
+		board.getNeighbours().forEachNeighbour(location.y * options.width + location.x, [this, &flags, &hidden, &mine](int cell) {
+			Point access(cell % options.width, cell / options.width);
+			switch (board.getType(cell)) {
+			case SpaceType::FALSE_FLAG:
+			case SpaceType::FLAGGED_MINE:
+				flags++;
+				break;
+			case SpaceType::MINE:
+				mine = access;
+				hidden.push_back(access);
+				break;
+			case SpaceType::EMPTY:
+				hidden.push_back(access);
+				break;
+			default:
+				break;
+			}
+		});
+		if (flags != target.getAdjacentMines()) {
+			return ActionResult::NOT_SATISFIED;
+		}
+		if (hidden.empty()) {
+			return ActionResult::ALREADY_REVEALED;
+		}
+		if (mine.x >= 0) {
+			board.getSpaceAt(mine).click();
+			return ActionResult::EXPLODED;
+		}
+		board.reveal(hidden);
+		return ActionResult::OK;
+	}
+
+	/* Function Name: getState()
+	 *
+	 * Function Description:
+	 * This checks the state of the game. If there are exploded mines, it returns a loss immediately.
+	 * If all flags are in the correct spot and all have been selected, the player wins.
+	 * The board keeps count of both, so this does not look at the squares
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	GameState Game::getState() {
+		TRACE_SCOPE(scope, "getState", nullptr);
+		if (board.countMarked(SpaceType::EXPLODED_MINE) > 0 || board.isDamaged()) {
+			return GameState::LOSS; // any exploded mine is an instant loss, as is a save file found damaged during play
+		}
+		if (board.countMarked(SpaceType::FLAGGED_MINE) == options.mines) { // all mines must be flagged for win state
+			return GameState::WIN;
+		}
+		return GameState::PLAYING;
+	}
+
+	inline int Game::getRemainingFlags() {
+		return options.mines - board.getUsedFlags();
+	}
+
+	inline Board& Game::getBoard() {
+		return board;
+	}
+
+	inline GameOptions Game::getOptions() {
+		return board.getOptions(); // the board records the seed once the mines are placed
+	}
+
+	inline int64_t Game::getStartTime() {
+		return startTime;
+	}
+
+	inline GameLoop& Game::getLoop() {
+		return loop;
+	}
+
+	inline bool Game::isFirstMove() {
+		return firstMove;
+	}
+
+	/* Function Name: snapshot()
+	 *
+	 * Function Description:
+	 * This saves the state of the game. It is cheap enough to take before every move
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the snapshot
+	 */
+	GameSnapshot Game::snapshot() {
+		GameSnapshot snapshot;
+		snapshot.board = board.snapshot();
+		snapshot.firstMove = firstMove;
+		return snapshot;
+	}
+
+	/* Function Name: restore()
+	 *
+	 * Function Description:
+	 * This puts the game back to a snapshot. Statistics already counted by the loop are kept
+	 *
+	 * Parameters:
+	 * The snapshot parameter is the state to restore
+	 *
+	 * return value:
+	 * true if the snapshot fits this game
+	 */
+	bool Game::restore(GameSnapshot snapshot) {
+		if (!board.restore(snapshot.board)) {
+			return false;
+		}
+		this->firstMove = snapshot.firstMove;
+		return true;
+	}
+
+	// MinePlacer: Trivia virtual destructor
+	MinePlacer::~MinePlacer() {}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Random Mine Placer
+	/////////////////////////////////////////////
+
+	RandomMinePlacer::RandomMinePlacer(Board& board) : MinePlacer(board) {}
+
+	/* Function Name: placeMines()
+	 *
+	 * Function Description:
+	 * Places mines on the board
+	 *
+	 * Parameters:
+	 * The clear parameter is a point type
+	 *
+	 * return value:
+	 * none
+	 */
+	void RandomMinePlacer::placeMines(Logic::Point clear) {
+		TRACE_SCOPE(scope, "placeMines", "mines");
+		GameOptions options = board.getOptions();
+		int minesToPlace = options.mines;
+		if (minesToPlace > options.width * options.height - 1) {
+			minesToPlace = options.width * options.height - 1;
+		}
+		TRACE_VALUE(scope, minesToPlace);
+		uint64_t seed = options.seed;
+		while (seed == 0) {
+			seed = (static_cast<uint64_t>(rand()) << 32) ^ static_cast<uint64_t>(rand()) ^ static_cast<uint64_t>(time(nullptr));
+		}
+		board.setSeed(seed);
+		const NeighbourIndex& neighbours = board.getNeighbours();
+		bool clearOnBoard = clear.x >= 0 && clear.y >= 0 && clear.x < options.width && clear.y < options.height;
+		int clearCell = clear.y * options.width + clear.x;
+		int outsideCount = options.width * options.height - (clearOnBoard ? 1 + neighbours.neighboursOf(clearCell).size() : 0);
+		if (options.minePlacerType == MinePlacerType::PARALLEL_RANDOM && minesToPlace <= outsideCount) {
+			placeTiles(minesToPlace, clear, seed);
+			rate(clear);
+			return;
+		}
+		std::mt19937_64 random(seed); // same seed and first click, same board on every platform
+		ArenaAllocator<Point> allocator(board.getArena());
+		ArenaVector<Point> outside(allocator), around(allocator);
+		outside.reserve(static_cast<size_t>(options.width * options.height));
+		around.reserve(8);
+		for (int y = 0; y < options.height; y++) {
+			for (int x = 0; x < options.width; x++) {
+				Point location(x, y);
+				if (location == clear) {
+					continue;
+				}
+				if (clearOnBoard && neighbours.adjacent(clearCell, y * options.width + x)) {
+					around.push_back(location);
+				}
+				else {
+					outside.push_back(location);
+				}
+			}
+		}
+		// partial Fisher-Yates: each pick swaps a random remaining square to the front
+		auto pick = [this, &random](ArenaVector<Point>& from, int count) {
+			for (int index = 0; index < count; index++) {
+				size_t other = static_cast<size_t>(index) + static_cast<size_t>(random() % (from.size() - static_cast<size_t>(index)));
+				std::swap(from[static_cast<size_t>(index)], from[other]);
+				board.setType(from[static_cast<size_t>(index)], SpaceType::MINE);
+			}
+		};
+		if (minesToPlace <= static_cast<int>(outside.size())) {
+			pick(outside, minesToPlace);
+		}
+		else { // avoid putting mines around starting location at all cost
+			pick(outside, static_cast<int>(outside.size()));
+			pick(around, minesToPlace - static_cast<int>(outside.size()));
+		}
+		rate(clear);
+	}
+
+	/* Function Name: rate()
+	 *
+	 * Function Description:
+	 * This function rates the mines just placed and gives the board their openings
+	 *
+	 * Parameters:
+	 * The clear parameter is the first click
+	 *
+	 * return value:
+	 * none
+	 */
+	void RandomMinePlacer::rate(Point clear) {
+		std::shared_ptr<const OpeningIndex> openings;
+		board.setDifficulty(DifficultyRater::fromBoard(board).rate(clear, openings));
+		board.setOpenings(openings);
+	}
+
+	/* Function Name: placeTiles()
+	 *
+	 * Function Description:
+	 * Places mines with every core. The board is cut into tiles of TILE_CELLS squares, in order. One
+	 * generator seeded with the seed gives each tile its number of mines with a chain of hypergeometric
+	 * draws, which is exactly how a single uniform placement would spread them. Each tile then places
+	 * its mines on a worker with its own generator, seeded from the seed and the tile number.
+	 * Neither step depends on the number of threads, so neither does the layout
+	 *
+	 * Parameters:
+	 * The minesToPlace parameter is the number of mines, never more than the squares outside the first click
+	 * The clear parameter is the first click; it and its neighbours get no mines
+	 * The seed parameter is the board's seed
+	 *
+	 * return value:
+	 * none
+	 */
+	void RandomMinePlacer::placeTiles(int minesToPlace, Point clear, uint64_t seed) {
+		GameOptions options = board.getOptions();
+		int size = options.width * options.height;
+		std::vector<int> excluded;
+		if (clear.x >= 0 && clear.y >= 0 && clear.x < options.width && clear.y < options.height) {
+			int clearCell = clear.y * options.width + clear.x;
+			NeighbourRange around = board.getNeighbours().neighboursOf(clearCell);
+			excluded.assign(around.begin(), around.end());
+			excluded.push_back(clearCell);
+			std::sort(excluded.begin(), excluded.end());
+			excluded.erase(std::unique(excluded.begin(), excluded.end()), excluded.end());
+		}
+		int tiles = (size + TILE_CELLS - 1) / TILE_CELLS;
+		std::vector<int> quotas(static_cast<size_t>(tiles));
+		std::mt19937_64 random(seed);
+		int cellsLeft = size - static_cast<int>(excluded.size()), minesLeft = minesToPlace;
+		for (int tile = 0; tile < tiles; tile++) {
+			int first = tile * TILE_CELLS, last = std::min(first + TILE_CELLS, size);
+			int open = last - first - static_cast<int>(std::count_if(excluded.begin(), excluded.end(), [first, last](int cell) { return cell >= first && cell < last; }));
+			quotas[static_cast<size_t>(tile)] = sampleHypergeometric(random, cellsLeft, minesLeft, open);
+			cellsLeft -= open;
+			minesLeft -= quotas[static_cast<size_t>(tile)];
+		}
+		board.unshare();
+		std::vector<std::function<void()>> tasks;
+		for (int tile = 0; tile < tiles; tile++) {
+			tasks.push_back([this, &excluded, &quotas, &options, tile, size, seed] {
+				int first = tile * TILE_CELLS, last = std::min(first + TILE_CELLS, size);
+				std::vector<int> cells;
+				cells.reserve(static_cast<size_t>(last - first));
+				for (int cell = first; cell < last; cell++) {
+					if (!std::binary_search(excluded.begin(), excluded.end(), cell)) {
+						cells.push_back(cell);
+					}
+				}
+				// splitmix64 of the seed and tile number, so neighbouring tiles get unrelated streams
+				uint64_t tileSeed = seed + 0x9e3779b97f4a7c15ULL * static_cast<uint64_t>(tile + 1);
+				tileSeed = (tileSeed ^ (tileSeed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+				tileSeed = (tileSeed ^ (tileSeed >> 27)) * 0x94d049bb133111ebULL;
+				std::mt19937_64 random(tileSeed ^ (tileSeed >> 31));
+				for (size_t index = 0; index < static_cast<size_t>(quotas[static_cast<size_t>(tile)]); index++) {
+					size_t other = index + static_cast<size_t>(random() % (cells.size() - index));
+					std::swap(cells[index], cells[other]);
+					board.setType(Point(cells[index] % options.width, cells[index] / options.width), SpaceType::MINE);
+				}
+			});
+		}
+		WorkerPool::shared().runAll(tasks);
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Game Loop
+	/////////////////////////////////////////////
+
+	GameLoop::GameLoop(Render::RenderType renderType) : GameLoop(renderType, nullptr) {}
+
+	GameLoop::GameLoop(Render::RenderType renderType, Render::ScriptedTerminal* terminal) : renderType(renderType), optionsSelector(nullptr), terminal(terminal) {
+		this->wins = 0;
+		this->losses = 0;
+		this->flagged = 0;
+		this->exploded = 0;
+		this->revealed = 0;
+		if (renderType == Render::RenderType::CONSOLE) {
+			this->optionsSelector = new Render::ConsoleOptionsSelector();
+		}
+	}
+
+	GameLoop::~GameLoop() {
+		delete optionsSelector;
+	}
+
+	/* Function Name: start()
+	 *
+	 * Function Description:
+	 * This function starts the game
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameLoop::start() {
+		std::unique_ptr<Render::Renderer> renderer;
+		if (renderType == Render::RenderType::CONSOLE) {
+			renderer.reset(new Render::ConsoleRenderer(terminal));
+		}
+		if (renderer == nullptr) { // headless loops only collect statistics
+			return;
+		}
+
+		if (renderer->hasAdvancedRendering()) {
+			renderer->displayMenu(*this);
+		}
+		else {
+			while (true) {
+				GameOptions options = optionsSelector->promptForOptions();
+				Game game(*this, options);
+				renderer->playGame(*this, game);
+				if (!renderer->promptPlayAgain()) {
+					break;
+				}
+			}
+			renderer->displayStats(*this);
+		}
+
+		renderer.reset();
+		std::cout << "Press (ENTER) to exit..." << std::endl;
+		if (terminal) {
+			terminal->nextKey();
+		}
+		else {
+			Render::getCharacter();
+		}
+	}
+
+	inline void GameLoop::addExploded() {
+		exploded++;
+	}
+
+	inline void GameLoop::addFlagged() {
+		flagged++;
+	}
+
+	inline void GameLoop::addRevealed() {
+		revealed++;
+	}
+
+	inline void GameLoop::addRevealed(int count) {
+		revealed += count;
+	}
+
+	inline void GameLoop::addWin(int64_t time) {
+		wins++;
+		winTimes.push_back(time);
+	}
+
+	inline void GameLoop::addLoss(int64_t time) {
+		losses++;
+		lossTimes.push_back(time);
+	}
+
+	inline std::vector<int64_t>& GameLoop::getWinTimes() {
+		return winTimes;
+	}
+
+	inline std::vector<int64_t>& GameLoop::getLossTimes() {
+		return lossTimes;
+	}
+
+	inline int GameLoop::getWins() {
+		return wins;
+	}
+
+	inline int GameLoop::getLosses() {
+		return losses;
+	}
+
+	inline int  GameLoop::getFlagged() {
+		return flagged;
+	}
+
+	inline int GameLoop::getExploded() {
+		return exploded;
+	}
+
+	inline int GameLoop::getRevealed() {
+		return revealed;
+	}
+
+	// getScheduler(): the worker threads that games, solvers and simulations run their parallel work on
+	WorkerPool& GameLoop::getScheduler() {
+		return WorkerPool::shared();
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Player View
+	/////////////////////////////////////////////
+
+	PlayerView::PlayerView(int width, int height, int mines, Topology topology) : width(width), height(height), mines(mines),
+		neighbours(NeighbourIndex::get(width, height, topology)) {
+		cells.assign(static_cast<size_t>(width) * height, HIDDEN);
+	}
+
+	/* Function Name: PlayerView()
+	 *
+	 * Function Description:
+	 * This function copies the visible state of a board
+	 *
+	 * Parameters:
+	 * The board parameter is the board to copy from
+	 *
+	 * return value:
+	 * none
+	 */
+	PlayerView::PlayerView(Board& board) : PlayerView(board.getOptions().width, board.getOptions().height, board.getOptions().mines, board.getOptions().topology) {
+		for (int x = 0; x < width; x++) {
+			for (int y = 0; y < height; y++) {
+				Space space = board.getSpaceAt(x, y);
+				signed char& cell = cells[static_cast<size_t>(y) * width + x];
+				switch (space.getType()) {
+				case SpaceType::REVEALED:
+					cell = static_cast<signed char>(space.getAdjacentMines());
+					break;
+				case SpaceType::FALSE_FLAG:
+				case SpaceType::FLAGGED_MINE:
+					cell = FLAG;
+					break;
+				case SpaceType::EXPLODED_MINE:
+					cell = MINE;
+					break;
+				default:
+					cell = HIDDEN;
+				}
+			}
+		}
+	}
+
+	inline signed char PlayerView::at(int x, int y) {
+		return cells[static_cast<size_t>(y) * width + x];
+	}
+
+	/* Function Name: encode()
+	 *
+	 * Function Description:
+	 * This function writes the view as one character per square, row by row.
+	 * Hidden squares are '#', flags are 'F', revealed mines are '*' and numbers are '0' to '8'
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the encoded view
+	 */
+	std::string PlayerView::encode() {
+		std::string result(cells.size(), '#');
+		for (size_t index = 0; index < cells.size(); index++) {
+			switch (cells[index]) {
+			case HIDDEN:
+				break;
+			case FLAG:
+				result[index] = 'F';
+				break;
+			case MINE:
+				result[index] = '*';
+				break;
+			default:
+				result[index] = static_cast<char>('0' + cells[index]);
+			}
+		}
+		return result;
+	}
+
+	/* Function Name: decode()
+	 *
+	 * Function Description:
+	 * This function reads a view written by encode()
+	 *
+	 * Parameters:
+	 * The width, height and mines parameters are the board dimensions
+	 * The text parameter is the encoded view
+	 * The view parameter receives the result
+	 *
+	 * return value:
+	 * true if the text was a valid view
+	 */
+	bool PlayerView::decode(int width, int height, int mines, std::string text, PlayerView& view) {
+		if (width <= 0 || height <= 0 || text.size() != static_cast<size_t>(width) * height) {
+			return false;
+		}
+		view = PlayerView(width, height, mines, Topology::SQUARE); // the text protocol only carries square boards
+		for (size_t index = 0; index < text.size(); index++) {
+			char c = text[index];
+			if (c == '#') {
+				view.cells[index] = HIDDEN;
+			}
+			else if (c == 'F') {
+				view.cells[index] = FLAG;
+			}
+			else if (c == '*') {
+				view.cells[index] = MINE;
+			}
+			else if (c >= '0' && c <= '8') {
+				view.cells[index] = static_cast<signed char>(c - '0');
+			}
+			else {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Hint
+	/////////////////////////////////////////////
+
+	Hint::Hint() : action(HintAction::NONE), location(Point(-1, -1)), certain(false), mineProbability(1.0) {}
+
+	Hint::Hint(HintAction action, Point location, bool certain, double mineProbability)
+		: action(action), location(location), certain(certain), mineProbability(mineProbability) {}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Solver
+	/////////////////////////////////////////////
+
+	Constraint::Constraint(GameArena* arena) : source(0), need(0), cells(ArenaAllocator<int>(arena)) {}
+
+	Solver::Solver(PlayerView& view) : scope(GameArena::scratch()), view(view), constraints(ArenaAllocator<Constraint>(&GameArena::scratch())) {}
+
+	/* Function Name: findConstraints()
+	 *
+	 * Function Description:
+	 * This function turns every revealed number that still touches hidden squares into a constraint:
+	 * the number of mines still missing among a list of hidden squares
+	 *
+	 * Parameters:
+	 * The view parameter is the board as the player sees it
+	 * The arena parameter holds the constraints
+	 *
+	 * return value:
+	 * the constraints, each with its squares sorted
+	 */
+	ArenaVector<Constraint> Solver::findConstraints(PlayerView& view, GameArena* arena) {
+		ArenaVector<Constraint> constraints{ ArenaAllocator<Constraint>(arena) };
+		for (int y = 0; y < view.height; y++) {
+			for (int x = 0; x < view.width; x++) {
+				signed char number = view.at(x, y);
+				if (number < 0) {
+					continue;
+				}
+				Constraint constraint(arena);
+				constraint.source = y * view.width + x;
+				constraint.need = number;
+				view.neighbours->forEachNeighbour(constraint.source, [&view, &constraint](int cell) {
+					signed char neighbour = view.cells[static_cast<size_t>(cell)];
+					if (neighbour == PlayerView::FLAG) {
+						constraint.need--;
+					}
+					else if (neighbour == PlayerView::HIDDEN) {
+						constraint.cells.push_back(cell);
+					}
+				});
+				if (!constraint.cells.empty()) {
+					std::sort(constraint.cells.begin(), constraint.cells.end());
+					constraints.push_back(std::move(constraint));
+				}
+			}
+		}
+		return constraints;
+	}
+
+	/* Function Name: findHint()
+	 *
+	 * Function Description:
+	 * This function finds the next move. Certain moves are always preferred over guesses
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the hint, with action NONE if there is nothing left to do
+	 */
+	Hint Solver::findHint() {
+		bool anyRevealed = false;
+		bool anyHidden = false;
+		for (signed char cell : view.cells) {
+			anyRevealed |= cell >= 0 || cell == PlayerView::MINE;
+			anyHidden |= cell == PlayerView::HIDDEN;
+		}
+		if (!anyHidden) {
+			return Hint();
+		}
+		if (!anyRevealed) { // the first square opened is never a mine
+			return Hint(HintAction::REVEAL, Point(view.width / 2, view.height / 2), true, 0.0);
+		}
+		GameArena* arena = constraints.get_allocator().arena;
+		constraints = findConstraints(view, arena);
+		for (Constraint& constraint : constraints) {
+			int cell = constraint.cells.front();
+			Point location(cell % view.width, cell / view.width);
+			if (constraint.need == 0 && constraint.cells.size() > 1) { // one chord opens them all
+				return Hint(HintAction::CHORD, Point(constraint.source % view.width, constraint.source / view.width), true, 0.0);
+			}
+			if (constraint.need == 0) {
+				return Hint(HintAction::REVEAL, location, true, 0.0);
+			}
+			if (constraint.need == static_cast<int>(constraint.cells.size())) {
+				return Hint(HintAction::FLAG, location, true, 1.0);
+			}
+		}
+		// subset rule: if every hidden square of A is also next to B, the rest of B holds B.need - A.need mines
+		ArenaVector<ArenaVector<int>> constraintsAt(view.cells.size(), ArenaVector<int>(ArenaAllocator<int>(arena)), ArenaAllocator<ArenaVector<int>>(arena));
+		ArenaVector<int> rest{ ArenaAllocator<int>(arena) };
+		for (size_t index = 0; index < constraints.size(); index++) {
+			for (int cell : constraints[index].cells) {
+				constraintsAt[static_cast<size_t>(cell)].push_back(static_cast<int>(index));
+			}
+		}
+		for (Constraint& a : constraints) {
+			for (int bIndex : constraintsAt[static_cast<size_t>(a.cells.front())]) {
+				Constraint& b = constraints[static_cast<size_t>(bIndex)];
+				if (&a == &b || b.cells.size() <= a.cells.size() || !std::includes(b.cells.begin(), b.cells.end(), a.cells.begin(), a.cells.end())) {
+					continue;
+				}
+				rest.clear();
+				std::set_difference(b.cells.begin(), b.cells.end(), a.cells.begin(), a.cells.end(), std::back_inserter(rest));
+				int restMines = b.need - a.need;
+				Point location(rest.front() % view.width, rest.front() / view.width);
+				if (restMines == 0) {
+					return Hint(HintAction::REVEAL, location, true, 0.0);
+				}
+				if (restMines == static_cast<int>(rest.size())) {
+					return Hint(HintAction::FLAG, location, true, 1.0);
+				}
+			}
+		}
+		return guess();
+	}
+
+	/* Function Name: guess()
+	 *
+	 * Function Description:
+	 * This function picks the hidden square with the lowest estimated chance of being a mine.
+	 * Squares next to numbers use the worst of their constraints, the others use the overall density
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the hint
+	 */
+	Hint Solver::guess() {
+		int hidden = 0, flags = 0;
+		for (signed char cell : view.cells) {
+			hidden += cell == PlayerView::HIDDEN;
+			flags += cell == PlayerView::FLAG;
+		}
+		double density = hidden > 0 ? std::max(0, view.mines - flags) / static_cast<double>(hidden) : 1.0;
+		ArenaVector<double> estimate(view.cells.size(), -1.0, ArenaAllocator<double>(constraints.get_allocator().arena));
+		for (Constraint& constraint : constraints) {
+			double probability = constraint.need / static_cast<double>(constraint.cells.size());
+			for (int cell : constraint.cells) {
+				estimate[static_cast<size_t>(cell)] = std::max(estimate[static_cast<size_t>(cell)], probability);
+			}
+		}
+		Hint best;
+		for (size_t index = 0; index < view.cells.size(); index++) {
+			if (view.cells[index] != PlayerView::HIDDEN) {
+				continue;
+			}
+			double probability = estimate[index] < 0 ? density : estimate[index];
+			if (best.action == HintAction::NONE || probability < best.mineProbability) {
+				int cell = static_cast<int>(index);
+				best = Hint(HintAction::REVEAL, Point(cell % view.width, cell / view.width), false, probability);
+			}
+		}
+		return best;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Advisor
+	/////////////////////////////////////////////
+
+	/* Class Name: Advisor::Counter
+	 *
+	 * Class Description:
+	 * This Class counts the layouts of one component. Squares touching exactly the same numbers are taken as a group,
+	 * so only how many mines each group holds is searched, and each choice counts for as many layouts as there
+	 * are ways to place that many mines in the group. Groups are tried in the order they were found, so
+	 * neighbouring groups are decided together and a number that cannot be met stops the branch early
+	 */
+	class Advisor::Counter {
+	public:
+		class Group {
+		public:
+			std::vector<int> numbers;
+			int size;
+		};
+		std::vector<Group> groups;
+		std::vector<int> need, left; // for each number, the mines it still needs and its squares still undecided
+		std::vector<int> chosen;
+		std::vector<double> groupWays; // groupWays[group * stride + mines]: layouts times the share of the group that are mines
+		std::vector<double>& ways;
+		size_t stride;
+		long long nodes;
+		Counter(std::vector<double>& ways, size_t cells) : ways(ways), stride(cells + 1), nodes(0) {}
+		bool search(size_t index, int mines, double layouts) {
+			if (++nodes > MAX_NODES) {
+				return false;
+			}
+			if (index == groups.size()) {
+				ways[static_cast<size_t>(mines)] += layouts;
+				for (size_t group = 0; group < groups.size(); group++) {
+					if (chosen[group] > 0) {
+						groupWays[group * stride + static_cast<size_t>(mines)] += layouts * chosen[group] / groups[group].size;
+					}
+				}
+				return true;
+			}
+			const Group& group = groups[index];
+			double choices = 1.0; // the ways to put value mines in the group
+			for (int value = 0; value <= group.size; choices = choices * (group.size - value) / (value + 1), value++) {
+				bool fits = true;
+				for (int number : group.numbers) {
+					int after = need[static_cast<size_t>(number)] - value;
+					fits &= after >= 0 && after <= left[static_cast<size_t>(number)] - group.size;
+				}
+				if (!fits) {
+					continue;
+				}
+				for (int number : group.numbers) {
+					need[static_cast<size_t>(number)] -= value;
+					left[static_cast<size_t>(number)] -= group.size;
+				}
+				chosen[index] = value;
+				bool finished = search(index + 1, mines + value, layouts * choices);
+				for (int number : group.numbers) {
+					need[static_cast<size_t>(number)] += value;
+					left[static_cast<size_t>(number)] += group.size;
+				}
+				if (!finished) {
+					return false;
+				}
+			}
+			chosen[index] = 0;
+			return true;
+		}
+	};
+
+	/* Function Name: Advisor()
+	 *
+	 * Function Description:
+	 * This function starts an advisor for a board. It reads the whole board once
+	 *
+	 * Parameters:
+	 * The board parameter is the board to follow, it must outlive the advisor
+	 *
+	 * return value:
+	 * none
+	 */
+	Advisor::Advisor(Board& board) : board(board),
+		view(board.getOptions().width, board.getOptions().height, board.getOptions().mines, board.getOptions().topology), visit(0) {
+		rebuild();
+	}
+
+	/* Function Name: rebuild()
+	 *
+	 * Function Description:
+	 * This function reads the whole board again and counts every component. It is for moves that
+	 * change the board anywhere, such as an undo or a lost game
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void Advisor::rebuild() {
+		view = PlayerView(board);
+		size_t size = view.cells.size();
+		componentOf.assign(size, -1);
+		indexOf.assign(size, -1);
+		visited.assign(size, 0);
+		probability.assign(size, 0.0);
+		components.clear();
+		unused.clear();
+		hidden = flags = frontier = 0;
+		std::vector<int> changed;
+		for (size_t cell = 0; cell < size; cell++) {
+			hidden += view.cells[cell] == PlayerView::HIDDEN;
+			flags += view.cells[cell] == PlayerView::FLAG;
+			if (view.cells[cell] >= 0) {
+				changed.push_back(static_cast<int>(cell));
+			}
+		}
+		regroup(changed);
+		solved = false;
+	}
+
+	/* Function Name: moved()
+	 *
+	 * Function Description:
+	 * This function catches up with a click, flag or chord on a square. The squares a move changes are the square,
+	 * its neighbours and whatever opened from them through squares with no mines around, so only those are read
+	 *
+	 * Parameters:
+	 * The location parameter is the square that was played
+	 *
+	 * return value:
+	 * none
+	 */
+	void Advisor::moved(Point location) {
+		if (board.countMarked(SpaceType::EXPLODED_MINE) > 0) {
+			rebuild(); // a lost game shows every square
+			return;
+		}
+		std::vector<int> pending, changed;
+		int start = location.y * view.width + location.x;
+		pending.push_back(start);
+		view.neighbours->forEachNeighbour(start, [&pending](int cell) {
+			pending.push_back(cell); // a chord opens the neighbours
+		});
+		visit++;
+		while (!pending.empty()) {
+			int cell = pending.back();
+			pending.pop_back();
+			if (visited[static_cast<size_t>(cell)] == visit) {
+				continue;
+			}
+			visited[static_cast<size_t>(cell)] = visit;
+			if (!observe(cell)) {
+				continue;
+			}
+			changed.push_back(cell);
+			if (view.cells[static_cast<size_t>(cell)] == 0) {
+				view.neighbours->forEachNeighbour(cell, [&pending](int neighbour) { pending.push_back(neighbour); });
+			}
+		}
+		if (!changed.empty()) {
+			regroup(changed);
+			solved = false;
+		}
+	}
+
+	// observe(): reads a square from the board into the view, true if it changed
+	bool Advisor::observe(int cell) {
+		signed char seen;
+		Point location(cell % view.width, cell / view.width);
+		switch (board.getType(cell)) {
+		case SpaceType::REVEALED:
+			seen = static_cast<signed char>(Space(board, location).getAdjacentMines());
+			break;
+		case SpaceType::FLAGGED_MINE:
+		case SpaceType::FALSE_FLAG:
+			seen = PlayerView::FLAG;
+			break;
+		case SpaceType::EXPLODED_MINE:
+			seen = PlayerView::MINE;
+			break;
+		default:
+			seen = PlayerView::HIDDEN;
+		}
+		signed char& cellView = view.cells[static_cast<size_t>(cell)];
+		if (seen == cellView) {
+			return false;
+		}
+		hidden += (seen == PlayerView::HIDDEN) - (cellView == PlayerView::HIDDEN);
+		flags += (seen == PlayerView::FLAG) - (cellView == PlayerView::FLAG);
+		cellView = seen;
+		return true;
+	}
+
+	/* Function Name: regroup()
+	 *
+	 * Function Description:
+	 * This function rebuilds the components around squares that changed. Every component holding one of them,
+	 * and every component the new numbers join to it, is taken apart, and its numbers are grouped again from scratch.
+	 * Components the move did not reach keep their counts
+	 *
+	 * Parameters:
+	 * The changed parameter is the squares whose view changed
+	 *
+	 * return value:
+	 * none
+	 */
+	void Advisor::regroup(std::vector<int>& changed) {
+		std::vector<int> sources;
+		for (int cell : changed) {
+			if (componentOf[static_cast<size_t>(cell)] >= 0) {
+				release(componentOf[static_cast<size_t>(cell)], sources);
+			}
+			if (view.cells[static_cast<size_t>(cell)] >= 0) {
+				sources.push_back(cell);
+			}
+			view.neighbours->forEachNeighbour(cell, [&](int neighbour) {
+				if (view.cells[static_cast<size_t>(neighbour)] >= 0) {
+					sources.push_back(neighbour); // its hidden squares or its flags changed
+				}
+			});
+		}
+		visit++;
+		std::vector<int> pending;
+		for (size_t next = 0; next < sources.size(); next++) { // release() adds to sources as it goes
+			int start = sources[next];
+			if (visited[static_cast<size_t>(start)] == visit) {
+				continue;
+			}
+			visited[static_cast<size_t>(start)] = visit;
+			int id;
+			if (unused.empty()) {
+				id = static_cast<int>(components.size());
+				components.emplace_back();
+			}
+			else {
+				id = unused.back();
+				unused.pop_back();
+			}
+			pending.push_back(start);
+			while (!pending.empty()) {
+				int source = pending.back();
+				pending.pop_back();
+				components[static_cast<size_t>(id)].sources.push_back(source);
+				view.neighbours->forEachNeighbour(source, [&](int cell) {
+					if (view.cells[static_cast<size_t>(cell)] != PlayerView::HIDDEN || visited[static_cast<size_t>(cell)] == visit) {
+						return;
+					}
+					visited[static_cast<size_t>(cell)] = visit;
+					if (componentOf[static_cast<size_t>(cell)] >= 0) {
+						release(componentOf[static_cast<size_t>(cell)], sources); // the new numbers join it to this one
+					}
+					componentOf[static_cast<size_t>(cell)] = id;
+					components[static_cast<size_t>(id)].cells.push_back(cell);
+					view.neighbours->forEachNeighbour(cell, [&](int other) {
+						if (view.cells[static_cast<size_t>(other)] >= 0 && visited[static_cast<size_t>(other)] != visit) {
+							visited[static_cast<size_t>(other)] = visit;
+							pending.push_back(other);
+						}
+					});
+				});
+			}
+			Component& component = components[static_cast<size_t>(id)];
+			if (component.cells.empty()) { // a number with nothing hidden around it
+				component.sources.clear();
+				unused.push_back(id);
+				continue;
+			}
+			frontier += static_cast<int>(component.cells.size());
+			count(component);
+		}
+	}
+
+	// release(): takes a component apart, handing its numbers back to be grouped again
+	void Advisor::release(int id, std::vector<int>& sources) {
+		Component& component = components[static_cast<size_t>(id)];
+		for (int cell : component.cells) {
+			componentOf[static_cast<size_t>(cell)] = -1;
+		}
+		frontier -= static_cast<int>(component.cells.size());
+		sources.insert(sources.end(), component.sources.begin(), component.sources.end());
+		component.cells.clear();
+		component.sources.clear();
+		component.ways.clear();
+		component.cellWays.clear();
+		unused.push_back(id);
+	}
+
+	/* Function Name: count()
+	 *
+	 * Function Description:
+	 * This function counts the layouts of a component by number of mines, and for each square how many of
+	 * them have a mine there. The counts are scaled so the largest is 1, which only the ratios need
+	 *
+	 * Parameters:
+	 * The component parameter is the component to count
+	 *
+	 * return value:
+	 * none
+	 */
+	void Advisor::count(Component& component) {
+		size_t size = component.cells.size();
+		component.exact = false;
+		if (size > static_cast<size_t>(MAX_COMPONENT)) {
+			return;
+		}
+		component.ways.assign(size + 1, 0.0);
+		Counter counter(component.ways, size);
+		std::vector<std::vector<int>> numbersOf(size);
+		for (size_t index = 0; index < size; index++) {
+			indexOf[static_cast<size_t>(component.cells[index])] = static_cast<int>(index);
+		}
+		for (int source : component.sources) {
+			int need = view.cells[static_cast<size_t>(source)], left = 0;
+			view.neighbours->forEachNeighbour(source, [&](int cell) {
+				signed char neighbour = view.cells[static_cast<size_t>(cell)];
+				need -= neighbour == PlayerView::FLAG || neighbour == PlayerView::MINE;
+				if (neighbour == PlayerView::HIDDEN) {
+					numbersOf[static_cast<size_t>(indexOf[static_cast<size_t>(cell)])].push_back(static_cast<int>(counter.need.size()));
+					left++;
+				}
+			});
+			if (need < 0 || need > left) {
+				return; // a wrong flag, nothing fits
+			}
+			counter.need.push_back(need);
+			counter.left.push_back(left);
+		}
+		std::vector<int> groupOf(size);
+		std::map<std::vector<int>, int> found;
+		for (size_t index = 0; index < size; index++) {
+			auto inserted = found.emplace(numbersOf[index], static_cast<int>(counter.groups.size()));
+			if (inserted.second) {
+				counter.groups.push_back(Counter::Group{ numbersOf[index], 0 });
+			}
+			groupOf[index] = inserted.first->second;
+			counter.groups[static_cast<size_t>(groupOf[index])].size++;
+		}
+		counter.chosen.assign(counter.groups.size(), 0);
+		counter.groupWays.assign(counter.groups.size() * (size + 1), 0.0);
+		if (!counter.search(0, 0, 1.0)) {
+			return;
+		}
+		double largest = *std::max_element(component.ways.begin(), component.ways.end());
+		if (largest <= 0) {
+			return;
+		}
+		for (double& ways : component.ways) {
+			ways /= largest;
+		}
+		component.cellWays.resize(size * (size + 1));
+		for (size_t index = 0; index < size; index++) {
+			for (size_t mines = 0; mines <= size; mines++) {
+				component.cellWays[index * (size + 1) + mines] = counter.groupWays[static_cast<size_t>(groupOf[index]) * (size + 1) + mines] / largest;
+			}
+		}
+		component.exact = true;
+	}
+
+	// localEstimate(): the Solver's guess for a square, the worst of its numbers' mines left per hidden square
+	double Advisor::localEstimate(int cell) {
+		double estimate = 0.0;
+		view.neighbours->forEachNeighbour(cell, [this, &estimate](int source) {
+			if (view.cells[static_cast<size_t>(source)] < 0) {
+				return;
+			}
+			int need = view.cells[static_cast<size_t>(source)], left = 0;
+			view.neighbours->forEachNeighbour(source, [this, &need, &left](int other) {
+				need -= view.cells[static_cast<size_t>(other)] == PlayerView::FLAG || view.cells[static_cast<size_t>(other)] == PlayerView::MINE;
+				left += view.cells[static_cast<size_t>(other)] == PlayerView::HIDDEN;
+			});
+			estimate = std::max(estimate, std::min(1.0, std::max(0, need) / static_cast<double>(std::max(1, left))));
+		});
+		return estimate;
+	}
+
+	/* Function Name: solve()
+	 *
+	 * Function Description:
+	 * This function turns the component counts into mine chances. A choice of how many mines each component holds
+	 * is weighted by its layouts times the ways to put the remaining mines on the squares away from the numbers.
+	 * Each component is joined with all the others through prefix and suffix convolutions of those counts
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void Advisor::solve() {
+		solved = true;
+		int interior = hidden - frontier;
+		double guessed = 0.0; // mines expected in components that could not be counted
+		std::vector<Component*> exact;
+		for (Component& component : components) {
+			if (component.cells.empty()) {
+				continue;
+			}
+			if (component.exact) {
+				exact.push_back(&component);
+				continue;
+			}
+			for (int cell : component.cells) {
+				probability[static_cast<size_t>(cell)] = localEstimate(cell);
+				guessed += probability[static_cast<size_t>(cell)];
+			}
+		}
+		int left = std::max(0, view.mines - flags - static_cast<int>(std::lround(guessed)));
+		auto convolve = [left](const std::vector<double>& first, const std::vector<double>& second) {
+			std::vector<double> result(std::min(first.size() + second.size() - 1, static_cast<size_t>(left) + 1), 0.0);
+			for (size_t a = 0; a < first.size() && a < result.size(); a++) {
+				for (size_t b = 0; b < second.size() && a + b < result.size(); b++) {
+					result[a + b] += first[a] * second[b];
+				}
+			}
+			return result;
+		};
+		std::vector<std::vector<double>> prefix(exact.size() + 1, std::vector<double>(1, 1.0)), suffix(prefix);
+		for (size_t index = 0; index < exact.size(); index++) {
+			prefix[index + 1] = convolve(prefix[index], exact[index]->ways);
+			suffix[exact.size() - index - 1] = convolve(suffix[exact.size() - index], exact[exact.size() - index - 1]->ways);
+		}
+		// weight[s]: the ways to put the other left - s mines away from the numbers, relative to the largest
+		std::vector<double> weight(static_cast<size_t>(left) + 1, 0.0);
+		double largest = -1e300;
+		for (int mines = 0; mines <= left; mines++) {
+			largest = std::max(largest, logChoose(interior, left - mines));
+		}
+		for (int mines = 0; mines <= left; mines++) {
+			double logWays = logChoose(interior, left - mines);
+			weight[static_cast<size_t>(mines)] = logWays < -1e299 ? 0.0 : std::exp(logWays - largest);
+		}
+		double total = 0.0, interiorMines = 0.0;
+		for (size_t mines = 0; mines < prefix.back().size(); mines++) {
+			total += prefix.back()[mines] * weight[mines];
+			interiorMines += prefix.back()[mines] * weight[mines] * static_cast<double>(left - static_cast<int>(mines));
+		}
+		if (total <= 0) { // the flags cannot all be right, fall back to the local estimates
+			for (Component* component : exact) {
+				for (int cell : component->cells) {
+					probability[static_cast<size_t>(cell)] = localEstimate(cell);
+				}
+			}
+			interiorProbability = hidden > 0 ? std::min(1.0, std::max(0, view.mines - flags) / static_cast<double>(hidden)) : 0.0;
+			return;
+		}
+		interiorProbability = interior > 0 ? interiorMines / total / interior : 0.0;
+		for (size_t index = 0; index < exact.size(); index++) {
+			Component& component = *exact[index];
+			std::vector<double> others = convolve(prefix[index], suffix[index + 1]);
+			// rest[k]: the weight of everything else when this component holds k mines
+			std::vector<double> rest(component.ways.size(), 0.0);
+			double own = 0.0;
+			for (size_t mines = 0; mines < rest.size() && mines <= static_cast<size_t>(left); mines++) {
+				for (size_t other = 0; other < others.size() && mines + other <= static_cast<size_t>(left); other++) {
+					rest[mines] += others[other] * weight[mines + other];
+				}
+				own += component.ways[mines] * rest[mines];
+			}
+			size_t stride = component.cells.size() + 1;
+			for (size_t cell = 0; cell < component.cells.size(); cell++) {
+				double mine = 0.0;
+				for (size_t mines = 0; mines < rest.size(); mines++) {
+					mine += component.cellWays[cell * stride + mines] * rest[mines];
+				}
+				probability[static_cast<size_t>(component.cells[cell])] = own > 0 ? mine / own : localEstimate(component.cells[cell]);
+			}
+		}
+	}
+
+	/* Function Name: getProbability()
+	 *
+	 * Function Description:
+	 * This function gives the chance that a hidden square is a mine
+	 *
+	 * Parameters:
+	 * The location parameter is the square
+	 *
+	 * return value:
+	 * the chance, 0 for a revealed square and 1 for a flag
+	 */
+	double Advisor::getProbability(Point location) {
+		int cell = location.y * view.width + location.x;
+		signed char seen = view.cells[static_cast<size_t>(cell)];
+		if (seen != PlayerView::HIDDEN) {
+			return seen >= 0 ? 0.0 : 1.0;
+		}
+		if (!solved) {
+			solve();
+		}
+		return componentOf[static_cast<size_t>(cell)] >= 0 ? probability[static_cast<size_t>(cell)] : interiorProbability;
+	}
+
+	// expectedReveal(): how many squares a click is expected to open: the square if it is safe, and its hidden
+	// neighbours too if none of them is a mine, taking the neighbours as independent
+	double Advisor::expectedReveal(int cell) {
+		double safe = 1.0 - getProbability(Point(cell % view.width, cell / view.width)), allSafe = 1.0;
+		int around = 0;
+		view.neighbours->forEachNeighbour(cell, [this, &allSafe, &around](int neighbour) {
+			if (view.cells[static_cast<size_t>(neighbour)] == PlayerView::HIDDEN) {
+				allSafe *= 1.0 - getProbability(Point(neighbour % view.width, neighbour / view.width));
+				around++;
+			}
+		});
+		return safe * (1.0 + allSafe * around);
+	}
+
+	/* Function Name: safest()
+	 *
+	 * Function Description:
+	 * This function finds the hidden square least likely to be a mine. Of squares that are as safe,
+	 * the one expected to open the most is chosen
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * a reveal, certain when the square cannot be a mine, or action NONE when nothing is hidden
+	 */
+	Hint Advisor::safest() {
+		if (hidden + flags == static_cast<int>(view.cells.size())) { // the first square opened is never a mine
+			return Hint(HintAction::REVEAL, Point(view.width / 2, view.height / 2), true, 0.0);
+		}
+		Hint best;
+		double bestReveal = -1.0;
+		for (size_t cell = 0; cell < view.cells.size(); cell++) {
+			if (view.cells[cell] != PlayerView::HIDDEN) {
+				continue;
+			}
+			Point location(static_cast<int>(cell) % view.width, static_cast<int>(cell) / view.width);
+			double mine = getProbability(location);
+			bool safer = best.action == HintAction::NONE || mine < best.mineProbability - 1e-9;
+			if (!safer && mine > best.mineProbability + 1e-9) {
+				continue;
+			}
+			double reveal = expectedReveal(static_cast<int>(cell));
+			if (safer || reveal > bestReveal) {
+				best = Hint(HintAction::REVEAL, location, mine < 1e-9, mine);
+				bestReveal = reveal;
+			}
+		}
+		return best;
+	}
+
+	/* Function Name: mostRevealing()
+	 *
+	 * Function Description:
+	 * This function finds the hidden square a click is expected to open the most squares with,
+	 * counting a mine as opening none
+	 *
+	 * Parameters:
+	 * The expected parameter receives how many squares it is expected to open
+	 *
+	 * return value:
+	 * a reveal, or action NONE when nothing is hidden
+	 */
+	Hint Advisor::mostRevealing(double& expected) {
+		Hint best;
+		expected = 0.0;
+		for (size_t cell = 0; cell < view.cells.size(); cell++) {
+			if (view.cells[cell] != PlayerView::HIDDEN) {
+				continue;
+			}
+			double reveal = expectedReveal(static_cast<int>(cell));
+			if (best.action == HintAction::NONE || reveal > expected) {
+				Point location(static_cast<int>(cell) % view.width, static_cast<int>(cell) / view.width);
+				double mine = getProbability(location);
+				best = Hint(HintAction::REVEAL, location, mine < 1e-9, mine);
+				expected = reveal;
+			}
+		}
+		return best;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Cancel Token
+	/////////////////////////////////////////////
+
+	CancelToken::State::State() : cancelled(false), pending(0) {}
+
+	CancelToken::CancelToken() : state(std::make_shared<State>()) {}
+
+	// cancel(): drops the group's tasks that have not started, and tells running ones to stop
+	void CancelToken::cancel() {
+		state->cancelled.store(true, std::memory_order_release);
+	}
+
+	bool CancelToken::isCancelled() const {
+		return state->cancelled.load(std::memory_order_acquire);
+	}
+
+	// getPending(): the group's tasks that are queued or running
+	int CancelToken::getPending() const {
+		return state->pending.load(std::memory_order_acquire);
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Worker Pool
+	/////////////////////////////////////////////
+
+	thread_local WorkerPool* currentPool = nullptr;
+	thread_local unsigned int currentWorker = 0;
+
+	std::mutex WorkerPool::sharedMutex;
+	unsigned int WorkerPool::sharedThreads = 0;
+	bool WorkerPool::sharedPinned = false;
+	bool WorkerPool::sharedStarted = false;
+
+	WorkerPool::WorkerPool(unsigned int threadCount) : WorkerPool(threadCount, false) {}
+
+	WorkerPool::WorkerPool(unsigned int threadCount, bool pinned) : queued(0), stopping(false), pinned(pinned) {
+		if (threadCount == 0) {
+			threadCount = 1;
+		}
+		for (unsigned int index = 0; index < threadCount; index++) {
+			queues.emplace_back(new Queue());
+		}
+		for (unsigned int index = 0; index < threadCount; index++) {
+			threads.emplace_back(&WorkerPool::work, this, index);
+		}
+		if (pinned) {
+			pin();
+		}
+	}
+
+	WorkerPool::~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			stopping = true;
+		}
+		available.notify_all();
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	inline unsigned int WorkerPool::getThreadCount() {
+		return static_cast<unsigned int>(threads.size());
+	}
+
+	// isPinned(): whether each worker was tied to a core of its own
+	inline bool WorkerPool::isPinned() {
+		return pinned;
+	}
+
+	/* Function Name: pin()
+	 *
+	 * Function Description:
+	 * This function ties worker n to the n-th core the process may run on, wrapping around when there are more
+	 * workers than cores. Platforms without thread affinity leave the workers where the system puts them
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void WorkerPool::pin() {
+#ifdef core_pinning
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+			pinned = false;
+			return;
+		}
+		std::vector<int> cores;
+		for (int core = 0; core < CPU_SETSIZE; core++) {
+			if (CPU_ISSET(core, &allowed)) {
+				cores.push_back(core);
+			}
+		}
+		for (size_t index = 0; index < threads.size() && !cores.empty(); index++) {
+			cpu_set_t one;
+			CPU_ZERO(&one);
+			CPU_SET(cores[index % cores.size()], &one);
+			if (pthread_setaffinity_np(threads[index].native_handle(), sizeof(one), &one) != 0) {
+				pinned = false;
+			}
+		}
+#elif defined(windows)
+		DWORD_PTR allowed, system;
+		if (!GetProcessAffinityMask(GetCurrentProcess(), &allowed, &system) || allowed == 0) {
+			pinned = false;
+			return;
+		}
+		std::vector<DWORD_PTR> cores;
+		for (size_t core = 0; core < sizeof(DWORD_PTR) * 8; core++) {
+			if (allowed & (DWORD_PTR(1) << core)) {
+				cores.push_back(DWORD_PTR(1) << core);
+			}
+		}
+		for (size_t index = 0; index < threads.size(); index++) {
+			if (SetThreadAffinityMask(threads[index].native_handle(), cores[index % cores.size()]) == 0) {
+				pinned = false;
+			}
+		}
+#else
+		pinned = false;
+#endif
+	}
+
+	/* Function Name: configure()
+	 *
+	 * Function Description:
+	 * This function sets up the shared pool before it is first used: how many workers it has, 0 for one per core,
+	 * and whether they are pinned. It is refused once the pool has started or been set up already
+	 *
+	 * Parameters:
+	 * The threadCount parameter is the number of workers
+	 * The pinned parameter is whether to tie each worker to a core
+	 *
+	 * return value:
+	 * true if the settings will be used
+	 */
+	bool WorkerPool::configure(unsigned int threadCount, bool pinned) {
+		std::lock_guard<std::mutex> lock(sharedMutex);
+		if (sharedStarted || sharedThreads != 0 || sharedPinned) {
+			return false;
+		}
+		sharedThreads = threadCount;
+		sharedPinned = pinned;
+		return true;
+	}
+
+	/* Function Name: shared()
+	 *
+	 * Function Description:
+	 * This function returns the pool that the engine, the solvers and the simulations all run their work on.
+	 * It has one thread per core unless configure() said otherwise, and is started the first time it is needed
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the pool
+	 */
+	WorkerPool& WorkerPool::shared() {
+		static std::unique_ptr<WorkerPool> pool([] {
+			std::lock_guard<std::mutex> lock(sharedMutex);
+			sharedStarted = true;
+			return new WorkerPool(sharedThreads > 0 ? sharedThreads : std::max(1u, std::thread::hardware_concurrency()), sharedPinned);
+		}());
+		return *pool;
+	}
+
+	// push(): queues a task on one of the queues and wakes a worker for it
+	void WorkerPool::push(Queue& queue, Task task) {
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.tasks.push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			queued++;
+		}
+		available.notify_one();
+	}
+
+	void WorkerPool::submit(std::function<void()> task) {
+		static const CancelToken ungrouped; // never cancelled or waited for, so ungrouped tasks share one instead of allocating their own
+		submit(std::move(task), ungrouped);
+	}
+
+	/* Function Name: submit()
+	 *
+	 * Function Description:
+	 * This function queues a task of a group. Tasks submitted by a worker go on that worker's own queue,
+	 * others on the global queue. When the global queue is full the task runs straight away on the calling
+	 * thread instead, so a thread that floods the pool is slowed down rather than queueing without bound
+	 *
+	 * Parameters:
+	 * The task parameter is the function to run
+	 * The token parameter is the group it belongs to
+	 *
+	 * return value:
+	 * none
+	 */
+	void WorkerPool::submit(std::function<void()> task, CancelToken token) {
+		if (token.isCancelled()) {
+			return;
+		}
+		token.state->pending.fetch_add(1, std::memory_order_acq_rel);
+		Task queuedTask{ std::move(task), std::move(token) };
+		if (currentPool == this) {
+			push(*queues[currentWorker], std::move(queuedTask));
+			return;
+		}
+		{
+			std::unique_lock<std::mutex> lock(global.mutex);
+			if (global.tasks.size() < GLOBAL_LIMIT) {
+				lock.unlock();
+				push(global, std::move(queuedTask));
+				return;
+			}
+		}
+		run(queuedTask);
+	}
+
+	/* Function Name: defer()
+	 *
+	 * Function Description:
+	 * This function queues a task behind the others on the global queue, even from a worker, so long running
+	 * work can be cut into pieces that take turns with everything else on the pool
+	 *
+	 * Parameters:
+	 * The task parameter is the function to run
+	 * The token parameter is the group it belongs to
+	 *
+	 * return value:
+	 * none
+	 */
+	void WorkerPool::defer(std::function<void()> task, CancelToken token) {
+		if (token.isCancelled()) {
+			return;
+		}
+		token.state->pending.fetch_add(1, std::memory_order_acq_rel);
+		push(global, Task{ std::move(task), std::move(token) });
+	}
+
+	// run(): runs a task unless its group was cancelled, and counts it as finished
+	void WorkerPool::run(Task& task) {
+		CancelToken::State& state = *task.token.state;
+		if (!state.cancelled.load(std::memory_order_acquire)) {
+			task.body();
+		}
+		task.body = nullptr;
+		if (state.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> lock(state.mutex);
+			state.finished.notify_all();
+		}
+	}
+
+	/* Function Name: runOne()
+	 *
+	 * Function Description:
+	 * This function runs one queued task. A worker takes the newest task of its own queue first, then
+	 * the oldest of the global queue, and otherwise steals the oldest task of another worker
+	 *
+	 * Parameters:
+	 * The worker parameter is the calling worker, or -1 for a thread outside the pool
+	 *
+	 * return value:
+	 * true if a task was run
+	 */
+	bool WorkerPool::runOne(int worker) {
+		Task task;
+		bool found = false;
+		size_t first = worker < 0 ? 0 : static_cast<size_t>(worker);
+		if (worker >= 0) {
+			Queue& queue = *queues[first];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.back());
+				queue.tasks.pop_back();
+				found = true;
+			}
+		}
+		if (!found) {
+			std::lock_guard<std::mutex> lock(global.mutex);
+			if (!global.tasks.empty()) {
+				task = std::move(global.tasks.front());
+				global.tasks.pop_front();
+				found = true;
+			}
+		}
+		for (size_t offset = worker < 0 ? 0 : 1; offset < queues.size() && !found; offset++) {
+			Queue& queue = *queues[(first + offset) % queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.tasks.empty()) {
+				task = std::move(queue.tasks.front());
+				queue.tasks.pop_front();
+				found = true;
+			}
+		}
+		if (!found) {
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			queued--;
+		}
+		run(task);
+		return true;
+	}
+
+	void WorkerPool::runAll(std::vector<std::function<void()>> tasks) {
+		runAll(std::move(tasks), CancelToken());
+	}
+
+	/* Function Name: runAll()
+	 *
+	 * Function Description:
+	 * This function runs a group of tasks and returns once all of them have finished or been dropped.
+	 * The calling thread runs queued tasks while it waits
+	 *
+	 * Parameters:
+	 * The tasks parameter is the group of tasks
+	 * The token parameter is the group's token, cancelling it drops the tasks that have not started
+	 *
+	 * return value:
+	 * none
+	 */
+	void WorkerPool::runAll(std::vector<std::function<void()>> tasks, CancelToken token) {
+		for (std::function<void()>& task : tasks) {
+			submit(std::move(task), token);
+		}
+		wait(token);
+	}
+
+	/* Function Name: wait()
+	 *
+	 * Function Description:
+	 * This function returns once every task of a group has finished or been dropped.
+	 * The calling thread runs queued tasks while it waits
+	 *
+	 * Parameters:
+	 * The token parameter is the group
+	 *
+	 * return value:
+	 * none
+	 */
+	void WorkerPool::wait(CancelToken token) {
+		CancelToken::State& state = *token.state;
+		int worker = currentPool == this ? static_cast<int>(currentWorker) : -1;
+		while (state.pending.load(std::memory_order_acquire) > 0) {
+			if (!runOne(worker)) {
+				std::unique_lock<std::mutex> lock(state.mutex);
+				state.finished.wait_for(lock, std::chrono::milliseconds(1), [&state] { return state.pending.load(std::memory_order_acquire) == 0; });
+			}
+		}
+	}
+
+	void WorkerPool::work(unsigned int index) {
+		currentPool = this;
+		currentWorker = index;
+		while (true) {
+			if (runOne(static_cast<int>(index))) {
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			available.wait(lock, [this] { return stopping || queued > 0; });
+			if (stopping && queued == 0) {
+				return; // stopping and drained
+			}
+		}
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Sample Estimate
+	/////////////////////////////////////////////
+
+	SampleEstimate::SampleEstimate() : samples(0) {}
+
+	/* Function Name: bestMove()
+	 *
+	 * Function Description:
+	 * This function picks the hidden square least likely to be a mine.
+	 * Between equally safe squares the one expected to tell the most wins
+	 *
+	 * Parameters:
+	 * The view parameter is the view the estimate was made from
+	 *
+	 * return value:
+	 * the hint, with action NONE if nothing was sampled
+	 */
+	Hint SampleEstimate::bestMove(PlayerView& view) {
+		Hint best;
+		double bestInformation = -1.0;
+		if (samples == 0) {
+			return best;
+		}
+		for (size_t index = 0; index < view.cells.size(); index++) {
+			if (view.cells[index] != PlayerView::HIDDEN) {
+				continue;
+			}
+			double probability = mineProbability[index];
+			bool safer = best.action == HintAction::NONE || probability < best.mineProbability - 1e-9;
+			bool asSafe = !safer && probability < best.mineProbability + 1e-9;
+			if (safer || (asSafe && information[index] > bestInformation)) {
+				int cell = static_cast<int>(index);
+				best = Hint(HintAction::REVEAL, Point(cell % view.width, cell / view.width), probability < 1e-12, probability);
+				bestInformation = information[index];
+			}
+		}
+		return best;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Mine Sampler
+	/////////////////////////////////////////////
+
+	/* Class Name: MineSampler::Tally
+	 *
+	 * Class Description:
+	 * This Class adds up what a set of samples saw
+	 */
+	class MineSampler::Tally {
+	public:
+		int samples;
+		ArenaVector<double> frontierMines, frontierNumbers, interiorNumbers;
+		double interiorMines;
+		Tally(size_t frontierSize, GameArena* arena) : samples(0), frontierMines(frontierSize, 0.0, ArenaAllocator<double>(arena)),
+			frontierNumbers(frontierSize * 9, 0.0, ArenaAllocator<double>(arena)), interiorNumbers(9 * 9, 0.0, ArenaAllocator<double>(arena)), interiorMines(0.0) {}
+		void add(Tally& other) {
+			samples += other.samples;
+			interiorMines += other.interiorMines;
+			for (size_t index = 0; index < frontierMines.size(); index++) frontierMines[index] += other.frontierMines[index];
+			for (size_t index = 0; index < frontierNumbers.size(); index++) frontierNumbers[index] += other.frontierNumbers[index];
+			for (size_t index = 0; index < interiorNumbers.size(); index++) interiorNumbers[index] += other.interiorNumbers[index];
+		}
+	};
+
+	/* Class Name: MineSampler::Chain
+	 *
+	 * Class Description:
+	 * This Class is one Markov chain over the mine layouts of the frontier squares
+	 */
+	class MineSampler::Chain {
+	public:
+		MineSampler& model;
+		GameArena* arena;
+		std::mt19937_64 random;
+		ArenaVector<char> value;
+		ArenaVector<int> sum;
+		int mines;
+		Chain(MineSampler& model, GameArena* arena, uint64_t seed) : model(model), arena(arena), random(seed),
+			value(ArenaAllocator<char>(arena)), sum(ArenaAllocator<int>(arena)), mines(0) {}
+
+		void assign(int position, char mine) {
+			value[static_cast<size_t>(position)] = mine;
+			mines += mine;
+			for (int constraint : model.constraintsOf[static_cast<size_t>(position)]) {
+				sum[static_cast<size_t>(constraint)] += mine;
+			}
+		}
+
+		/* Function Name: start()
+		 *
+		 * Function Description:
+		 * This function finds a random valid layout by backtracking over the frontier in an order
+		 * that keeps neighbouring squares together, trying the two values in a random order
+		 *
+		 * return value:
+		 * true if a layout was found within the step limit
+		 */
+		bool start() {
+			size_t size = model.frontier.size();
+			value.assign(size, 0);
+			sum.assign(model.constraints.size(), 0);
+			mines = 0;
+			ArenaVector<int> open(model.constraints.size(), 0, ArenaAllocator<int>(arena));
+			for (size_t index = 0; index < open.size(); index++) {
+				open[index] = static_cast<int>(model.constraints[index].cells.size());
+			}
+			ArenaVector<char> tried(size, 0, ArenaAllocator<char>(arena)), first(size, 0, ArenaAllocator<char>(arena)), assigned(size, 0, ArenaAllocator<char>(arena));
+			for (size_t index = 0; index < size; index++) {
+				first[index] = static_cast<char>(random() & 1);
+			}
+			int steps = 250000;
+			int depth = 0;
+			while (depth < static_cast<int>(size)) {
+				if (--steps < 0) {
+					return false;
+				}
+				int position = model.order[static_cast<size_t>(depth)];
+				size_t slot = static_cast<size_t>(position);
+				if (assigned[slot]) { // coming back to this square: undo it before trying the next value
+					for (int constraint : model.constraintsOf[slot]) {
+						open[static_cast<size_t>(constraint)]++;
+					}
+					assign(position, static_cast<char>(-value[slot]));
+					value[slot] = 0;
+					assigned[slot] = 0;
+				}
+				if (tried[slot] == 2) {
+					tried[slot] = 0;
+					if (--depth < 0) {
+						return false;
+					}
+					continue;
+				}
+				char mine = tried[slot] == 0 ? first[slot] : static_cast<char>(1 - first[slot]);
+				tried[slot]++;
+				for (int constraint : model.constraintsOf[slot]) {
+					open[static_cast<size_t>(constraint)]--;
+				}
+				assign(position, mine);
+				value[slot] = mine;
+				assigned[slot] = 1;
+				bool fits = mines <= model.minesLeft && model.minesLeft - mines - (static_cast<int>(size) - depth - 1) <= model.interior;
+				for (int constraint : model.constraintsOf[slot]) {
+					size_t c = static_cast<size_t>(constraint);
+					fits = fits && sum[c] <= model.constraints[c].need && sum[c] + open[c] >= model.constraints[c].need;
+				}
+				if (fits) {
+					depth++;
+				}
+			}
+			return model.minesLeft - mines >= 0 && model.minesLeft - mines <= model.interior;
+		}
+
+		/* Function Name: sweep()
+		 *
+		 * Function Description:
+		 * This function re-draws one block per constraint. A block is the squares of a random number,
+		 * sometimes together with an overlapping number, and it is re-drawn from every assignment that
+		 * keeps all numbers satisfied, weighted by the ways to place the remaining mines in the interior
+		 *
+		 * return value:
+		 * none
+		 */
+		void sweep() {
+			size_t constraintCount = model.constraints.size();
+			ArenaVector<int> block{ ArenaAllocator<int>(arena) }, merged{ ArenaAllocator<int>(arena) };
+			ArenaVector<int> affected{ ArenaAllocator<int>(arena) }, masks{ ArenaAllocator<int>(arena) };
+			ArenaVector<double> weights{ ArenaAllocator<double>(arena) };
+			for (size_t step = 0; step < constraintCount; step++) {
+				Constraint& chosen = model.constraints[random() % constraintCount];
+				block.assign(chosen.cells.begin(), chosen.cells.end());
+				if (random() & 1) {
+					int cell = block[random() % block.size()];
+					ArenaVector<int>& others = model.constraintsOf[static_cast<size_t>(cell)];
+					ArenaVector<int>& extra = model.constraints[static_cast<size_t>(others[random() % others.size()])].cells;
+					merged.clear();
+					std::set_union(block.begin(), block.end(), extra.begin(), extra.end(), std::back_inserter(merged));
+					if (merged.size() <= 10) {
+						block.swap(merged);
+					}
+				}
+				for (int position : block) {
+					if (value[static_cast<size_t>(position)]) {
+						assign(position, -1);
+						value[static_cast<size_t>(position)] = 0;
+					}
+				}
+				affected.clear();
+				for (int position : block) {
+					for (int constraint : model.constraintsOf[static_cast<size_t>(position)]) {
+						if (std::find(affected.begin(), affected.end(), constraint) == affected.end()) {
+							affected.push_back(constraint);
+						}
+					}
+				}
+				masks.assign(affected.size(), 0);
+				for (size_t bit = 0; bit < block.size(); bit++) {
+					for (size_t index = 0; index < affected.size(); index++) {
+						ArenaVector<int>& cells = model.constraints[static_cast<size_t>(affected[index])].cells;
+						if (std::binary_search(cells.begin(), cells.end(), block[bit])) {
+							masks[index] |= 1 << bit;
+						}
+					}
+				}
+				int combinations = 1 << block.size();
+				weights.assign(static_cast<size_t>(combinations), 0.0);
+				double best = -1e300;
+				for (int mask = 0; mask < combinations; mask++) {
+					bool valid = true;
+					for (size_t index = 0; index < affected.size() && valid; index++) {
+						size_t c = static_cast<size_t>(affected[index]);
+						valid = popCount(mask & masks[index]) == model.constraints[c].need - sum[c];
+					}
+					int rest = model.minesLeft - mines - popCount(mask);
+					double weight = valid && rest >= 0 && rest < static_cast<int>(model.interiorWays.size()) ? model.interiorWays[static_cast<size_t>(rest)] : -1e300;
+					weights[static_cast<size_t>(mask)] = weight;
+					best = std::max(best, weight);
+				}
+				double total = 0.0;
+				for (double& weight : weights) {
+					weight = weight <= -1e299 ? 0.0 : std::exp(weight - best);
+					total += weight;
+				}
+				double pick = std::uniform_real_distribution<double>(0.0, total)(random);
+				int chosenMask = 0;
+				for (int mask = 0; mask < combinations; mask++) {
+					if (weights[static_cast<size_t>(mask)] <= 0.0) {
+						continue;
+					}
+					chosenMask = mask;
+					pick -= weights[static_cast<size_t>(mask)];
+					if (pick <= 0.0) {
+						break;
+					}
+				}
+				for (size_t bit = 0; bit < block.size(); bit++) {
+					if (chosenMask & (1 << bit)) {
+						assign(block[bit], 1);
+					}
+				}
+			}
+		}
+
+		/* Function Name: record()
+		 *
+		 * Function Description:
+		 * This function adds the current layout to a tally, including the distribution of the number
+		 * each safe frontier square would show
+		 *
+		 * return value:
+		 * none
+		 */
+		void record(Tally& tally) {
+			double density = model.interior > 0 ? (model.minesLeft - mines) / static_cast<double>(model.interior) : 0.0;
+			double binomial[9][9];
+			for (int n = 0; n <= 8; n++) {
+				for (int k = 0; k <= 8; k++) {
+					binomial[n][k] = k > n ? 0.0 : std::exp(logChoose(n, k)) * std::pow(density, k) * std::pow(1.0 - density, n - k);
+				}
+			}
+			tally.samples++;
+			tally.interiorMines += density;
+			for (size_t position = 0; position < value.size(); position++) {
+				if (value[position]) {
+					tally.frontierMines[position] += 1.0;
+					continue;
+				}
+				int known = model.flagNeighbours[position];
+				for (int neighbour : model.frontierNeighbours[position]) {
+					known += value[static_cast<size_t>(neighbour)];
+				}
+				int unknown = model.interiorNeighbours[position];
+				for (int k = 0; k <= unknown && known + k <= 8; k++) {
+					tally.frontierNumbers[position * 9 + static_cast<size_t>(known + k)] += binomial[unknown][k];
+				}
+			}
+			for (int n = 0; n <= 8; n++) {
+				for (int k = 0; k <= n; k++) {
+					tally.interiorNumbers[static_cast<size_t>(n * 9 + k)] += binomial[n][k];
+				}
+			}
+		}
+	};
+
+	MineSampler::MineSampler(PlayerView& view, WorkerPool& pool) : scope(GameArena::scratch()), arena(&GameArena::scratch()), view(view), pool(pool),
+		frontier(ArenaAllocator<int>(arena)), frontierIndex(ArenaAllocator<int>(arena)), order(ArenaAllocator<int>(arena)),
+		constraints(ArenaAllocator<Constraint>(arena)), constraintsOf(ArenaAllocator<ArenaVector<int>>(arena)),
+		frontierNeighbours(ArenaAllocator<ArenaVector<int>>(arena)), flagNeighbours(ArenaAllocator<int>(arena)),
+		interiorNeighbours(ArenaAllocator<int>(arena)), interiorWays(ArenaAllocator<double>(arena)), interior(0), minesLeft(0) {
+		buildModel();
+	}
+
+	/* Function Name: buildModel()
+	 *
+	 * Function Description:
+	 * This function splits the hidden squares into the frontier, which touches a number,
+	 * and the interior, which does not, and indexes the constraints by frontier square
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void MineSampler::buildModel() {
+		constraints = Solver::findConstraints(view, arena);
+		frontierIndex.assign(view.cells.size(), -1);
+		for (Constraint& constraint : constraints) {
+			for (int& cell : constraint.cells) {
+				if (frontierIndex[static_cast<size_t>(cell)] < 0) {
+					frontierIndex[static_cast<size_t>(cell)] = static_cast<int>(frontier.size());
+					frontier.push_back(cell);
+				}
+				cell = frontierIndex[static_cast<size_t>(cell)];
+			}
+			std::sort(constraint.cells.begin(), constraint.cells.end());
+		}
+		constraintsOf.assign(frontier.size(), ArenaVector<int>(ArenaAllocator<int>(arena)));
+		for (size_t index = 0; index < constraints.size(); index++) {
+			for (int position : constraints[index].cells) {
+				constraintsOf[static_cast<size_t>(position)].push_back(static_cast<int>(index));
+			}
+		}
+		int hidden = 0, flags = 0;
+		for (signed char cell : view.cells) {
+			hidden += cell == PlayerView::HIDDEN;
+			flags += cell == PlayerView::FLAG;
+		}
+		interior = hidden - static_cast<int>(frontier.size());
+		minesLeft = std::max(0, view.mines - flags);
+		interiorWays.clear();
+		for (int mines = 0; mines <= std::min(minesLeft, interior); mines++) {
+			interiorWays.push_back(logChoose(interior, mines));
+		}
+		// neighbourhoods of the frontier, used for the number a safe square would show
+		frontierNeighbours.assign(frontier.size(), ArenaVector<int>(ArenaAllocator<int>(arena)));
+		flagNeighbours.assign(frontier.size(), 0);
+		interiorNeighbours.assign(frontier.size(), 0);
+		for (size_t position = 0; position < frontier.size(); position++) {
+			view.neighbours->forEachNeighbour(frontier[position], [&](int cell) {
+				signed char seen = view.cells[static_cast<size_t>(cell)];
+				if (seen == PlayerView::FLAG) {
+					flagNeighbours[position]++;
+				}
+				else if (seen == PlayerView::HIDDEN && frontierIndex[static_cast<size_t>(cell)] >= 0) {
+					frontierNeighbours[position].push_back(frontierIndex[static_cast<size_t>(cell)]);
+				}
+				else if (seen == PlayerView::HIDDEN) {
+					interiorNeighbours[position]++;
+				}
+			});
+		}
+		// breadth first order over shared constraints keeps the backtracking local
+		ArenaVector<char> visited(frontier.size(), 0, ArenaAllocator<char>(arena));
+		order.clear();
+		for (size_t root = 0; root < frontier.size(); root++) {
+			if (visited[root]) {
+				continue;
+			}
+			visited[root] = 1;
+			size_t head = order.size();
+			order.push_back(static_cast<int>(root));
+			while (head < order.size()) {
+				int position = order[head++];
+				for (int constraint : constraintsOf[static_cast<size_t>(position)]) {
+					for (int next : constraints[static_cast<size_t>(constraint)].cells) {
+						if (!visited[static_cast<size_t>(next)]) {
+							visited[static_cast<size_t>(next)] = 1;
+							order.push_back(next);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/* Function Name: estimate()
+	 *
+	 * Function Description:
+	 * This function samples layouts in parallel until the time budget runs out
+	 * and turns the counts into per square estimates
+	 *
+	 * Parameters:
+	 * The budgetMillis parameter is the time budget in milliseconds
+	 *
+	 * return value:
+	 * the estimate, with samples set to zero if no valid layout was found
+	 */
+	SampleEstimate MineSampler::estimate(int budgetMillis) {
+		constexpr int samplesPerBatch = 64;
+		constexpr int burnIn = 24;
+		constexpr int maxSamples = 100000;
+		SampleEstimate result;
+		result.mineProbability.assign(view.cells.size(), -1.0);
+		result.information.assign(view.cells.size(), 0.0);
+		if (interior + static_cast<int>(frontier.size()) == 0) {
+			return result;
+		}
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(budgetMillis);
+		Tally total(frontier.size(), arena);
+		std::mutex totalMutex;
+		uint64_t seed = (static_cast<uint64_t>(std::random_device()()) << 32) ^ static_cast<uint64_t>(currentTimeSeconds());
+		while (std::chrono::steady_clock::now() < deadline && total.samples < maxSamples) {
+			int before = total.samples;
+			std::vector<std::function<void()>> batches;
+			for (unsigned int batch = 0; batch < pool.getThreadCount() * 2; batch++) {
+				uint64_t batchSeed = seed++;
+				batches.push_back([this, batchSeed, deadline, &total, &totalMutex]() {
+					GameArena& scratch = GameArena::scratch();
+					ArenaScope batchScope(scratch);
+					Chain chain(*this, &scratch, batchSeed);
+					if (!chain.start()) {
+						return;
+					}
+					Tally tally(frontier.size(), &scratch);
+					for (int sweep = 0; sweep < burnIn; sweep++) {
+						chain.sweep();
+					}
+					for (int sample = 0; sample < samplesPerBatch && std::chrono::steady_clock::now() < deadline; sample++) {
+						chain.sweep();
+						chain.record(tally);
+					}
+					std::lock_guard<std::mutex> lock(totalMutex);
+					total.add(tally);
+				});
+			}
+			pool.runAll(batches);
+			if (total.samples == before) {
+				break; // no valid layout could be found, the view contradicts itself
+			}
+		}
+		result.samples = total.samples;
+		if (total.samples == 0) {
+			return result;
+		}
+		auto entropy = [](const double* counts) {
+			double sum = 0.0, bits = 0.0;
+			for (int k = 0; k <= 8; k++) sum += counts[k];
+			for (int k = 0; k <= 8; k++) {
+				if (counts[k] > 0.0) bits -= counts[k] / sum * std::log2(counts[k] / sum);
+			}
+			return bits;
+		};
+		double interiorProbability = total.interiorMines / total.samples;
+		for (size_t index = 0; index < view.cells.size(); index++) {
+			if (view.cells[index] != PlayerView::HIDDEN) {
+				continue;
+			}
+			int position = frontierIndex[index];
+			if (position >= 0) {
+				double probability = total.frontierMines[static_cast<size_t>(position)] / total.samples;
+				result.mineProbability[index] = probability;
+				result.information[index] = probability < 1.0 ? (1.0 - probability) * entropy(&total.frontierNumbers[static_cast<size_t>(position) * 9]) : 0.0;
+				continue;
+			}
+			// interior squares: the number is estimated from how many hidden neighbours they have
+			int hiddenNeighbours = 0;
+			view.neighbours->forEachNeighbour(static_cast<int>(index), [&](int cell) {
+				hiddenNeighbours += view.cells[static_cast<size_t>(cell)] == PlayerView::HIDDEN;
+			});
+			result.mineProbability[index] = interiorProbability;
+			result.information[index] = (1.0 - interiorProbability) * entropy(&total.interiorNumbers[static_cast<size_t>(hiddenNeighbours) * 9]);
+		}
+		return result;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Strategies
+	/////////////////////////////////////////////
+
+	// Strategy: Trivial virtual destructor
+	Strategy::~Strategy() {}
+
+	// newGame(): strategies without state ignore the start of a game
+	void Strategy::newGame(uint64_t) {}
+
+	/* Function Name: create()
+	 *
+	 * Function Description:
+	 * This function makes a strategy from its name: solver, sampler or random
+	 *
+	 * Parameters:
+	 * The name parameter is the name of the strategy
+	 *
+	 * return value:
+	 * the strategy, or nullptr if there is none with that name
+	 */
+	std::unique_ptr<Strategy> Strategy::create(std::string name) {
+		if (name == "solver") {
+			return std::unique_ptr<Strategy>(new SolverStrategy());
+		}
+		if (name == "sampler") {
+			return std::unique_ptr<Strategy>(new SamplerStrategy(20));
+		}
+		if (name == "random") {
+			return std::unique_ptr<Strategy>(new RandomStrategy());
+		}
+		return nullptr;
+	}
+
+	std::string SolverStrategy::getName() {
+		return "solver";
+	}
+
+	Hint SolverStrategy::nextMove(PlayerView& view) {
+		return Solver(view).findHint();
+	}
+
+	SamplerStrategy::SamplerStrategy(int budgetMillis) : budgetMillis(budgetMillis) {}
+
+	std::string SamplerStrategy::getName() {
+		return "sampler";
+	}
+
+	Hint SamplerStrategy::nextMove(PlayerView& view) {
+		Hint hint = Solver(view).findHint();
+		if (!hint.certain && hint.action == HintAction::REVEAL) {
+			SampleEstimate estimate = MineSampler(view, WorkerPool::shared()).estimate(budgetMillis);
+			if (estimate.samples > 0) {
+				hint = estimate.bestMove(view);
+			}
+		}
+		return hint;
+	}
+
+	std::string RandomStrategy::getName() {
+		return "random";
+	}
+
+	void RandomStrategy::newGame(uint64_t seed) {
+		random.seed(seed);
+	}
+
+	Hint RandomStrategy::nextMove(PlayerView& view) {
+		Hint hint = Solver(view).findHint();
+		if (hint.certain || hint.action != HintAction::REVEAL) {
+			return hint;
+		}
+		std::vector<int> hidden;
+		for (size_t index = 0; index < view.cells.size(); index++) {
+			if (view.cells[index] == PlayerView::HIDDEN) {
+				hidden.push_back(static_cast<int>(index));
+			}
+		}
+		int cell = hidden[static_cast<size_t>(random() % hidden.size())];
+		return Hint(HintAction::REVEAL, Point(cell % view.width, cell / view.width), false, -1.0);
+	}
+
+	/* Function Name: playStrategyMove()
+	 *
+	 * Function Description:
+	 * This function shows a strategy what a player sees of a game and makes the move it picks.
+	 * Once every hidden square must be a mine they are flagged for the strategy, since the game
+	 * is only won when all mines carry a flag
+	 *
+	 * Parameters:
+	 * The game parameter is the game being played
+	 * The strategy parameter is the player
+	 * The played parameter receives the move that was made
+	 *
+	 * return value:
+	 * the result of the move, INVALID if the strategy had none
+	 */
+	ActionResult playStrategyMove(Game& game, Strategy& strategy, Hint& played) {
+		PlayerView view(game.getBoard());
+		int hidden = static_cast<int>(std::count(view.cells.begin(), view.cells.end(), PlayerView::HIDDEN));
+		int flags = static_cast<int>(std::count(view.cells.begin(), view.cells.end(), PlayerView::FLAG));
+		if (!game.isFirstMove() && hidden > 0 && hidden == view.mines - flags) {
+			int cell = static_cast<int>(std::find(view.cells.begin(), view.cells.end(), PlayerView::HIDDEN) - view.cells.begin());
+			played = Hint(HintAction::FLAG, Point(cell % view.width, cell / view.width), true, 1.0);
+		}
+		else {
+			played = strategy.nextMove(view);
+		}
+		switch (played.action) {
+		case HintAction::REVEAL:
+			return game.clickSpace(played.location);
+		case HintAction::FLAG:
+			return game.flagSpace(played.location);
+		case HintAction::CHORD:
+			return game.chordSpace(played.location);
+		default:
+			return ActionResult::INVALID;
+		}
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Tournament
+	/////////////////////////////////////////////
+
+	Tournament::Tournament(GameOptions options, int boards, uint64_t firstSeed, std::vector<std::string> strategies, std::string checkpoint)
+		: options(options), boards(boards), firstSeed(firstSeed), strategies(strategies), checkpoint(checkpoint) {
+		results.assign(strategies.size(), std::vector<TournamentGame>(static_cast<size_t>(boards)));
+	}
+
+	/* Function Name: play()
+	 *
+	 * Function Description:
+	 * This function plays one board to the end with one strategy.
+	 * A strategy that gives up or makes a move the game refuses loses the board
+	 *
+	 * Parameters:
+	 * The strategy parameter is the player
+	 * The loop parameter collects the win and loss statistics
+	 * The arena parameter holds the game's storage
+	 * The seed parameter picks the board
+	 *
+	 * return value:
+	 * the result
+	 */
+	TournamentGame Tournament::play(Strategy& strategy, GameLoop& loop, GameArena& arena, uint64_t seed) {
+		TournamentGame result;
+		GameOptions seeded = options;
+		seeded.seed = seed;
+		strategy.newGame(seed);
+		auto started = std::chrono::steady_clock::now();
+		{
+			Game game(loop, seeded, &arena);
+			while (game.getState() == GameState::PLAYING) {
+				Hint hint;
+				ActionResult action = playStrategyMove(game, strategy, hint);
+				result.moves++;
+				result.guesses += !hint.certain && hint.action == HintAction::REVEAL && result.moves > 1;
+				if (action != ActionResult::OK && action != ActionResult::EXPLODED) {
+					break; // a refused move would be offered again forever
+				}
+			}
+			result.won = game.getState() == GameState::WIN;
+			if (result.won) {
+				loop.addWin(currentTimeSeconds() - game.getStartTime());
+			}
+			else {
+				loop.addLoss(currentTimeSeconds() - game.getStartTime());
+			}
+		}
+		arena.reset();
+		result.micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started).count();
+		result.played = true;
+		return result;
+	}
+
+	/* Function Name: loadCheckpoint()
+	 *
+	 * Function Description:
+	 * This function reads the games already played from the checkpoint file, or starts the file.
+	 * Its first line describes the tournament, and a file written for another one is refused
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * true if the checkpoint can be used
+	 */
+	bool Tournament::loadCheckpoint() {
+		std::ostringstream header;
+		header << "tournament " << options.width << " " << options.height << " " << options.mines << " " << topologyName(options.topology) << " " << firstSeed;
+		std::ifstream in(checkpoint);
+		std::string line;
+		if (!std::getline(in, line)) {
+			std::ofstream out(checkpoint, std::ios::trunc);
+			out << header.str() << std::endl;
+			return static_cast<bool>(out);
+		}
+		if (line != header.str()) {
+			return false;
+		}
+		while (std::getline(in, line)) {
+			std::istringstream fields(line);
+			std::string name;
+			uint64_t seed;
+			TournamentGame game;
+			if (!(fields >> name >> seed >> game.won >> game.guesses >> game.moves >> game.micros) || seed < firstSeed || seed - firstSeed >= static_cast<uint64_t>(boards)) {
+				continue; // a line cut short when the last run was stopped, or a board outside this run
+			}
+			for (size_t index = 0; index < strategies.size(); index++) {
+				if (strategies[index] == name) {
+					game.played = true;
+					results[index][static_cast<size_t>(seed - firstSeed)] = game;
+				}
+			}
+		}
+		return true;
+	}
+
+	/* Function Name: run()
+	 *
+	 * Function Description:
+	 * This function plays every board not yet in the checkpoint with every strategy. Each task plays a
+	 * batch of boards with its own strategy, loop and arena, and appends them to the checkpoint when done
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * false if the checkpoint belongs to another tournament or a strategy is unknown
+	 */
+	bool Tournament::run() {
+		for (std::string& name : strategies) {
+			if (!Strategy::create(name)) {
+				return false;
+			}
+		}
+		if (!checkpoint.empty() && !loadCheckpoint()) {
+			return false;
+		}
+		std::vector<std::function<void()>> tasks;
+		for (size_t index = 0; index < strategies.size(); index++) {
+			for (int first = 0; first < boards; first += BATCH) {
+				int last = std::min(boards, first + BATCH);
+				bool done = true;
+				for (int board = first; board < last; board++) {
+					done &= results[index][static_cast<size_t>(board)].played;
+				}
+				if (done) {
+					continue;
+				}
+				tasks.push_back([this, index, first, last] {
+					std::unique_ptr<Strategy> strategy = Strategy::create(strategies[index]);
+					GameLoop loop(Render::RenderType::HEADLESS);
+					GameArena arena(1 << 16);
+					std::ostringstream lines;
+					for (int board = first; board < last; board++) {
+						TournamentGame& game = results[index][static_cast<size_t>(board)];
+						if (game.played) {
+							continue;
+						}
+						uint64_t seed = firstSeed + static_cast<uint64_t>(board);
+						game = play(*strategy, loop, arena, seed);
+						lines << strategies[index] << " " << seed << " " << game.won << " " << game.guesses << " " << game.moves << " " << game.micros << "\n";
+					}
+					if (!checkpoint.empty()) {
+						std::lock_guard<std::mutex> lock(checkpointMutex);
+						std::ofstream out(checkpoint, std::ios::app);
+						out << lines.str() << std::flush;
+					}
+				});
+			}
+		}
+		WorkerPool::shared().runAll(tasks);
+		return true;
+	}
+
+	/* Function Name: report()
+	 *
+	 * Function Description:
+	 * This function writes one line per strategy: the win rate with its 95% Wilson interval,
+	 * the mean and percentiles of the time taken to win, and how often it had to guess
+	 *
+	 * Parameters:
+	 * The out parameter is the stream to write to
+	 *
+	 * return value:
+	 * none
+	 */
+	void Tournament::report(std::ostream& out) {
+		out << boards << " " << topologyName(options.topology) << " boards of " << options.width << "x" << options.height << " with " << options.mines
+			<< " mines, seeds " << firstSeed << " to " << firstSeed + static_cast<uint64_t>(boards) - 1 << std::endl;
+		for (size_t index = 0; index < strategies.size(); index++) {
+			std::vector<double> times;
+			std::vector<int> guesses;
+			int wins = 0;
+			for (TournamentGame& game : results[index]) {
+				wins += game.won;
+				guesses.push_back(game.guesses);
+				if (game.won) {
+					times.push_back(game.micros / 1000.0);
+				}
+			}
+			std::sort(times.begin(), times.end());
+			std::sort(guesses.begin(), guesses.end());
+			double rate = wins / static_cast<double>(boards), z = 1.96, n = boards;
+			double centre = (rate + z * z / (2 * n)) / (1 + z * z / n);
+			double spread = z * std::sqrt(rate * (1 - rate) / n + z * z / (4 * n * n)) / (1 + z * z / n);
+			auto percentile = [](auto& values, double fraction) { return values.empty() ? 0 : values[static_cast<size_t>(fraction * (values.size() - 1))]; };
+			double timeSum = 0.0, guessSum = 0.0;
+			for (double time : times) timeSum += time;
+			for (int count : guesses) guessSum += count;
+			out << std::fixed << std::setprecision(1) << strategies[index] << ": won " << wins << "/" << boards << " = " << rate * 100
+				<< "% (95% CI " << (centre - spread) * 100 << "% to " << (centre + spread) * 100 << "%)" << std::endl;
+			out << std::setprecision(2) << "   time to win: mean " << (times.empty() ? 0.0 : timeSum / times.size()) << " ms, p50 " << percentile(times, 0.5)
+				<< " ms, p90 " << percentile(times, 0.9) << " ms, p99 " << percentile(times, 0.99) << " ms" << std::endl;
+			out << "   guesses: mean " << guessSum / boards << ", p50 " << percentile(guesses, 0.5) << ", p90 " << percentile(guesses, 0.9)
+				<< ", max " << guesses.back() << std::endl;
+		}
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Race
+	/////////////////////////////////////////////
+
+	/* Function Name: Race()
+	 *
+	 * Function Description:
+	 * This sets up a race: the first click is made on a board of its own, then every player's
+	 * game is restored from a snapshot of it
+	 *
+	 * Parameters:
+	 * The options parameter is the board, a seed of 0 picks one at random
+	 * The firstClick parameter is the square opened for everyone
+	 * The names parameter names the players
+	 *
+	 * return value:
+	 * none
+	 */
+	Race::Race(GameOptions options, Point firstClick, std::vector<std::string> names)
+		: startLoop(Render::RenderType::HEADLESS), names(names), progress(new Progress[names.size()]) {
+		options.minePlacerType = MinePlacerType::RANDOM;
+		startGame.reset(new Game(startLoop, options, nullptr)); // on the heap, the players share its chunks
+		startGame->clickSpace(firstClick);
+		start = startGame->snapshot();
+		startBoard = startGame->getBoard().snapshot();
+		opened = startLoop.getRevealed();
+		safe = options.width * options.height - options.mines;
+		options = startGame->getBoard().getOptions(); // with the seed that was picked
+		for (size_t player = 0; player < names.size(); player++) {
+			loops.emplace_back(new GameLoop(Render::RenderType::HEADLESS));
+			players.emplace_back(new Game(*loops.back(), options, nullptr));
+			players.back()->restore(start);
+			players.back()->getBoard().startOverlay();
+			progress[player].state.store(static_cast<int>(startGame->getState()));
+			progress[player].revealed.store(opened);
+			progress[player].moves.store(0);
+			progress[player].finished.store(0);
+		}
+		started = std::chrono::steady_clock::now();
+	}
+
+	int Race::getPlayerCount() {
+		return static_cast<int>(players.size());
+	}
+
+	GameOptions Race::getOptions() {
+		return startGame->getBoard().getOptions();
+	}
+
+	// getGame(): the player's game, only its own thread may use it
+	Game& Race::getGame(int player) {
+		return *players[static_cast<size_t>(player)];
+	}
+
+	/* Function Name: recordMove()
+	 *
+	 * Function Description:
+	 * This updates the leaderboard after a player has moved. It is called from the player's thread
+	 *
+	 * Parameters:
+	 * The player parameter is the player that moved
+	 *
+	 * return value:
+	 * none
+	 */
+	void Race::recordMove(int player) {
+		Progress& entry = progress[static_cast<size_t>(player)];
+		GameState state = players[static_cast<size_t>(player)]->getState();
+		entry.revealed.store(opened + loops[static_cast<size_t>(player)]->getRevealed(), std::memory_order_relaxed);
+		entry.moves.fetch_add(1, std::memory_order_relaxed);
+		if (state != GameState::PLAYING && entry.finished.load(std::memory_order_relaxed) == 0) {
+			entry.finished.store(std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count()), std::memory_order_relaxed);
+		}
+		entry.state.store(static_cast<int>(state), std::memory_order_release);
+	}
+
+	/* Function Name: getStandings()
+	 *
+	 * Function Description:
+	 * This function ranks the players: winners by how quickly they won, then players still going by how
+	 * much of the board they have opened, then players who hit a mine by how far they got
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the leaderboard, best first
+	 */
+	std::vector<RaceStanding> Race::getStandings() {
+		int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started).count();
+		std::vector<RaceStanding> standings;
+		for (size_t player = 0; player < names.size(); player++) {
+			RaceStanding standing;
+			standing.player = static_cast<int>(player);
+			standing.name = names[player];
+			standing.state = static_cast<GameState>(progress[player].state.load(std::memory_order_acquire));
+			standing.revealed = progress[player].revealed.load(std::memory_order_relaxed);
+			standing.moves = progress[player].moves.load(std::memory_order_relaxed);
+			standing.safe = safe;
+			standing.millis = standing.state == GameState::PLAYING ? now : progress[player].finished.load(std::memory_order_relaxed);
+			standings.push_back(standing);
+		}
+		auto rank = [](GameState state) { return state == GameState::WIN ? 0 : state == GameState::PLAYING ? 1 : 2; };
+		std::stable_sort(standings.begin(), standings.end(), [&rank](const RaceStanding& first, const RaceStanding& second) {
+			if (rank(first.state) != rank(second.state)) {
+				return rank(first.state) < rank(second.state);
+			}
+			if (first.state == GameState::WIN) {
+				return first.millis < second.millis;
+			}
+			return first.revealed > second.revealed;
+		});
+		return standings;
+	}
+
+	// getOverlayBytes(): what the player's overlay takes, only while nobody is moving
+	size_t Race::getOverlayBytes(int player) {
+		return players[static_cast<size_t>(player)]->getBoard().getOverlayBytes();
+	}
+
+	// countPrivateChunks(): the chunks the players have copied, which they only do for a change an overlay cannot hold
+	int Race::countPrivateChunks() {
 		int count = 0;
-		for (int xOffset = -1; xOffset <= 1; xOffset++) {
-			for (int yOffset = -1; yOffset <= 1; yOffset++) {
-				if (xOffset == 0 && yOffset == 0) {
+		for (std::unique_ptr<Game>& game : players) {
+			count += getChunkCount() - game->getBoard().countSharedChunks(startBoard);
+		}
+		return count;
+	}
+
+	int Race::getChunkCount() {
+		return startGame->getBoard().countSharedChunks(startBoard);
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Fuzzer
+	/////////////////////////////////////////////
+
+	/* Function Name: run()
+	 *
+	 * Function Description:
+	 * This function plays one input and checks every step. Any input is valid, short ones are padded with zeros
+	 *
+	 * Parameters:
+	 * The data parameter is the input
+	 * The size parameter is its length in bytes
+	 *
+	 * return value:
+	 * true if every check passed, otherwise getFailure() says which one did not
+	 */
+	bool Fuzzer::run(const uint8_t* data, size_t size) {
+		failure.clear();
+		uint8_t header[HEADER] = {};
+		std::copy(data, data + std::min<size_t>(size, HEADER), header);
+		GameOptions options;
+		options.width = 1 + header[0] % 40;
+		options.height = 1 + header[1] % 30;
+		int cells = options.width * options.height;
+		if (cells < 2) {
+			options.width = 2; // a board needs a square to click and a square for the mine
+			cells = 2;
+		}
+		options.mines = 1 + header[2] % (cells - 1);
+		options.topology = static_cast<Topology>(header[3] % 4);
+		options.minePlacerType = header[3] & 4 ? MinePlacerType::PARALLEL_RANDOM : MinePlacerType::RANDOM;
+		options.seed = 0;
+		for (int index = 4; index < HEADER; index++) {
+			options.seed = options.seed << 8 | header[index];
+		}
+		options.seed = std::max<uint64_t>(options.seed, 1);
+		options.parallelReveal = 1; // every reveal takes the parallel path where there are cores for it
+		try {
+			GameLoop loop(Render::RenderType::HEADLESS);
+			Game game(loop, options);
+			ReferenceGame reference(options);
+			std::vector<std::pair<GameSnapshot, ReferenceGame>> history;
+			std::vector<SpaceType> before(static_cast<size_t>(cells), SpaceType::EMPTY);
+			std::vector<bool> mines;
+			if (!checkGame(game, before, mines, 0, false) || !checkReference(game, reference, 0)) {
+				return false;
+			}
+			int moves = static_cast<int>(std::min<size_t>((size - std::min<size_t>(size, HEADER)) / 3, MAX_MOVES));
+			for (int step = 1; step <= moves; step++) {
+				const uint8_t* move = data + HEADER + 3 * (step - 1);
+				// one square either side of the board, so some moves miss it
+				Point location(move[1] % (options.width + 2) - 1, move[2] % (options.height + 2) - 1);
+				bool onBoard = game.getBoard().contains(location);
+				int kind = move[0] % 8;
+				if (kind == 6) {
+					if (!history.empty()) {
+						expect(game.restore(history.back().first), step, "undo restores the game");
+						reference = history.back().second;
+						history.pop_back();
+					}
+					if (game.isFirstMove()) {
+						mines.clear(); // undone to before the mines were placed
+					}
+				}
+				else if (kind == 7) {
+					if (!checkSave(game, step)) {
+						return false;
+					}
+					continue;
+				}
+				else {
+					GameState state = game.getState();
+					bool first = game.isFirstMove();
+					history.emplace_back(game.snapshot(), reference);
+					ActionResult result, expected;
+					if (kind < 3) {
+						result = game.clickSpace(location);
+						if (first && !game.isFirstMove()) {
+							std::vector<bool> placed(static_cast<size_t>(cells));
+							for (int cell = 0; cell < cells; cell++) {
+								SpaceType type = game.getBoard().getType(cell);
+								placed[static_cast<size_t>(cell)] = type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE || type == SpaceType::EXPLODED_MINE;
+							}
+							reference.setMines(placed); // the reference plays the mines the game placed
+						}
+						expected = reference.clickSpace(location);
+						expect(!first || result == ActionResult::INVALID || result == ActionResult::OK, step, "the first click never explodes");
+					}
+					else if (kind < 5) {
+						result = game.flagSpace(location);
+						expected = reference.flagSpace(location);
+						expect(!first || result == ActionResult::INVALID, step, "no flags before the first click");
+					}
+					else {
+						result = game.chordSpace(location);
+						expected = reference.chordSpace(location);
+					}
+					expect(result == expected, step, "the move gives the reference game's result");
+					expect(onBoard || result == ActionResult::INVALID, step, "a move off the board is INVALID");
+					expect(state == GameState::PLAYING || result == ActionResult::INVALID, step, "a move after the end is INVALID");
+					expect((result == ActionResult::EXPLODED) == (state == GameState::PLAYING && game.getState() == GameState::LOSS), step, "EXPLODED is the move that loses");
+					if (result != ActionResult::OK && result != ActionResult::EXPLODED) {
+						history.pop_back(); // nothing changed, so there is nothing to undo
+					}
+				}
+				if (!failure.empty() || !checkGame(game, before, mines, step, kind != 6) || !checkReference(game, reference, step)) {
+					return false;
+				}
+				Board& board = game.getBoard();
+				if (!onBoard) {
+					bool threw = false;
+					try {
+						board.getSpaceAt(location);
+					}
+					catch (const std::out_of_range&) {
+						threw = true;
+					}
+					if (!expect(threw && board.getType(location) == SpaceType::INVALID, step, "a square off the board is out of range")) {
+						return false;
+					}
+				}
+			}
+			return checkSave(game, moves + 1);
+		}
+		catch (const std::exception& error) {
+			failure = std::string("threw ") + error.what();
+			return false;
+		}
+	}
+
+	/* Function Name: checkGame()
+	 *
+	 * Function Description:
+	 * This function checks the rules that hold for any game after any step: the mines are all there and
+	 * never move, every number matches its neighbours, the kept counts and the state match the squares,
+	 * and no square changed in a way a move cannot change it
+	 *
+	 * Parameters:
+	 * The game parameter is the game to check
+	 * The before parameter is the squares after the last step, updated to the squares now
+	 * The mines parameter is where the mines are, filled in once they are placed
+	 * The step parameter is the step, for the failure message
+	 * The moved parameter is false after an undo, which may change squares any way back
+	 *
+	 * return value:
+	 * true if every check passed
+	 */
+	bool Fuzzer::checkGame(Game& game, std::vector<SpaceType>& before, std::vector<bool>& mines, int step, bool moved) {
+		Board& board = game.getBoard();
+		GameOptions options = game.getOptions();
+		int cells = options.width * options.height;
+		int counts[7] = {};
+		int result[8];
+		int (*policy)(int x, int y, int width, int height, int* result) =
+			options.topology == Topology::TORUS ? &TopologyPolicy<Topology::TORUS>::neighbours :
+			options.topology == Topology::HEX ? &TopologyPolicy<Topology::HEX>::neighbours :
+			options.topology == Topology::KNIGHT ? &TopologyPolicy<Topology::KNIGHT>::neighbours : &TopologyPolicy<Topology::SQUARE>::neighbours;
+		// which squares each type may turn into with one move, as bits of SpaceType
+		static const int allowed[6] = {
+			1 << 0,                              // REVEALED stays revealed
+			1 << 0 | 1 << 1 | 1 << 2 | 1 << 5,   // EMPTY is revealed or flagged, or the first click puts a mine there
+			1 << 2 | 1 << 3 | 1 << 4,            // MINE explodes or is flagged
+			1 << 3,                              // EXPLODED_MINE stays
+			1 << 4 | 1 << 2,                     // FLAGGED_MINE stays or is taken back
+			1 << 5 | 1 << 1 | 1 << 0             // FALSE_FLAG is taken back, or shown when the game is lost
+		};
+		bool placed = !game.isFirstMove();
+		bool record = placed && mines.empty();
+		if (record) {
+			mines.assign(static_cast<size_t>(cells), false);
+		}
+		for (int cell = 0; cell < cells; cell++) {
+			int x = cell % options.width, y = cell / options.width;
+			SpaceType type = board.getType(cell);
+			if (type >= SpaceType::INVALID) {
+				return expect(false, step, "square " + std::to_string(cell) + " has a valid type");
+			}
+			counts[static_cast<int>(type)]++;
+			bool mine = type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE || type == SpaceType::EXPLODED_MINE;
+			if (record) {
+				mines[static_cast<size_t>(cell)] = mine;
+			}
+			else if (placed && mines[static_cast<size_t>(cell)] != mine) {
+				return expect(false, step, "the mine at square " + std::to_string(cell) + " stays put");
+			}
+			SpaceType last = before[static_cast<size_t>(cell)];
+			if (moved && (allowed[static_cast<int>(last)] >> static_cast<int>(type) & 1) == 0) {
+				return expect(false, step, "square " + std::to_string(cell) + " went from " + std::to_string(static_cast<int>(last)) + " to " + std::to_string(static_cast<int>(type)));
+			}
+			before[static_cast<size_t>(cell)] = type;
+			int count = 0, found = policy(x, y, options.width, options.height, result);
+			for (int index = 0; index < found; index++) {
+				SpaceType other = board.getType(result[index]);
+				count += other == SpaceType::MINE || other == SpaceType::FLAGGED_MINE;
+			}
+			if (board.getSpaceAt(x, y).getAdjacentMines() != count) {
+				return expect(false, step, "the number at square " + std::to_string(cell) + " counts its neighbours");
+			}
+		}
+		int mineCount = counts[static_cast<int>(SpaceType::MINE)] + counts[static_cast<int>(SpaceType::FLAGGED_MINE)] + counts[static_cast<int>(SpaceType::EXPLODED_MINE)];
+		int exploded = counts[static_cast<int>(SpaceType::EXPLODED_MINE)];
+		GameState state = exploded > 0 ? GameState::LOSS : counts[static_cast<int>(SpaceType::FLAGGED_MINE)] == options.mines ? GameState::WIN : GameState::PLAYING;
+		return expect(mineCount == (placed ? options.mines : 0), step, "there are " + std::to_string(mineCount) + " mines")
+			&& expect(game.getState() == state, step, "the state matches the squares")
+			&& expect(exploded == 0 || exploded + counts[static_cast<int>(SpaceType::FLAGGED_MINE)] == options.mines, step, "a loss shows every mine")
+			&& expect(board.getUsedFlags() == counts[static_cast<int>(SpaceType::FLAGGED_MINE)] + counts[static_cast<int>(SpaceType::FALSE_FLAG)], step, "the flag count matches the squares");
+	}
+
+	/* Function Name: checkSave()
+	 *
+	 * Function Description:
+	 * This function writes the game in the binary format, reads it back and compares the two
+	 *
+	 * Parameters:
+	 * The game parameter is the game to save
+	 * The step parameter is the step, for the failure message
+	 *
+	 * return value:
+	 * true if the loaded game matches
+	 */
+	bool Fuzzer::checkSave(Game& game, int step) {
+		std::stringstream stream;
+		GameSerializer::write(game, stream, BoardFormat::BINARY);
+		GameLoop loop(Render::RenderType::HEADLESS);
+		std::unique_ptr<Game> loaded;
+		if (!expect(GameSerializer::read(stream, loop, loaded), step, "a saved game loads")) {
+			return false;
+		}
+		GameOptions options = game.getOptions();
+		bool same = loaded->getOptions().width == options.width && loaded->getOptions().height == options.height && loaded->getOptions().mines == options.mines
+			&& loaded->getOptions().topology == options.topology && loaded->isFirstMove() == game.isFirstMove();
+		for (int cell = 0; same && cell < options.width * options.height; cell++) {
+			same = loaded->getBoard().getType(cell) == game.getBoard().getType(cell);
+		}
+		return expect(same, step, "a loaded game matches the saved one")
+			&& expect(loaded->getState() == game.getState() && loaded->getBoard().getUsedFlags() == game.getBoard().getUsedFlags(), step, "a loaded game counts the same flags");
+	}
+
+	/* Function Name: checkReference()
+	 *
+	 * Function Description:
+	 * This function compares the game with the reference game playing the same moves: the state, the first move,
+	 * the flags, and every square and the number on it
+	 *
+	 * Parameters:
+	 * The game parameter is the game
+	 * The reference parameter is the reference game
+	 * The step parameter is the step, for the failure message
+	 *
+	 * return value:
+	 * true if they match
+	 */
+	bool Fuzzer::checkReference(Game& game, ReferenceGame& reference, int step) {
+		if (!expect(game.getState() == reference.getState(), step, "the state matches the reference game")
+			|| !expect(game.isFirstMove() == reference.isFirstMove(), step, "the mines are placed when the reference game places them")
+			|| !expect(game.getBoard().getUsedFlags() == reference.getUsedFlags(), step, "the flags match the reference game")) {
+			return false;
+		}
+		GameOptions options = game.getOptions();
+		Board& board = game.getBoard();
+		for (int cell = 0; cell < options.width * options.height; cell++) {
+			if (board.getType(cell) != reference.getType(cell)) {
+				return expect(false, step, "square " + std::to_string(cell) + " matches the reference game");
+			}
+			if (board.getSpaceAt(cell % options.width, cell / options.width).getAdjacentMines() != reference.getAdjacentMines(cell)) {
+				return expect(false, step, "the number at square " + std::to_string(cell) + " matches the reference game");
+			}
+		}
+		return true;
+	}
+
+	// expect(): records the first check that failed
+	bool Fuzzer::expect(bool condition, int step, const std::string& what) {
+		if (!condition && failure.empty()) {
+			failure = "step " + std::to_string(step) + ": " + what;
+		}
+		return condition;
+	}
+
+	std::string Fuzzer::getFailure() {
+		return failure;
+	}
+
+	/* Function Name: generate()
+	 *
+	 * Function Description:
+	 * This function makes a random input. Boards are kept small and moves mostly land on the board,
+	 * so most inputs play a game to its end
+	 *
+	 * Parameters:
+	 * The random parameter is the generator to draw from
+	 *
+	 * return value:
+	 * the input
+	 */
+	std::vector<uint8_t> Fuzzer::generate(std::mt19937_64& random) {
+		std::vector<uint8_t> input(static_cast<size_t>(HEADER + 3 * (1 + random() % MAX_MOVES)));
+		for (uint8_t& byte : input) {
+			byte = static_cast<uint8_t>(random());
+		}
+		input[0] = static_cast<uint8_t>(random() % 24);
+		input[1] = static_cast<uint8_t>(random() % 16);
+		input[2] = static_cast<uint8_t>(random() % (1 + (input[0] + 1) * (input[1] + 1) / 3));
+		return input;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: ReferenceGame
+	/////////////////////////////////////////////
+
+	ReferenceGame::ReferenceGame(GameOptions options) : options(options),
+		squares(static_cast<size_t>(options.width) * options.height, SpaceType::EMPTY), firstMove(true) {
+		switch (options.topology) {
+		case Topology::TORUS:
+			policy = &TopologyPolicy<Topology::TORUS>::neighbours;
+			break;
+		case Topology::HEX:
+			policy = &TopologyPolicy<Topology::HEX>::neighbours;
+			break;
+		case Topology::KNIGHT:
+			policy = &TopologyPolicy<Topology::KNIGHT>::neighbours;
+			break;
+		default:
+			policy = &TopologyPolicy<Topology::SQUARE>::neighbours;
+		}
+	}
+
+	// neighbours(): the neighbours of a square straight from the policy, at most 8
+	int ReferenceGame::neighbours(int cell, int* result) {
+		return policy(cell % options.width, cell / options.width, options.width, options.height, result);
+	}
+
+	// setMines(): puts a mine on every square marked true, before the first click
+	void ReferenceGame::setMines(std::vector<bool> mines) {
+		for (size_t cell = 0; cell < squares.size(); cell++) {
+			squares[cell] = mines[cell] ? SpaceType::MINE : SpaceType::EMPTY;
+		}
+	}
+
+	/* Function Name: clickSpace()
+	 *
+	 * Function Description:
+	 * This reveals a square: a mine loses the game, a hidden square opens along with every square
+	 * the flood fill reaches through squares with no mines around them
+	 *
+	 * Parameters:
+	 * The location parameter is the square
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	ActionResult ReferenceGame::clickSpace(Point location) {
+		if (location.x < 0 || location.y < 0 || location.x >= options.width || location.y >= options.height || getState() != GameState::PLAYING) {
+			return ActionResult::INVALID;
+		}
+		firstMove = false;
+		int cell = location.y * options.width + location.x;
+		if (squares[static_cast<size_t>(cell)] == SpaceType::MINE) {
+			explode();
+			return ActionResult::EXPLODED;
+		}
+		if (squares[static_cast<size_t>(cell)] != SpaceType::EMPTY) {
+			return ActionResult::ALREADY_REVEALED;
+		}
+		reveal({ cell });
+		return ActionResult::OK;
+	}
+
+	/* Function Name: flagSpace()
+	 *
+	 * Function Description:
+	 * This puts a flag on a hidden square, or takes one off
+	 *
+	 * Parameters:
+	 * The location parameter is the square
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	ActionResult ReferenceGame::flagSpace(Point location) {
+		if (firstMove || location.x < 0 || location.y < 0 || location.x >= options.width || location.y >= options.height || getState() != GameState::PLAYING) {
+			return ActionResult::INVALID;
+		}
+		SpaceType& square = squares[static_cast<size_t>(location.y * options.width + location.x)];
+		switch (square) {
+		case SpaceType::MINE: square = SpaceType::FLAGGED_MINE; return ActionResult::OK;
+		case SpaceType::EMPTY: square = SpaceType::FALSE_FLAG; return ActionResult::OK;
+		case SpaceType::FLAGGED_MINE: square = SpaceType::MINE; return ActionResult::OK;
+		case SpaceType::FALSE_FLAG: square = SpaceType::EMPTY; return ActionResult::OK;
+		default: return ActionResult::NOT_HIDDEN;
+		}
+	}
+
+	/* Function Name: chordSpace()
+	 *
+	 * Function Description:
+	 * This reveals every hidden neighbour of a number once as many of its neighbours are flagged
+	 *
+	 * Parameters:
+	 * The location parameter is the square
+	 *
+	 * return value:
+	 * ActionResult
+	 */
+	ActionResult ReferenceGame::chordSpace(Point location) {
+		if (location.x < 0 || location.y < 0 || location.x >= options.width || location.y >= options.height || getState() != GameState::PLAYING) {
+			return ActionResult::INVALID;
+		}
+		int cell = location.y * options.width + location.x;
+		if (squares[static_cast<size_t>(cell)] != SpaceType::REVEALED) {
+			return ActionResult::NOT_REVEALED;
+		}
+		int result[8], flags = 0;
+		bool mine = false;
+		std::vector<int> hidden;
+		for (int index = 0, count = neighbours(cell, result); index < count; index++) {
+			SpaceType type = squares[static_cast<size_t>(result[index])];
+			flags += type == SpaceType::FLAGGED_MINE || type == SpaceType::FALSE_FLAG;
+			mine |= type == SpaceType::MINE;
+			if (type == SpaceType::MINE || type == SpaceType::EMPTY) {
+				hidden.push_back(result[index]);
+			}
+		}
+		if (flags != getAdjacentMines(cell)) {
+			return ActionResult::NOT_SATISFIED;
+		}
+		if (hidden.empty()) {
+			return ActionResult::ALREADY_REVEALED;
+		}
+		if (mine) {
+			explode();
+			return ActionResult::EXPLODED;
+		}
+		reveal(hidden);
+		return ActionResult::OK;
+	}
+
+	// explode(): a lost game shows every mine and every square that is not one
+	void ReferenceGame::explode() {
+		for (SpaceType& square : squares) {
+			if (square == SpaceType::MINE) {
+				square = SpaceType::EXPLODED_MINE;
+			}
+			else if (square == SpaceType::EMPTY || square == SpaceType::FALSE_FLAG) {
+				square = SpaceType::REVEALED;
+			}
+		}
+	}
+
+	// reveal(): the flood fill, which stops at numbers and never opens a flag
+	void ReferenceGame::reveal(std::vector<int> seeds) {
+		std::deque<int> pending(seeds.begin(), seeds.end());
+		int result[8];
+		while (!pending.empty()) {
+			int cell = pending.front();
+			pending.pop_front();
+			if (squares[static_cast<size_t>(cell)] != SpaceType::EMPTY) {
+				continue;
+			}
+			squares[static_cast<size_t>(cell)] = SpaceType::REVEALED;
+			if (getAdjacentMines(cell) == 0) {
+				for (int index = 0, count = neighbours(cell, result); index < count; index++) {
+					pending.push_back(result[index]);
+				}
+			}
+		}
+	}
+
+	GameState ReferenceGame::getState() {
+		int flagged = 0;
+		for (SpaceType square : squares) {
+			if (square == SpaceType::EXPLODED_MINE) {
+				return GameState::LOSS;
+			}
+			flagged += square == SpaceType::FLAGGED_MINE;
+		}
+		return flagged == options.mines ? GameState::WIN : GameState::PLAYING;
+	}
+
+	SpaceType ReferenceGame::getType(int cell) {
+		return squares[static_cast<size_t>(cell)];
+	}
+
+	int ReferenceGame::getAdjacentMines(int cell) {
+		int result[8], mines = 0;
+		for (int index = 0, count = neighbours(cell, result); index < count; index++) {
+			SpaceType type = squares[static_cast<size_t>(result[index])];
+			mines += type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE;
+		}
+		return mines;
+	}
+
+	int ReferenceGame::getUsedFlags() {
+		return static_cast<int>(std::count_if(squares.begin(), squares.end(),
+			[](SpaceType square) { return square == SpaceType::FLAGGED_MINE || square == SpaceType::FALSE_FLAG; }));
+	}
+
+	bool ReferenceGame::isFirstMove() {
+		return firstMove;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Differential
+	/////////////////////////////////////////////
+
+	DiffAction::DiffAction(char kind, Point location) : kind(kind), location(location) {}
+
+	Differential::Differential(GameOptions options) : options(options), step(0) {}
+
+	/* Function Name: replay()
+	 *
+	 * Function Description:
+	 * This function plays the moves on a new Game and a new ReferenceGame and stops at the first difference.
+	 * The mines of the reference are copied from the game once its first click has placed them, and undo
+	 * goes back to the last move that changed the board, as it does in the console
+	 *
+	 * Parameters:
+	 * The actions parameter is the moves
+	 * The loop parameter is the loop the game reports to
+	 * The arena parameter is where the game's storage comes from, reset before it returns
+	 *
+	 * return value:
+	 * true if the two agreed on every move, otherwise getDivergence() and getStep() say where they did not
+	 */
+	bool Differential::replay(std::vector<DiffAction>& actions, GameLoop& loop, GameArena* arena) {
+		bool agreed = true;
+		divergence.clear();
+		step = 0;
+		shown.assign(static_cast<size_t>(options.width) * options.height, SpaceType::EMPTY);
+		{
+			Game game(loop, options, arena);
+			ReferenceGame reference(options);
+			std::vector<std::pair<GameSnapshot, ReferenceGame>> history;
+			int cells = options.width * options.height;
+			for (DiffAction& action : actions) {
+				step++;
+				if (action.kind == 'u') {
+					if (!history.empty()) {
+						game.restore(history.back().first);
+						reference = history.back().second;
+						history.pop_back();
+					}
+					if (!compare(game, reference, ActionResult::OK, ActionResult::OK)) {
+						agreed = false;
+						break;
+					}
+					continue;
+				}
+				history.emplace_back(game.snapshot(), reference);
+				ActionResult result, expected;
+				if (action.kind == 'c') {
+					bool first = game.isFirstMove();
+					result = game.clickSpace(action.location);
+					if (first && !game.isFirstMove()) {
+						std::vector<bool> mines(static_cast<size_t>(cells));
+						for (int cell = 0; cell < cells; cell++) {
+							SpaceType type = game.getBoard().getType(cell);
+							mines[static_cast<size_t>(cell)] = type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE || type == SpaceType::EXPLODED_MINE;
+						}
+						reference.setMines(mines);
+					}
+					expected = reference.clickSpace(action.location);
+				}
+				else if (action.kind == 'f') {
+					result = game.flagSpace(action.location);
+					expected = reference.flagSpace(action.location);
+				}
+				else {
+					result = game.chordSpace(action.location);
+					expected = reference.chordSpace(action.location);
+				}
+				if (result != ActionResult::OK && result != ActionResult::EXPLODED) {
+					history.pop_back();
+				}
+				if (!compare(game, reference, result, expected)) {
+					agreed = false;
+					break;
+				}
+			}
+		}
+		if (arena) {
+			arena->reset();
+		}
+		return agreed;
+	}
+
+	/* Function Name: compare()
+	 *
+	 * Function Description:
+	 * This function compares the game with the reference after a move: the result, the state,
+	 * the flags, every square and the number on every square revealed since the last compare
+	 *
+	 * Parameters:
+	 * The game and reference parameters are the two games
+	 * The result and expected parameters are what the move returned in each
+	 *
+	 * return value:
+	 * true if they match, otherwise the difference is kept in divergence
+	 */
+	bool Differential::compare(Game& game, ReferenceGame& reference, ActionResult result, ActionResult expected) {
+		static const char* const TYPE_NAMES[] = { "REVEALED", "EMPTY", "MINE", "EXPLODED_MINE", "FLAGGED_MINE", "FALSE_FLAG", "INVALID" };
+		static const char* const RESULT_NAMES[] = { "OK", "INVALID", "NO_FLAGS", "EXPLODED", "ALREADY_REVEALED", "NOT_HIDDEN", "NOT_REVEALED", "NOT_SATISFIED" };
+		static const char* const STATE_NAMES[] = { "PLAYING", "WIN", "LOSS" };
+		if (result != expected) {
+			divergence = std::string("the move returned ") + RESULT_NAMES[static_cast<int>(result)] + " instead of " + RESULT_NAMES[static_cast<int>(expected)];
+			return false;
+		}
+		if (game.getState() != reference.getState()) {
+			divergence = std::string("the game is ") + STATE_NAMES[static_cast<int>(game.getState())] + " instead of " + STATE_NAMES[static_cast<int>(reference.getState())];
+			return false;
+		}
+		if (game.isFirstMove() != reference.isFirstMove()) {
+			divergence = game.isFirstMove() ? "the mines are not placed" : "the mines are placed too early";
+			return false;
+		}
+		Board& board = game.getBoard();
+		if (board.getUsedFlags() != reference.getUsedFlags()) {
+			divergence = std::to_string(board.getUsedFlags()) + " flags are used instead of " + std::to_string(reference.getUsedFlags());
+			return false;
+		}
+		for (int cell = 0; cell < options.width * options.height; cell++) {
+			SpaceType type = board.getType(cell), expectedType = reference.getType(cell);
+			bool check = type == SpaceType::REVEALED && shown[static_cast<size_t>(cell)] != SpaceType::REVEALED;
+			int mines = check ? Space(board, Point(cell % options.width, cell / options.width)).getAdjacentMines() : 0;
+			shown[static_cast<size_t>(cell)] = type;
+			if (type == expectedType && (!check || mines == reference.getAdjacentMines(cell))) {
+				continue;
+			}
+			divergence = "square (" + std::to_string(cell % options.width) + ", " + std::to_string(cell / options.width) + ")";
+			if (type != expectedType) {
+				divergence += std::string(" is ") + TYPE_NAMES[static_cast<int>(std::min(type, SpaceType::INVALID))] + " instead of " + TYPE_NAMES[static_cast<int>(expectedType)];
+			}
+			else {
+				divergence += " shows " + std::to_string(mines) + " instead of " + std::to_string(reference.getAdjacentMines(cell));
+			}
+			return false;
+		}
+		return true;
+	}
+
+	/* Function Name: shrink()
+	 *
+	 * Function Description:
+	 * This function cuts a list of moves that makes the two games differ down to one where every move is needed:
+	 * the moves after the difference are dropped, then ever smaller runs of moves are taken out for as long as
+	 * the games still differ without them
+	 *
+	 * Parameters:
+	 * The actions parameter is the moves, which must make the games differ
+	 * The loop and arena parameters are as for replay()
+	 *
+	 * return value:
+	 * the shortest list found, replayed last so getDivergence() describes it
+	 */
+	std::vector<DiffAction> Differential::shrink(std::vector<DiffAction> actions, GameLoop& loop, GameArena* arena) {
+		if (replay(actions, loop, arena)) {
+			return actions;
+		}
+		actions.erase(actions.begin() + step, actions.end());
+		for (size_t run = actions.size() / 2; run > 0; run /= 2) {
+			for (size_t first = 0; first < actions.size() && actions.size() > 1;) {
+				std::vector<DiffAction> fewer(actions.begin(), actions.begin() + static_cast<std::ptrdiff_t>(first));
+				fewer.insert(fewer.end(), actions.begin() + static_cast<std::ptrdiff_t>(std::min(actions.size(), first + run)), actions.end());
+				if (!replay(fewer, loop, arena)) {
+					fewer.erase(fewer.begin() + step, fewer.end());
+					actions = fewer;
+					continue; // the same place now holds the next moves
+				}
+				first += run;
+			}
+		}
+		replay(actions, loop, arena);
+		return actions;
+	}
+
+	std::string Differential::getDivergence() {
+		return divergence;
+	}
+
+	int Differential::getStep() {
+		return step;
+	}
+
+	/* Function Name: generate()
+	 *
+	 * Function Description:
+	 * This function makes the moves for a run from the seed in the options. Most are clicks,
+	 * and about one in ten is an undo so games go on after a mine
+	 *
+	 * Parameters:
+	 * The options parameter is the board, its seed also seeds the moves
+	 * The count parameter is the number of moves
+	 *
+	 * return value:
+	 * the moves
+	 */
+	std::vector<DiffAction> Differential::generate(GameOptions options, int count) {
+		std::mt19937_64 random(options.seed ^ 0x9e3779b97f4a7c15ULL); // not the placer's sequence
+		std::vector<DiffAction> actions;
+		actions.reserve(static_cast<size_t>(count));
+		for (int index = 0; index < count; index++) {
+			int roll = static_cast<int>(random() % 20);
+			char kind = roll < 10 ? 'c' : roll < 14 ? 'f' : roll < 18 ? 'h' : 'u';
+			actions.emplace_back(kind, Point(static_cast<int>(random() % static_cast<uint64_t>(options.width)), static_cast<int>(random() % static_cast<uint64_t>(options.height))));
+		}
+		return actions;
+	}
+
+	/* Function Name: write()
+	 *
+	 * Function Description:
+	 * This function writes a reproducer: a line with the board, then one line per move, e.g.
+	 * diff 16 16 40 Square 1234 followed by c 3 4, f 5 6, h 3 4 and u
+	 *
+	 * Parameters:
+	 * The options parameter is the board
+	 * The actions parameter is the moves
+	 * The out parameter is the stream to write to
+	 *
+	 * return value:
+	 * none
+	 */
+	void Differential::write(GameOptions options, std::vector<DiffAction>& actions, std::ostream& out) {
+		out << "diff " << options.width << " " << options.height << " " << options.mines << " " << topologyName(options.topology) << " " << options.seed << "\n";
+		for (DiffAction& action : actions) {
+			out << action.kind;
+			if (action.kind != 'u') {
+				out << " " << action.location.x << " " << action.location.y;
+			}
+			out << "\n";
+		}
+	}
+
+	// read(): reads a reproducer written by write(), false if it is not one
+	bool Differential::read(std::istream& in, GameOptions& options, std::vector<DiffAction>& actions) {
+		std::string magic, topology;
+		if (!(in >> magic >> options.width >> options.height >> options.mines >> topology >> options.seed) || magic != "diff"
+			|| !parseTopology(topology, options.topology) || options.width < 1 || options.height < 1 || options.mines < 1
+			|| options.mines >= options.width * options.height || options.seed == 0) {
+			return false;
+		}
+		options.minePlacerType = static_cast<int64_t>(options.width) * options.height >= 1 << 20 ? MinePlacerType::PARALLEL_RANDOM : MinePlacerType::RANDOM;
+		actions.clear();
+		for (std::string kind; in >> kind;) {
+			Point location(0, 0);
+			if (kind.size() != 1 || std::string("cfhu").find(kind[0]) == std::string::npos || (kind[0] != 'u' && !(in >> location.x >> location.y))) {
+				return false;
+			}
+			actions.emplace_back(kind[0], location);
+		}
+		return true;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: DifficultyRater
+	/////////////////////////////////////////////
+
+	DifficultyProfile::DifficultyProfile() : threeBV(0), openings(0), forcedGuesses(0), ruleDepth(0) {}
+
+	OpeningIndex::OpeningIndex(GameArena* arena) : labels(ArenaAllocator<int>(arena)), starts(ArenaAllocator<int>(arena)),
+		edges(ArenaAllocator<int>(arena)), members(ArenaAllocator<int>(arena)), openings(0) {}
+
+	DisjointSets::DisjointSets(int count, GameArena* arena) : parent(static_cast<size_t>(count), 0, ArenaAllocator<int>(arena)), size(static_cast<size_t>(count), 1, ArenaAllocator<int>(arena)) {
+		for (int item = 0; item < count; item++) {
+			parent[static_cast<size_t>(item)] = item;
+		}
+	}
+
+	/* Function Name: find()
+	 *
+	 * Function Description:
+	 * This function returns the representative of an item's set, halving the path on the way up
+	 *
+	 * Parameters:
+	 * The item parameter is the item to look up
+	 *
+	 * return value:
+	 * the representative item
+	 */
+	int DisjointSets::find(int item) {
+		while (parent[static_cast<size_t>(item)] != item) {
+			parent[static_cast<size_t>(item)] = parent[static_cast<size_t>(parent[static_cast<size_t>(item)])];
+			item = parent[static_cast<size_t>(item)];
+		}
+		return item;
+	}
+
+	/* Function Name: join()
+	 *
+	 * Function Description:
+	 * This function merges the sets of two items, hanging the smaller set under the larger one
+	 *
+	 * Parameters:
+	 * The a parameter is the first item
+	 * The b parameter is the second item
+	 *
+	 * return value:
+	 * true if the items were in different sets
+	 */
+	bool DisjointSets::join(int a, int b) {
+		a = find(a);
+		b = find(b);
+		if (a == b) {
+			return false;
+		}
+		if (size[static_cast<size_t>(a)] < size[static_cast<size_t>(b)]) {
+			std::swap(a, b);
+		}
+		parent[static_cast<size_t>(b)] = a;
+		size[static_cast<size_t>(a)] += size[static_cast<size_t>(b)];
+		return true;
+	}
+
+	DifficultyRater::DifficultyRater(int width, int height, Topology topology, ArenaVector<char> mines) : width(width), height(height), topology(topology), mines(std::move(mines)) {}
+
+	/* Function Name: fromBoard()
+	 *
+	 * Function Description:
+	 * This function builds a rater from the mines currently on a board
+	 *
+	 * Parameters:
+	 * The board parameter is the board to read
+	 *
+	 * return value:
+	 * the rater for that layout
+	 */
+	DifficultyRater DifficultyRater::fromBoard(Board& board) {
+		GameOptions options = board.getOptions();
+		ArenaVector<char> mines(static_cast<size_t>(options.width * options.height), 0, ArenaAllocator<char>(board.getArena()));
+		for (int y = 0; y < options.height; y++) {
+			for (int x = 0; x < options.width; x++) {
+				mines[static_cast<size_t>(y * options.width + x)] = board.getType(Point(x, y)) == SpaceType::MINE;
+			}
+		}
+		return DifficultyRater(options.width, options.height, options.topology, std::move(mines));
+	}
+
+	/* Function Name: rate()
+	 *
+	 * Function Description:
+	 * This function measures the layout: 3BV and openings from the zero areas, then forced guesses
+	 * and rule depth by replaying the solver rules from the first click
+	 *
+	 * Parameters:
+	 * The firstClick parameter is where the player starts
+	 *
+	 * return value:
+	 * the measurements
+	 */
+	DifficultyProfile DifficultyRater::rate(Point firstClick) {
+		return visitGrid(width, height, topology, [this, firstClick](const auto& grid) { return rateOn(grid, firstClick, nullptr); });
+	}
+
+	// rate(): the same, also handing back the openings of the layout
+	DifficultyProfile DifficultyRater::rate(Point firstClick, std::shared_ptr<const OpeningIndex>& openings) {
+		return visitGrid(width, height, topology, [this, firstClick, &openings](const auto& grid) { return rateOn(grid, firstClick, &openings); });
+	}
+
+	/* Function Name: rateOn()
+	 *
+	 * Function Description:
+	 * This function does the work of rate() on the grid picked for the board size
+	 *
+	 * Parameters:
+	 * The grid parameter is the shape of the board
+	 * The firstClick parameter is where the player starts
+	 * The openings parameter receives the openings, or is nullptr when they are not wanted
+	 *
+	 * return value:
+	 * the measurements
+	 */
+	template <typename Grid>
+	DifficultyProfile DifficultyRater::rateOn(const Grid& grid, Point firstClick, std::shared_ptr<const OpeningIndex>* openings) {
+		DifficultyProfile profile;
+		const int cells = grid.size;
+		GameArena* arena = mines.get_allocator().arena; // scratch comes from the same place as the layout
+		auto counts = grid.makeCells(static_cast<unsigned char>(0), arena);
+		static const bool multicore = WorkerPool::shared().getThreadCount() > 1;
+		if (multicore && cells >= PARALLEL_CELLS) {
+			// each tile counts the mines around its own squares, reading the halo of squares beyond its edges
+			std::vector<std::function<void()>> tasks;
+			for (int first = 0; first < cells; first += PARALLEL_CELLS) {
+				tasks.push_back([this, &grid, &counts, first, cells] {
+					for (int cell = first; cell < std::min(first + PARALLEL_CELLS, cells); cell++) {
+						unsigned char count = 0;
+						grid.forEachNeighbour(cell, [this, &count](int other) { count += mines[static_cast<size_t>(other)] != 0; });
+						counts[static_cast<size_t>(cell)] = count;
+					}
+				});
+			}
+			WorkerPool::shared().runAll(tasks);
+		}
+		else {
+			for (int cell = 0; cell < cells; cell++) {
+				if (mines[static_cast<size_t>(cell)]) {
+					grid.forEachNeighbour(cell, [&counts](int other) { counts[static_cast<size_t>(other)]++; });
+				}
+			}
+		}
+		auto isZero = [this, &counts](int cell) { return !mines[static_cast<size_t>(cell)] && counts[static_cast<size_t>(cell)] == 0; };
+
+		DisjointSets areas(cells, arena);
+		for (int cell = 0; cell < cells; cell++) {
+			if (isZero(cell)) {
+				grid.forEachNeighbour(cell, [&](int other) { if (isZero(other)) areas.join(cell, other); });
+			}
+		}
+		int safeCells = 0;
+		if (openings != nullptr) {
+			// number the areas, then lay out each one's squares with a counting sort; 3BV and openings fall out of it
+			std::shared_ptr<OpeningIndex> index = std::allocate_shared<OpeningIndex>(ArenaAllocator<OpeningIndex>(arena), arena);
+			ArenaVector<int>& labels = index->labels;
+			labels.assign(static_cast<size_t>(cells), -1);
+			for (int cell = 0; cell < cells; cell++) {
+				if (isZero(cell) && areas.find(cell) == cell) {
+					labels[static_cast<size_t>(cell)] = index->openings++;
+				}
+			}
+			ArenaVector<int> zeros(static_cast<size_t>(index->openings), 0, ArenaAllocator<int>(arena));
+			ArenaVector<int> numbers(static_cast<size_t>(index->openings), 0, ArenaAllocator<int>(arena));
+			auto edgeOf = [&](int cell, int* found) { // the different openings a number touches
+				int count = 0;
+				grid.forEachNeighbour(cell, [&](int other) {
+					int label = labels[static_cast<size_t>(other)];
+					if (label >= 0 && std::find(found, found + count, label) == found + count) {
+						found[count++] = label;
+					}
+				});
+				return count;
+			};
+			int found[8];
+			for (int cell = 0; cell < cells; cell++) {
+				if (isZero(cell)) {
+					labels[static_cast<size_t>(cell)] = labels[static_cast<size_t>(areas.find(cell))];
+					zeros[static_cast<size_t>(labels[static_cast<size_t>(cell)])]++;
+				}
+			}
+			for (int cell = 0; cell < cells; cell++) {
+				if (mines[static_cast<size_t>(cell)]) {
+					continue;
+				}
+				safeCells++;
+				if (isZero(cell)) {
+					continue;
+				}
+				int count = edgeOf(cell, found);
+				profile.threeBV += count == 0;
+				for (int at = 0; at < count; at++) {
+					numbers[static_cast<size_t>(found[at])]++;
+				}
+			}
+			index->starts.assign(static_cast<size_t>(index->openings) + 1, 0);
+			index->edges.assign(static_cast<size_t>(index->openings), 0);
+			for (size_t opening = 0; opening < zeros.size(); opening++) {
+				index->edges[opening] = index->starts[opening] + zeros[opening];
+				index->starts[opening + 1] = index->edges[opening] + numbers[opening];
+				zeros[opening] = index->starts[opening]; // from here on, where the next square of each kind goes
+				numbers[opening] = index->edges[opening];
+			}
+			index->members.resize(static_cast<size_t>(index->starts.back()));
+			for (int cell = 0; cell < cells; cell++) {
+				if (isZero(cell)) {
+					index->members[static_cast<size_t>(zeros[static_cast<size_t>(labels[static_cast<size_t>(cell)])]++)] = cell;
+				}
+				else if (!mines[static_cast<size_t>(cell)]) {
+					int count = edgeOf(cell, found);
+					for (int at = 0; at < count; at++) {
+						index->members[static_cast<size_t>(numbers[static_cast<size_t>(found[at])]++)] = cell;
+					}
+				}
+			}
+			profile.openings = index->openings;
+			*openings = index;
+		}
+		else {
+			for (int cell = 0; cell < cells; cell++) {
+				if (mines[static_cast<size_t>(cell)]) {
+					continue;
+				}
+				safeCells++;
+				if (isZero(cell)) {
+					profile.openings += areas.find(cell) == cell;
+					continue;
+				}
+				bool bordersOpening = false;
+				grid.forEachNeighbour(cell, [&](int other) { bordersOpening |= isZero(other); });
+				profile.threeBV += bordersOpening ? 0 : 1;
+			}
+		}
+		profile.threeBV += profile.openings;
+
+		// replay: 0 unknown, 1 revealed, 2 known mine. Numbers wait on two lists, one for each rule, whenever
+		// a square next to them changes. Safe unknown squares next to the revealed area are kept in a two level
+		// bitmap, so the first of them, the next guess, is found without looking at every square
+		auto state = grid.makeCells(static_cast<unsigned char>(0), arena);
+		auto queued = grid.makeCells(static_cast<unsigned char>(0), arena); // bit 1 on work, bit 2 on pairs, bit 8 done
+		ArenaAllocator<int> scratch(arena);
+		ArenaDeque<int> work(scratch), pairs(scratch), flood(scratch);
+		ArenaVector<uint64_t> edge(static_cast<size_t>(cells + 63) / 64, 0, ArenaAllocator<uint64_t>(arena));
+		ArenaVector<uint64_t> edgeWords((edge.size() + 63) / 64, 0, ArenaAllocator<uint64_t>(arena));
+		int revealed = 0, firstHidden = 0;
+		auto setEdge = [&](int cell, bool on) {
+			uint64_t& word = edge[static_cast<size_t>(cell) >> 6];
+			uint64_t bit = uint64_t(1) << (cell & 63), wordBit = uint64_t(1) << ((cell >> 6) & 63);
+			word = on ? word | bit : word & ~bit;
+			uint64_t& summary = edgeWords[static_cast<size_t>(cell) >> 12];
+			summary = word != 0 ? summary | wordBit : summary & ~wordBit;
+		};
+		auto firstEdge = [&]() {
+			for (size_t index = 0; index < edgeWords.size(); index++) {
+				if (edgeWords[index] != 0) {
+					size_t word = index * 64 + static_cast<size_t>(lowestBit(edgeWords[index]));
+					return static_cast<int>(word * 64 + static_cast<size_t>(lowestBit(edge[word])));
+				}
+			}
+			return -1;
+		};
+		auto enqueue = [&](int cell) {
+			unsigned char& flags = queued[static_cast<size_t>(cell)];
+			if (flags & 8) return; // no unknowns left around it, nothing more to learn from it
+			if (!(flags & 1)) work.push_back(cell);
+			flags |= 1;
+		};
+		auto touch = [&](int cell) { // numbers next to a change are worth another look
+			grid.forEachNeighbour(cell, [&](int other) {
+				if (state[static_cast<size_t>(other)] == 1 && counts[static_cast<size_t>(other)] > 0) {
+					enqueue(other);
+				}
+			});
+		};
+		auto open = [&](int start) {
+			setEdge(start, false);
+			flood.push_back(start);
+			state[static_cast<size_t>(start)] = 1;
+			while (!flood.empty()) {
+				int cell = flood.front();
+				flood.pop_front();
+				revealed++;
+				touch(cell);
+				if (counts[static_cast<size_t>(cell)] > 0) {
+					enqueue(cell);
+					grid.forEachNeighbour(cell, [&](int other) {
+						if (state[static_cast<size_t>(other)] == 0 && !mines[static_cast<size_t>(other)]) {
+							setEdge(other, true);
+						}
+					});
+					continue;
+				}
+				grid.forEachNeighbour(cell, [&](int other) {
+					if (state[static_cast<size_t>(other)] == 0) {
+						state[static_cast<size_t>(other)] = 1;
+						setEdge(other, false);
+						flood.push_back(other);
+					}
+				});
+			}
+		};
+		auto mark = [&](int cell) {
+			state[static_cast<size_t>(cell)] = 2;
+			touch(cell);
+		};
+		// unknown squares around a number and how many mines are still among them
+		auto unknownsOf = [&](int cell, int* result, int& need) {
+			int unknown = 0;
+			need = counts[static_cast<size_t>(cell)];
+			grid.forEachNeighbour(cell, [&](int other) {
+				unsigned char value = state[static_cast<size_t>(other)];
+				if (value == 2) need--;
+				else if (value == 0) result[unknown++] = other;
+			});
+			return unknown;
+		};
+
+		int start = firstClick.y * grid.width + firstClick.x;
+		if (firstClick.x < 0 || firstClick.y < 0 || firstClick.x >= grid.width || firstClick.y >= grid.height || mines[static_cast<size_t>(start)]) {
+			return profile;
+		}
+		// subset rule: the unknowns of a lie inside those of b, so the rest of b holds the difference.
+		// Any such b neighbours the first unknown of a, whatever the topology
+		auto subset = [&](int a, int b) {
+			int unknownA[8], needA, unknownB[8], needB;
+			if (a == b || state[static_cast<size_t>(a)] != 1 || counts[static_cast<size_t>(a)] == 0
+				|| state[static_cast<size_t>(b)] != 1 || counts[static_cast<size_t>(b)] == 0) {
+				return false;
+			}
+			int countA = unknownsOf(a, unknownA, needA);
+			int countB = unknownsOf(b, unknownB, needB);
+			if (countA == 0 || countB <= countA) {
+				return false;
+			}
+			int rest[8], restCount = 0, shared = 0;
+			for (int index = 0; index < countB; index++) {
+				bool inA = std::find(unknownA, unknownA + countA, unknownB[index]) != unknownA + countA;
+				if (inA) shared++;
+				else rest[restCount++] = unknownB[index];
+			}
+			int restNeed = needB - needA;
+			if (shared != countA || (restNeed != 0 && restNeed != restCount)) {
+				return false;
+			}
+			for (int index = 0; index < restCount; index++) {
+				if (state[static_cast<size_t>(rest[index])] != 0) continue; // an earlier opening may have reached it
+				if (restNeed == 0) open(rest[index]);
+				else mark(rest[index]);
+			}
+			return true;
+		};
+
+		open(start);
+		while (revealed < safeCells) {
+			bool progress = false;
+			while (!work.empty()) {
+				int cell = work.front();
+				work.pop_front();
+				queued[static_cast<size_t>(cell)] &= ~1;
+				int unknown[8], need;
+				int unknownCount = unknownsOf(cell, unknown, need);
+				if (unknownCount == 0 || need == 0 || need == unknownCount) {
+					queued[static_cast<size_t>(cell)] |= 8; // after this every square around it is known
+				}
+				if (unknownCount == 0) {
+					continue;
+				}
+				if (need != 0 && need != unknownCount) {
+					if (!(queued[static_cast<size_t>(cell)] & 2)) { // only numbers the first rule left open wait on pairs
+						queued[static_cast<size_t>(cell)] |= 2;
+						pairs.push_back(cell);
+					}
+					continue;
+				}
+				for (int index = 0; index < unknownCount; index++) {
+					if (state[static_cast<size_t>(unknown[index])] != 0) continue;
+					if (need == 0) open(unknown[index]);
+					else mark(unknown[index]);
+				}
+				profile.ruleDepth = std::max(profile.ruleDepth, 1);
+				progress = true;
+			}
+			if (revealed >= safeCells) {
+				break;
+			}
+			// a pair only changes when one of its numbers does, so only the numbers waiting on pairs are tried,
+			// as the smaller side and as the larger. The closure of both rules is the same whatever the order
+			while (!progress && !pairs.empty()) {
+				int x = pairs.front();
+				pairs.pop_front();
+				queued[static_cast<size_t>(x)] &= ~2;
+				int unknown[8], need;
+				if (state[static_cast<size_t>(x)] != 1 || counts[static_cast<size_t>(x)] == 0 || (queued[static_cast<size_t>(x)] & 8)) {
+					continue;
+				}
+				int count = unknownsOf(x, unknown, need);
+				if (count == 0) {
+					queued[static_cast<size_t>(x)] |= 8;
+					continue;
+				}
+				// every number x can pair with, on either side, neighbours one of its unknowns; each is tried once
+				int tried[64], triedCount = 0;
+				for (int index = 0; index < count && !progress; index++) {
+					grid.forEachNeighbour(unknown[index], [&](int other) {
+						if (progress || other == x || state[static_cast<size_t>(other)] != 1 || counts[static_cast<size_t>(other)] == 0
+							|| (queued[static_cast<size_t>(other)] & 8) || std::find(tried, tried + triedCount, other) != tried + triedCount) {
+							return;
+						}
+						tried[triedCount++] = other;
+						progress = subset(x, other) || subset(other, x);
+					});
+				}
+				if (progress) {
+					profile.ruleDepth = 2;
+					if (!(queued[static_cast<size_t>(x)] & 2)) {
+						queued[static_cast<size_t>(x)] |= 2;
+						pairs.push_front(x); // it may pair with another number too
+					}
+				}
+			}
+			if (progress) {
+				continue;
+			}
+			// stuck: a lucky guess opens a safe square, the first one next to the revealed area when there is one
+			int guess = firstEdge();
+			if (guess < 0) {
+				while (state[static_cast<size_t>(firstHidden)] != 0 || mines[static_cast<size_t>(firstHidden)]) {
+					firstHidden++;
+				}
+				guess = firstHidden;
+			}
+			profile.forcedGuesses++;
+			open(guess);
+		}
+		return profile;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Game Serializer
+	/////////////////////////////////////////////
+
+	/* Function Name: write()
+	 *
+	 * Function Description:
+	 * This function writes a game in the chosen format
+	 *
+	 * Parameters:
+	 * The game parameter is the game to write
+	 * The out parameter is the stream to write to
+	 * The format parameter is BINARY, JSON or SAVE
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameSerializer::write(Game& game, std::ostream& out, BoardFormat format) {
+		if (format == BoardFormat::JSON) {
+			writeJson(game, out);
+		}
+		else if (format == BoardFormat::SAVE) {
+			writeSave(game, out);
+		}
+		else {
+			writeBinary(game, out);
+		}
+	}
+
+	/* Function Name: writeHeader()
+	 *
+	 * Function Description:
+	 * This function writes the start of both binary formats: "MSWP", the version byte, then the options,
+	 * seed, first move, elapsed seconds and difficulty, little endian
+	 *
+	 * Parameters:
+	 * The game parameter is the game to write
+	 * The out parameter is the stream to write to
+	 * The version parameter is 1 for BINARY, 2 for SAVE
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameSerializer::writeHeader(Game& game, std::ostream& out, int version) {
+		Board& board = game.getBoard();
+		GameOptions options = board.getOptions();
+		DifficultyProfile difficulty = board.getDifficulty();
+		auto put = [&out](uint64_t value, int bytes) {
+			for (int index = 0; index < bytes; index++) {
+				out.put(static_cast<char>((value >> (index * 8)) & 0xff));
+			}
+		};
+		out.write("MSWP", 4);
+		put(static_cast<uint64_t>(version), 1);
+		put(static_cast<uint32_t>(options.width), 4);
+		put(static_cast<uint32_t>(options.height), 4);
+		put(static_cast<uint32_t>(options.mines), 4);
+		put(static_cast<uint64_t>(options.topology), 1);
+		put(static_cast<uint64_t>(options.minePlacerType), 1);
+		put(options.seed, 8);
+		put(game.isFirstMove() ? 1 : 0, 1);
+		put(static_cast<uint64_t>(currentTimeSeconds() - game.getStartTime()), 8);
+		for (int value : { difficulty.threeBV, difficulty.openings, difficulty.forcedGuesses, difficulty.ruleDepth }) {
+			put(static_cast<uint32_t>(value), 4);
+		}
+	}
+
+	/* Function Name: writeBinary()
+	 *
+	 * Function Description:
+	 * This function writes the binary format: "MSWP", a version byte, a little endian header, then one byte
+	 * per square with the SpaceType in the low four bits and the number in the high four bits
+	 *
+	 * Parameters:
+	 * The game parameter is the game to write
+	 * The out parameter is the stream to write to
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameSerializer::writeBinary(Game& game, std::ostream& out) {
+		Board& board = game.getBoard();
+		GameOptions options = board.getOptions();
+		writeHeader(game, out, 1);
+		for (int y = 0; y < options.height; y++) {
+			for (int x = 0; x < options.width; x++) {
+				Space space = board.getSpaceAt(x, y);
+				out.put(static_cast<char>(static_cast<int>(space.getType()) | space.getAdjacentMines() << 4));
+			}
+		}
+	}
+
+	/* Function Name: writeSave()
+	 *
+	 * Function Description:
+	 * This function writes the save format: the header and the counts of exploded mines, flags and wrong flags
+	 * padded to SAVE_HEADER bytes, then the board's chunks as they are in memory, one byte per square row by row,
+	 * with the last chunk padded. Numbers are not stored, the board works them out from the mines
+	 *
+	 * Parameters:
+	 * The game parameter is the game to write
+	 * The out parameter is the stream to write to
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameSerializer::writeSave(Game& game, std::ostream& out) {
+		if (game.board.overlay) {
+			game.board.materialize(); // the chunks are written as they are
+		}
+		writeHeader(game, out, 2);
+		for (SpaceType type : { SpaceType::EXPLODED_MINE, SpaceType::FLAGGED_MINE, SpaceType::FALSE_FLAG }) {
+			uint32_t count = static_cast<uint32_t>(game.board.countMarked(type));
+			for (int index = 0; index < 4; index++) {
+				out.put(static_cast<char>((count >> (index * 8)) & 0xff));
+			}
+		}
+		for (int written = HEADER_SIZE + MARKS_SIZE; written < SAVE_HEADER; written++) {
+			out.put(0);
+		}
+		for (size_t index = 0; index < game.board.table->chunks.size(); index++) {
+			game.board.check(index);
+			out.write(reinterpret_cast<const char*>(game.board.table->chunks[index]->types), sizeof(Board::Chunk::types));
+		}
+	}
+
+	/* Function Name: writeJson()
+	 *
+	 * Function Description:
+	 * This function writes the JSON format. Squares are written as one string per row, using
+	 * R(evealed), E(mpty), M(ine), X (exploded mine), F(lagged mine) and W (wrong flag), with a
+	 * matching string of numbers per row
+	 *
+	 * Parameters:
+	 * The game parameter is the game to write
+	 * The out parameter is the stream to write to
+	 *
+	 * return value:
+	 * none
+	 */
+	void GameSerializer::writeJson(Game& game, std::ostream& out) {
+		Board& board = game.getBoard();
+		GameOptions options = board.getOptions();
+		DifficultyProfile difficulty = board.getDifficulty();
+		GameState state = game.getState();
+		out << "{\"width\":" << options.width << ",\"height\":" << options.height << ",\"mines\":" << options.mines
+			<< ",\"topology\":\"" << topologyName(options.topology) << "\",\"seed\":\"" << options.seed << "\""
+			<< ",\"firstMove\":" << (game.isFirstMove() ? "true" : "false")
+			<< ",\"elapsed\":" << currentTimeSeconds() - game.getStartTime()
+			<< ",\"state\":\"" << (state == GameState::WIN ? "win" : state == GameState::LOSS ? "loss" : "playing") << "\""
+			<< ",\"difficulty\":{\"threeBV\":" << difficulty.threeBV << ",\"openings\":" << difficulty.openings
+			<< ",\"forcedGuesses\":" << difficulty.forcedGuesses << ",\"ruleDepth\":" << difficulty.ruleDepth << "}";
+		for (int pass = 0; pass < 2; pass++) {
+			out << (pass == 0 ? ",\"cells\":[" : ",\"counts\":[");
+			for (int y = 0; y < options.height; y++) {
+				out.put(y == 0 ? '"' : ',');
+				if (y > 0) out.put('"');
+				for (int x = 0; x < options.width; x++) {
+					Space space = board.getSpaceAt(x, y);
+					out.put(pass == 0 ? TYPE_CODES[static_cast<int>(space.getType())] : static_cast<char>('0' + space.getAdjacentMines()));
+				}
+				out.put('"');
+			}
+			out.put(']');
+		}
+		out << "}\n";
+	}
+
+	/* Function Name: read()
+	 *
+	 * Function Description:
+	 * This function reads a game written by write(), telling the formats apart by the first byte
+	 *
+	 * Parameters:
+	 * The in parameter is the stream to read from
+	 * The loop parameter is the loop the game will belong to
+	 * The game parameter receives the game
+	 *
+	 * return value:
+	 * true if a valid game was read
+	 */
+	bool GameSerializer::read(std::istream& in, GameLoop& loop, std::unique_ptr<Game>& game) {
+		in >> std::ws;
+		if (in.peek() == '{') {
+			return readJson(in, loop, game);
+		}
+		return readBinary(in, loop, game);
+	}
+
+	/* Function Name: readHeader()
+	 *
+	 * Function Description:
+	 * This function reads the header written by writeHeader() and creates the game it describes,
+	 * with every square still hidden. The size is checked against MAX_SQUARES and against what the source
+	 * holds before the game is made, so a damaged header cannot ask for more memory than the file could fill
+	 *
+	 * Parameters:
+	 * The in parameter is the stream to read from
+	 * The length parameter is how many bytes the source holds from the header on, or -1 when that is not known
+	 * The loop parameter is the loop the game will belong to
+	 * The game parameter receives the game
+	 * The version parameter receives the format version
+	 *
+	 * return value:
+	 * true if the header was valid
+	 */
+	bool GameSerializer::readHeader(std::istream& in, int64_t length, GameLoop& loop, std::unique_ptr<Game>& game, int& version) {
+		bool ok = true;
+		auto get = [&in, &ok](int bytes) {
+			uint64_t value = 0;
+			for (int index = 0; index < bytes; index++) {
+				int byte = in.get();
+				ok &= byte != EOF;
+				value |= static_cast<uint64_t>(byte & 0xff) << (index * 8);
+			}
+			return value;
+		};
+		char magic[4] = {};
+		in.read(magic, 4);
+		version = static_cast<int>(get(1));
+		if (!in || std::string(magic, 4) != "MSWP" || (version != 1 && version != 2)) {
+			return false;
+		}
+		GameOptions options;
+		options.width = static_cast<int32_t>(get(4));
+		options.height = static_cast<int32_t>(get(4));
+		options.mines = static_cast<int32_t>(get(4));
+		uint64_t topology = get(1), placer = get(1);
+		options.seed = get(8);
+		bool firstMove = get(1) != 0;
+		int64_t elapsed = static_cast<int64_t>(get(8));
+		DifficultyProfile difficulty;
+		difficulty.threeBV = static_cast<int32_t>(get(4));
+		difficulty.openings = static_cast<int32_t>(get(4));
+		difficulty.forcedGuesses = static_cast<int32_t>(get(4));
+		difficulty.ruleDepth = static_cast<int32_t>(get(4));
+		std::array<int, 3> marks = { { 0, 0, 0 } };
+		for (int& count : marks) {
+			count = version == 2 ? static_cast<int32_t>(get(4)) : 0;
+		}
+		if (!ok || topology > static_cast<uint64_t>(Topology::KNIGHT) || placer > static_cast<uint64_t>(MinePlacerType::PARALLEL_RANDOM)
+			|| options.width < 1 || options.height < 1 || static_cast<long long>(options.width) * options.height > MAX_SQUARES) {
+			return false;
+		}
+		long long squares = static_cast<long long>(options.width) * options.height;
+		long long chunks = (squares + Board::CHUNK_SIZE - 1) / Board::CHUNK_SIZE;
+		if (length >= 0 && length < (version == 2 ? SAVE_HEADER + chunks * Board::CHUNK_SIZE : HEADER_SIZE + squares)) {
+			return false;
+		}
+		options.topology = static_cast<Topology>(topology);
+		options.minePlacerType = static_cast<MinePlacerType>(placer);
+		game.reset(new Game(loop, options));
+		game->firstMove = firstMove;
+		game->startTime = currentTimeSeconds() - elapsed;
+		game->board.setDifficulty(difficulty);
+		if (version == 2) {
+			game->board.marks = marks; // finishChunks() checks them against the squares
+			game->board.counted = true;
+		}
+		return true;
+	}
+
+	bool GameSerializer::readBinary(std::istream& in, GameLoop& loop, std::unique_ptr<Game>& game) {
+		int64_t length = -1; // a pipe cannot tell how much is left
+		std::streampos start = in.tellg();
+		if (start != std::streampos(-1) && in.seekg(0, std::ios::end)) {
+			length = static_cast<int64_t>(in.tellg() - start);
+			in.seekg(start);
+		}
+		in.clear();
+		int version = 0;
+		if (!readHeader(in, length, loop, game, version)) {
+			return false;
+		}
+		GameOptions options = game->board.getOptions();
+		if (version == 2) { // save file read without mapping it: the chunks are copied in whole
+			in.ignore(SAVE_HEADER - HEADER_SIZE - MARKS_SIZE);
+			for (std::shared_ptr<Board::Chunk>& chunk : game->board.table->chunks) {
+				chunk = std::make_shared<Board::Chunk>();
+				if (!in.read(reinterpret_cast<char*>(chunk->types), sizeof(chunk->types))) {
+					return false;
+				}
+			}
+			return finishChunks(*game);
+		}
+		std::vector<unsigned char> counts(static_cast<size_t>(options.width) * options.height);
+		for (size_t index = 0; index < counts.size(); index++) {
+			int byte = in.get();
+			if (byte == EOF || (byte & 0x0f) > static_cast<int>(SpaceType::FALSE_FLAG)) {
+				return false;
+			}
+			int cell = static_cast<int>(index);
+			game->board.setType(Point(cell % options.width, cell / options.width), static_cast<SpaceType>(byte & 0x0f));
+			counts[index] = static_cast<unsigned char>(byte >> 4);
+		}
+		return finish(*game, counts);
+	}
+
+	/* Function Name: save()
+	 *
+	 * Function Description:
+	 * This function saves a game to a file. It writes a temporary file first and renames it over
+	 * the old save, which replaces it in one step, so a crash leaves either the old save or the new one.
+	 * A board load() would refuse is not saved
+	 *
+	 * Parameters:
+	 * The game parameter is the game to save
+	 * The path parameter is the file to write
+	 *
+	 * return value:
+	 * true if the game was saved
+	 */
+	bool GameSerializer::save(Game& game, std::string path) {
+		if (!fits(game.getOptions())) {
+			return false; // it could not be loaded again
+		}
+		std::string temporary = path + ".tmp";
+		{
+			std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+			writeSave(game, out);
+			if (!out.flush()) {
+				std::remove(temporary.c_str());
+				return false;
+			}
+		}
+#ifdef windows
+		if (!MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) { // rename() will not replace a file here
+			std::remove(temporary.c_str());
+			return false;
+		}
+		return true;
+#else
+		if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+			std::remove(temporary.c_str());
+			return false;
+		}
+		return true;
+#endif
+	}
+
+	/* Function Name: load()
+	 *
+	 * Function Description:
+	 * This function loads a file written by save(), or any other format read() accepts.
+	 * Where mmap is available a save file is mapped instead of read: the chunks of the board point into
+	 * the mapping rather than being copied out of the file, and opening it reads only the header.
+	 * The size and the counts in the header are checked here; each chunk is checked as read() would check it
+	 * the first time the board uses it, and a damaged one ends the game then (see Board::checkMapped()).
+	 * The mapping is private, and a chunk is copied the first time it changes, as with snapshots, so the file
+	 * itself never changes
+	 *
+	 * Parameters:
+	 * The path parameter is the file to read
+	 * The loop parameter is the loop the game will belong to
+	 * The game parameter receives the game
+	 *
+	 * return value:
+	 * true if a valid game was loaded
+	 */
+	bool GameSerializer::load(std::string path, GameLoop& loop, std::unique_ptr<Game>& game) {
+#ifdef bash
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat status;
+		if (fstat(fd, &status) != 0 || status.st_size < SAVE_HEADER) {
+			close(fd);
+			std::ifstream in(path, std::ios::binary);
+			return read(in, loop, game);
+		}
+		size_t size = static_cast<size_t>(status.st_size);
+		void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED) {
+			return false;
+		}
+		std::shared_ptr<unsigned char> mapping(static_cast<unsigned char*>(data), [size](unsigned char* pointer) { munmap(pointer, size); });
+		std::istringstream header(std::string(reinterpret_cast<char*>(mapping.get()), SAVE_HEADER));
+		int version = 0;
+		if (header.peek() == 'M' && readHeader(header, static_cast<int64_t>(size), loop, game, version) && version == 2) {
+			std::vector<std::shared_ptr<Board::Chunk>>::size_type chunkCount = game->board.table->chunks.size();
+			std::array<int, 3> marks = game->board.marks;
+			bool marksFit = std::all_of(marks.begin(), marks.end(), [](int count) { return count >= 0; })
+				&& static_cast<long long>(marks[0]) + marks[1] + marks[2] <= static_cast<long long>(chunkCount) * Board::CHUNK_SIZE;
+			if (size != SAVE_HEADER + chunkCount * sizeof(Board::Chunk) || !marksFit) {
+				game.reset();
+				return false;
+			}
+			for (size_t index = 0; index < chunkCount; index++) {
+				// aliasing pointers keep the mapping alive and share its count, so every chunk looks shared
+				Board::Chunk* chunk = reinterpret_cast<Board::Chunk*>(mapping.get() + SAVE_HEADER + index * sizeof(Board::Chunk));
+				game->board.table->chunks[index] = std::shared_ptr<Board::Chunk>(mapping, chunk);
+			}
+			game->board.unchecked.reset(new Board::ChunkCheck(chunkCount, marks, game->firstMove));
+			return true;
+		}
+		game.reset();
+		mapping.reset();
+#endif
+		std::ifstream in(path, std::ios::binary);
+		return in && read(in, loop, game);
+	}
+
+	// fits(): true if the loader takes a board of this shape, so a game is never written that cannot be read back
+	bool GameSerializer::fits(GameOptions options) {
+		return options.width >= 1 && options.height >= 1 && static_cast<long long>(options.width) * options.height <= MAX_SQUARES;
+	}
+
+	inline long long GameSerializer::getMaxSquares() {
+		return MAX_SQUARES;
+	}
+
+	bool GameSerializer::readJson(std::istream& in, GameLoop& loop, std::unique_ptr<Game>& game) {
+		auto expect = [&in](char c) {
+			in >> std::ws;
+			if (in.peek() != c) return false;
+			in.get();
+			return true;
+		};
+		auto readString = [&in, &expect](std::string& value) {
+			value.clear();
+			if (!expect('"')) return false;
+			for (int c = in.get(); c != '"'; c = in.get()) {
+				if (c == EOF || c == '\\') return false; // nothing written by writeJson() needs escaping
+				value += static_cast<char>(c);
+			}
+			return true;
+		};
+		GameOptions options;
+		options.width = options.height = options.mines = -1;
+		options.minePlacerType = MinePlacerType::RANDOM;
+		bool firstMove = true;
+		int64_t elapsed = 0;
+		DifficultyProfile difficulty;
+		std::string key, value, cells, counts;
+		if (!expect('{')) {
+			return false;
+		}
+		do {
+			if (!readString(key) || !expect(':')) {
+				return false;
+			}
+			in >> std::ws;
+			if (key == "cells" || key == "counts") {
+				std::string& target = key == "cells" ? cells : counts;
+				if (!expect('[')) return false;
+				do {
+					if (!readString(value)) return false;
+					target += value;
+					if (static_cast<long long>(target.size()) > MAX_SQUARES) return false;
+				} while (expect(','));
+				if (!expect(']')) return false;
+			}
+			else if (key == "difficulty") {
+				if (!expect('{')) return false;
+				do {
+					int number = 0;
+					if (!readString(value) || !expect(':') || !(in >> number)) return false;
+					if (value == "threeBV") difficulty.threeBV = number;
+					else if (value == "openings") difficulty.openings = number;
+					else if (value == "forcedGuesses") difficulty.forcedGuesses = number;
+					else if (value == "ruleDepth") difficulty.ruleDepth = number;
+				} while (expect(','));
+				if (!expect('}')) return false;
+			}
+			else if (in.peek() == '"') {
+				if (!readString(value)) return false;
+				if (key == "topology" && !parseTopology(value, options.topology)) return false;
+				if (key == "seed") options.seed = strtoull(value.c_str(), nullptr, 10);
+			}
+			else if (in.peek() == 't' || in.peek() == 'f') {
+				std::string word;
+				while (isalpha(in.peek())) word += static_cast<char>(in.get());
+				if (word != "true" && word != "false") return false;
+				if (key == "firstMove") firstMove = word == "true";
+			}
+			else {
+				long long number = 0;
+				if (!(in >> number)) return false;
+				if (key == "width") options.width = static_cast<int>(number);
+				else if (key == "height") options.height = static_cast<int>(number);
+				else if (key == "mines") options.mines = static_cast<int>(number);
+				else if (key == "elapsed") elapsed = number;
+			}
+		} while (expect(','));
+		if (!expect('}') || options.width < 1 || options.height < 1 || options.mines < 0
+			|| static_cast<long long>(options.width) * options.height > MAX_SQUARES
+			|| cells.size() != static_cast<size_t>(options.width) * options.height || counts.size() != cells.size()) {
+			return false;
+		}
+		game.reset(new Game(loop, options));
+		game->firstMove = firstMove;
+		game->startTime = currentTimeSeconds() - elapsed;
+		game->board.setDifficulty(difficulty);
+		std::vector<unsigned char> numbers(cells.size());
+		for (size_t index = 0; index < cells.size(); index++) {
+			const char* code = std::find(TYPE_CODES, TYPE_CODES + 6, cells[index]);
+			if (code == TYPE_CODES + 6 || counts[index] < '0' || counts[index] > '8') {
+				return false;
+			}
+			int cell = static_cast<int>(index);
+			game->board.setType(Point(cell % options.width, cell / options.width), static_cast<SpaceType>(code - TYPE_CODES));
+			numbers[index] = static_cast<unsigned char>(counts[index] - '0');
+		}
+		return finish(*game, numbers);
+	}
+
+	/* Function Name: finish()
+	 *
+	 * Function Description:
+	 * This function checks a loaded game: the numbers must match the mines, and a game past its first
+	 * move must have its mines placed
+	 *
+	 * Parameters:
+	 * The game parameter is the loaded game
+	 * The counts parameter is the numbers that were stored with it
+	 *
+	 * return value:
+	 * true if the game is consistent
+	 */
+	bool GameSerializer::finish(Game& game, std::vector<unsigned char>& counts) {
+		GameOptions options = game.board.getOptions();
+		int mines = 0;
+		for (int y = 0; y < options.height; y++) {
+			for (int x = 0; x < options.width; x++) {
+				Space space = game.board.getSpaceAt(x, y);
+				SpaceType type = space.getType();
+				mines += type == SpaceType::MINE || type == SpaceType::FLAGGED_MINE || type == SpaceType::EXPLODED_MINE;
+				if (space.getAdjacentMines() != counts[static_cast<size_t>(y) * options.width + x]) {
+					return false;
+				}
+			}
+		}
+		return game.firstMove ? mines == 0 : mines > 0;
+	}
+
+	/* Function Name: finishChunks()
+	 *
+	 * Function Description:
+	 * This function checks a game whose chunks came straight from a save file: every square must hold a
+	 * valid state, the marks must add up to the counts in the header, and the mines must agree with the first
+	 * move as finish() checks. A save file stores no numbers, so finish()'s check of the numbers has nothing to compare.
+	 * The board keeps the counts from the header, so it does not count them again
+	 *
+	 * Parameters:
+	 * The game parameter is the loaded game
+	 *
+	 * return value:
+	 * true if the game is consistent
+	 */
+	bool GameSerializer::finishChunks(Game& game) {
+		GameOptions options = game.board.getOptions();
+		size_t squares = static_cast<size_t>(options.width) * options.height;
+		int mines = 0;
+		std::array<int, 3> marks = { { 0, 0, 0 } };
+		for (size_t chunk = 0; chunk < game.board.table->chunks.size(); chunk++) {
+			size_t left = squares - chunk * Board::CHUNK_SIZE;
+			if (!Board::checkChunk(*game.board.table->chunks[chunk], std::min<size_t>(left, Board::CHUNK_SIZE), game.firstMove, marks, mines)) {
+				return false;
+			}
+		}
+		if (marks != game.board.marks) {
+			return false;
+		}
+		return game.firstMove ? mines == 0 : mines > 0;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Layout Codec
+	/////////////////////////////////////////////
+
+	/* Class Name: LayoutCodec::Number
+	 *
+	 * Class Description:
+	 * This Class is an unsigned number of any size in 32 bit limbs, lowest first. It only does what
+	 * numbering layouts needs: adding, subtracting, comparing, and multiplying or dividing by a small number
+	 */
+	class LayoutCodec::Number {
+	public:
+		std::vector<uint32_t> limbs;
+		Number(uint32_t value) : limbs(1, value) {}
+		void multiply(uint32_t factor) {
+			uint64_t carry = 0;
+			for (uint32_t& limb : limbs) {
+				carry += static_cast<uint64_t>(limb) * factor;
+				limb = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+			if (carry != 0) {
+				limbs.push_back(static_cast<uint32_t>(carry));
+			}
+		}
+		void divide(uint32_t divisor) {
+			uint64_t remainder = 0;
+			for (size_t index = limbs.size(); index-- > 0;) {
+				remainder = remainder << 32 | limbs[index];
+				limbs[index] = static_cast<uint32_t>(remainder / divisor);
+				remainder %= divisor;
+			}
+			while (limbs.size() > 1 && limbs.back() == 0) {
+				limbs.pop_back();
+			}
+		}
+		void add(const Number& other) {
+			limbs.resize(std::max(limbs.size(), other.limbs.size()) + 1, 0);
+			uint64_t carry = 0;
+			for (size_t index = 0; index < limbs.size(); index++) {
+				carry += static_cast<uint64_t>(limbs[index]) + (index < other.limbs.size() ? other.limbs[index] : 0);
+				limbs[index] = static_cast<uint32_t>(carry);
+				carry >>= 32;
+			}
+			while (limbs.size() > 1 && limbs.back() == 0) {
+				limbs.pop_back();
+			}
+		}
+		void subtract(const Number& other) { // other is never larger
+			int64_t borrow = 0;
+			for (size_t index = 0; index < limbs.size(); index++) {
+				borrow += static_cast<int64_t>(limbs[index]) - (index < other.limbs.size() ? other.limbs[index] : 0);
+				limbs[index] = static_cast<uint32_t>(borrow);
+				borrow = borrow < 0 ? -1 : 0;
+			}
+			while (limbs.size() > 1 && limbs.back() == 0) {
+				limbs.pop_back();
+			}
+		}
+		bool atLeast(const Number& other) const {
+			if (limbs.size() != other.limbs.size()) {
+				return limbs.size() > other.limbs.size();
+			}
+			for (size_t index = limbs.size(); index-- > 0;) {
+				if (limbs[index] != other.limbs[index]) {
+					return limbs[index] > other.limbs[index];
+				}
+			}
+			return true;
+		}
+		bool isZero() const {
+			return limbs.size() == 1 && limbs[0] == 0;
+		}
+		int bits() const {
+			int count = static_cast<int>(limbs.size() - 1) * 32;
+			for (uint32_t top = limbs.back(); top != 0; top >>= 1) {
+				count++;
+			}
+			return count;
+		}
+	};
+
+	// start(): C(cells - 1, mines), where numbering starts from the last square; needs mines < cells
+	LayoutCodec::Number LayoutCodec::start(int cells, int mines) {
+		Number ways(1);
+		for (int top = mines + 1; top < cells; top++) {
+			ways.multiply(static_cast<uint32_t>(top)); // C(top, mines) = C(top - 1, mines) * top / (top - mines)
+			ways.divide(static_cast<uint32_t>(top - mines));
+		}
+		return ways;
+	}
+
+	/* Class Name: LayoutCodec::Table
+	 *
+	 * Class Description:
+	 * This Class holds C(square, mines) for every square and every number of mines up to a shape's,
+	 * each in the same number of limbs, built by adding up Pascal's triangle
+	 */
+	class LayoutCodec::Table {
+	public:
+		int cells, mines;
+		size_t width; // limbs in each value
+		std::vector<uint32_t> values;
+		Table(int cells, int mines, size_t width) : cells(cells), mines(mines), width(width),
+			values(static_cast<size_t>(cells) * static_cast<size_t>(mines + 1) * width, 0) {
+			for (int square = 0; square < cells; square++) {
+				values[static_cast<size_t>(square) * static_cast<size_t>(mines + 1) * width] = 1; // C(square, 0)
+				for (int chosen = 1; chosen <= std::min(square, mines); chosen++) {
+					uint32_t* value = at(square, chosen);
+					const uint32_t* left = at(square - 1, chosen - 1);
+					const uint32_t* right = at(square - 1, chosen);
+					uint64_t carry = 0;
+					for (size_t limb = 0; limb < width; limb++) {
+						carry += static_cast<uint64_t>(left[limb]) + right[limb];
+						value[limb] = static_cast<uint32_t>(carry);
+						carry >>= 32;
+					}
+				}
+			}
+		}
+		uint32_t* at(int square, int chosen) {
+			return values.data() + (static_cast<size_t>(square) * static_cast<size_t>(mines + 1) + static_cast<size_t>(chosen)) * width;
+		}
+		const uint32_t* at(int square, int chosen) const {
+			return values.data() + (static_cast<size_t>(square) * static_cast<size_t>(mines + 1) + static_cast<size_t>(chosen)) * width;
+		}
+	};
+
+	/* Function Name: table()
+	 *
+	 * Function Description:
+	 * This function gives the shared table for a shape, building it the first time it is asked for
+	 *
+	 * Parameters:
+	 * The cells parameter is the number of squares
+	 * The mines parameter is the number of mines
+	 *
+	 * return value:
+	 * the table, or nullptr when it would take more than TABLE_BYTES
+	 */
+	std::shared_ptr<const LayoutCodec::Table> LayoutCodec::table(int cells, int mines) {
+		static std::mutex mutex;
+		static std::vector<std::shared_ptr<const Table>> tables;
+		std::lock_guard<std::mutex> lock(mutex);
+		for (std::shared_ptr<const Table>& table : tables) {
+			if (table->cells == cells && table->mines == mines) {
+				return table;
+			}
+		}
+		size_t width = static_cast<size_t>(rankBytes(cells, mines) + 3) / 4 + 1; // room for C(cells - 1, mines) itself
+		if (static_cast<double>(cells) * (mines + 1) * static_cast<double>(width) * sizeof(uint32_t) > TABLE_BYTES) {
+			return nullptr;
+		}
+		tables.push_back(std::make_shared<const Table>(cells, mines, width));
+		return tables.back();
+	}
+
+	/* Function Name: rankBytes()
+	 *
+	 * Function Description:
+	 * This function gives how many bytes the number of a layout takes
+	 *
+	 * Parameters:
+	 * The cells parameter is the number of squares
+	 * The mines parameter is the number of mines
+	 *
+	 * return value:
+	 * the bytes, 0 when there is only one layout
+	 */
+	int LayoutCodec::rankBytes(int cells, int mines) {
+		if (mines <= 0 || mines >= cells) {
+			return 0;
+		}
+		Number largest = start(cells, mines);
+		largest.multiply(static_cast<uint32_t>(cells)); // C(cells, mines) layouts, numbered from 0
+		largest.divide(static_cast<uint32_t>(cells - mines));
+		largest.subtract(Number(1));
+		return (largest.bits() + 7) / 8;
+	}
+
+	// boundBits(): log2 C(cells, mines), the least a layout can take on average
+	double LayoutCodec::boundBits(int cells, int mines) {
+		return logChoose(cells, mines) / std::log(2.0);
+	}
+
+	/* Function Name: encode()
+	 *
+	 * Function Description:
+	 * This function numbers a layout. Going down from the last square, each mine adds the number of layouts
+	 * that have the mines so far on the squares below it instead, C(square, mines still to come)
+	 *
+	 * Parameters:
+	 * The mines parameter is the layout, one entry per square, not zero for a mine
+	 * The out parameter receives the number
+	 * The bytes parameter is its size, from rankBytes()
+	 *
+	 * return value:
+	 * none
+	 */
+	void LayoutCodec::encode(const std::vector<char>& mines, unsigned char* out, int bytes) {
+		int cells = static_cast<int>(mines.size());
+		int left = static_cast<int>(std::count_if(mines.begin(), mines.end(), [](char mine) { return mine != 0; }));
+		Number rank(0);
+		std::shared_ptr<const Table> binomials = left > 0 && left < cells ? table(cells, left) : nullptr;
+		if (binomials) {
+			rank.limbs.assign(binomials->width, 0);
+			for (int square = cells - 1; left > 0 && left <= square; square--) {
+				if (mines[static_cast<size_t>(square)]) {
+					const uint32_t* ways = binomials->at(square, left--);
+					uint64_t carry = 0;
+					for (size_t limb = 0; limb < rank.limbs.size(); limb++) {
+						carry += static_cast<uint64_t>(rank.limbs[limb]) + ways[limb];
+						rank.limbs[limb] = static_cast<uint32_t>(carry);
+						carry >>= 32;
+					}
+				}
+			}
+		}
+		else if (left > 0 && left < cells) {
+			Number ways = start(cells, left); // C(square, left)
+			for (int square = cells - 1; left > 0 && left <= square; square--) {
+				if (mines[static_cast<size_t>(square)]) {
+					rank.add(ways);
+					ways.multiply(static_cast<uint32_t>(left)); // C(square - 1, left - 1)
+					left--;
+				}
+				else {
+					ways.multiply(static_cast<uint32_t>(square - left)); // C(square - 1, left)
+				}
+				ways.divide(static_cast<uint32_t>(square));
+			}
+		}
+		for (int index = 0; index < bytes; index++) {
+			size_t limb = static_cast<size_t>(index / 4);
+			out[index] = static_cast<unsigned char>(limb < rank.limbs.size() ? rank.limbs[limb] >> (index % 4 * 8) : 0);
+		}
+	}
+
+	/* Function Name: decode()
+	 *
+	 * Function Description:
+	 * This function gives back the layout with a number, walking down from the last square as encode() does:
+	 * a square is a mine when the number left is at least the layouts that keep it clear
+	 *
+	 * Parameters:
+	 * The in parameter is the number
+	 * The bytes parameter is its size
+	 * The cells parameter is the number of squares
+	 * The mines parameter is the number of mines
+	 * The found parameter receives the squares with mines, from the last down
+	 *
+	 * return value:
+	 * true if the number belongs to a layout
+	 */
+	bool LayoutCodec::decode(const unsigned char* in, int bytes, int cells, int mines, std::vector<int>& found) {
+		found.clear();
+		if (mines < 0 || mines > cells) {
+			return false;
+		}
+		Number rank(0);
+		rank.limbs.assign(static_cast<size_t>(bytes + 3) / 4 + 1, 0);
+		for (int index = 0; index < bytes; index++) {
+			rank.limbs[static_cast<size_t>(index / 4)] |= static_cast<uint32_t>(in[index]) << (index % 4 * 8);
+		}
+		while (rank.limbs.size() > 1 && rank.limbs.back() == 0) {
+			rank.limbs.pop_back();
+		}
+		int left = mines, square = cells - 1;
+		std::shared_ptr<const Table> binomials = left > 0 && left < cells ? table(cells, left) : nullptr;
+		if (binomials) {
+			size_t width = binomials->width;
+			if (rank.limbs.size() > width) {
+				return false;
+			}
+			rank.limbs.resize(width, 0);
+			uint32_t* value = rank.limbs.data();
+			for (; left > 0 && left <= square; square--) {
+				const uint32_t* ways = binomials->at(square, left);
+				size_t limb = width - 1;
+				while (limb > 0 && value[limb] == ways[limb]) {
+					limb--;
+				}
+				if (value[limb] >= ways[limb]) { // the layouts that keep this square clear are used up
+					int64_t borrow = 0;
+					for (size_t index = 0; index < width; index++) {
+						borrow += static_cast<int64_t>(value[index]) - ways[index];
+						value[index] = static_cast<uint32_t>(borrow);
+						borrow = borrow < 0 ? -1 : 0;
+					}
+					found.push_back(square);
+					left--;
+				}
+			}
+			while (rank.limbs.size() > 1 && rank.limbs.back() == 0) {
+				rank.limbs.pop_back();
+			}
+		}
+		else if (left > 0 && left < cells) {
+			Number ways = start(cells, left);
+			for (; left > 0 && left <= square; square--) {
+				if (rank.atLeast(ways)) {
+					rank.subtract(ways);
+					found.push_back(square);
+					ways.multiply(static_cast<uint32_t>(left));
+					left--;
+				}
+				else {
+					ways.multiply(static_cast<uint32_t>(square - left));
+				}
+				ways.divide(static_cast<uint32_t>(square));
+			}
+		}
+		for (; left > 0; left--, square--) {
+			found.push_back(square); // as many mines as squares left
+		}
+		return rank.isZero();
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Corpus Writer
+	/////////////////////////////////////////////
+
+	CorpusWriter::CorpusWriter() : written(0), rankBytes(0), loop(Render::RenderType::HEADLESS), arena(1 << 16) {}
+
+	/* Function Name: create()
+	 *
+	 * Function Description:
+	 * This function starts a corpus file. The header is written again by close() once the count is known
+	 *
+	 * Parameters:
+	 * The path parameter is the file to write
+	 * The options parameter is the size, mines, shape and placer every board in it shares
+	 *
+	 * return value:
+	 * true if the file could be created
+	 */
+	bool CorpusWriter::create(std::string path, GameOptions options) {
+		if (static_cast<int64_t>(options.width) * options.height > LayoutCodec::MAX_CELLS) {
+			return false;
+		}
+		this->options = options;
+		this->options.mines = std::max(0, std::min(options.mines, options.width * options.height - 1)); // as the placer does
+		rankBytes = LayoutCodec::rankBytes(options.width * options.height, this->options.mines);
+		offsets.clear();
+		out.open(path, std::ios::binary | std::ios::trunc);
+		for (int index = 0; index < HEADER_SIZE; index++) {
+			out.put(0);
+		}
+		written = HEADER_SIZE;
+		return static_cast<bool>(out);
+	}
+
+	// writeRecord(): appends the record that was built and notes where it starts
+	void CorpusWriter::writeRecord() {
+		offsets.push_back(written);
+		out.write(reinterpret_cast<const char*>(record.data()), static_cast<std::streamsize>(record.size()));
+		written += record.size();
+	}
+
+	/* Function Name: addSeeded()
+	 *
+	 * Function Description:
+	 * This function adds a board that the placer makes from a seed and a first click. It takes 13 bytes:
+	 * a 0, the seed and the first click
+	 *
+	 * Parameters:
+	 * The seed parameter is the seed
+	 * The firstClick parameter is the first click
+	 *
+	 * return value:
+	 * none
+	 */
+	void CorpusWriter::addSeeded(uint64_t seed, Point firstClick) {
+		uint32_t click = static_cast<uint32_t>(firstClick.y * options.width + firstClick.x);
+		record.assign(1, 0);
+		for (int index = 0; index < 8; index++) {
+			record.push_back(static_cast<unsigned char>(seed >> (index * 8)));
+		}
+		for (int index = 0; index < 4; index++) {
+			record.push_back(static_cast<unsigned char>(click >> (index * 8)));
+		}
+		writeRecord();
+	}
+
+	/* Function Name: addLayout()
+	 *
+	 * Function Description:
+	 * This function adds any layout with the corpus's number of mines: a 1, the first click, and the LayoutCodec number
+	 *
+	 * Parameters:
+	 * The mines parameter is the layout, one entry per square, not zero for a mine
+	 * The firstClick parameter is the first click
+	 *
+	 * return value:
+	 * true if the layout fits the corpus
+	 */
+	bool CorpusWriter::addLayout(const std::vector<char>& mines, Point firstClick) {
+		if (mines.size() != static_cast<size_t>(options.width) * options.height
+			|| std::count_if(mines.begin(), mines.end(), [](char mine) { return mine != 0; }) != options.mines) {
+			return false;
+		}
+		uint32_t click = static_cast<uint32_t>(firstClick.y * options.width + firstClick.x);
+		record.assign(1, 1);
+		for (int index = 0; index < 4; index++) {
+			record.push_back(static_cast<unsigned char>(click >> (index * 8)));
+		}
+		record.resize(record.size() + static_cast<size_t>(rankBytes));
+		LayoutCodec::encode(mines, record.data() + 5, rankBytes);
+		writeRecord();
+		return true;
+	}
+
+	/* Function Name: add()
+	 *
+	 * Function Description:
+	 * This function adds the mines of a board, as its seed when placing mines again from the seed and
+	 * the first click gives the same layout, and as a number otherwise
+	 *
+	 * Parameters:
+	 * The board parameter is the board, its mines already placed
+	 * The firstClick parameter is the first click
+	 *
+	 * return value:
+	 * true if the board fits the corpus
+	 */
+	bool CorpusWriter::add(Board& board, Point firstClick) {
+		GameOptions boardOptions = board.getOptions();
+		if (boardOptions.width != options.width || boardOptions.height != options.height || boardOptions.topology != options.topology) {
+			return false;
+		}
+		std::vector<char> mines(static_cast<size_t>(options.width) * options.height);
+		for (size_t cell = 0; cell < mines.size(); cell++) {
+			SpaceType type = board.getType(static_cast<int>(cell));
+			mines[cell] = type == SpaceType::MINE || type == SpaceType::EXPLODED_MINE || type == SpaceType::FLAGGED_MINE;
+		}
+		bool seeded = boardOptions.seed != 0 && boardOptions.minePlacerType == options.minePlacerType;
+		if (seeded) {
+			{
+				Game placed(loop, boardOptions, &arena);
+				RandomMinePlacer placer(placed.getBoard());
+				placer.placeMines(firstClick);
+				for (size_t cell = 0; cell < mines.size() && seeded; cell++) {
+					seeded = mines[cell] == (placed.getBoard().getType(static_cast<int>(cell)) == SpaceType::MINE);
+				}
+			}
+			arena.reset();
+		}
+		if (seeded) {
+			addSeeded(boardOptions.seed, firstClick);
+			return true;
+		}
+		return addLayout(mines, firstClick);
+	}
+
+	size_t CorpusWriter::size() {
+		return offsets.size();
+	}
+
+	/* Function Name: close()
+	 *
+	 * Function Description:
+	 * This function writes the index and then the header: "MSLC", a version byte, the shape, the placer,
+	 * a spare byte, the width, height and mines, the number of boards and where the index starts, little endian
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * true if the whole file was written
+	 */
+	bool CorpusWriter::close() {
+		auto put = [this](uint64_t value, int bytes) {
+			for (int index = 0; index < bytes; index++) {
+				out.put(static_cast<char>(value >> (index * 8)));
+			}
+		};
+		uint64_t index = written;
+		for (uint64_t offset : offsets) {
+			put(offset, 8);
+		}
+		out.seekp(0);
+		out.write("MSLC", 4);
+		put(1, 1);
+		put(static_cast<uint64_t>(options.topology), 1);
+		put(static_cast<uint64_t>(options.minePlacerType), 1);
+		put(0, 1);
+		put(static_cast<uint32_t>(options.width), 4);
+		put(static_cast<uint32_t>(options.height), 4);
+		put(static_cast<uint32_t>(options.mines), 4);
+		put(offsets.size(), 8);
+		put(index, 8);
+		bool ok = static_cast<bool>(out.flush());
+		out.close();
+		return ok;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Corpus Reader
+	/////////////////////////////////////////////
+
+	CorpusReader::CorpusReader() : rankBytes(0) {}
+
+	/* Function Name: open()
+	 *
+	 * Function Description:
+	 * This function opens a corpus and reads its header and index
+	 *
+	 * Parameters:
+	 * The path parameter is the file to read
+	 *
+	 * return value:
+	 * true if it is a corpus whose index fits the file
+	 */
+	bool CorpusReader::open(std::string path) {
+		in.open(path, std::ios::binary);
+		in.seekg(0, std::ios::end);
+		std::streamoff length = in.tellg();
+		in.seekg(0);
+		bool ok = true;
+		auto get = [this, &ok](int bytes) {
+			uint64_t value = 0;
+			for (int index = 0; index < bytes; index++) {
+				int byte = in.get();
+				ok &= byte != EOF;
+				value |= static_cast<uint64_t>(byte & 0xff) << (index * 8);
+			}
+			return value;
+		};
+		char magic[4] = {};
+		in.read(magic, 4);
+		if (!in || std::string(magic, 4) != "MSLC" || get(1) != 1) {
+			return false;
+		}
+		uint64_t topology = get(1), placer = get(1);
+		get(1);
+		options = GameOptions();
+		options.width = static_cast<int32_t>(get(4));
+		options.height = static_cast<int32_t>(get(4));
+		options.mines = static_cast<int32_t>(get(4));
+		uint64_t count = get(8), index = get(8);
+		uint64_t size = static_cast<uint64_t>(std::max<std::streamoff>(length, 0));
+		if (!ok || topology > static_cast<uint64_t>(Topology::KNIGHT) || placer > static_cast<uint64_t>(MinePlacerType::PARALLEL_RANDOM)
+			|| options.width < 1 || options.height < 1 || options.width > LayoutCodec::MAX_CELLS || options.height > LayoutCodec::MAX_CELLS
+			|| options.width * options.height > LayoutCodec::MAX_CELLS || options.mines < 0 || options.mines >= options.width * options.height
+			|| index < HEADER_SIZE || index > size || count > (size - index) / 8) { // the index is read before anything is allocated for it
+			return false;
+		}
+		options.topology = static_cast<Topology>(topology);
+		options.minePlacerType = static_cast<MinePlacerType>(placer);
+		rankBytes = LayoutCodec::rankBytes(options.width * options.height, options.mines);
+		in.seekg(static_cast<std::streamoff>(index));
+		offsets.resize(static_cast<size_t>(count));
+		for (uint64_t& offset : offsets) {
+			offset = get(8);
+		}
+		offsets.push_back(index);
+		ok &= offsets[0] >= HEADER_SIZE;
+		for (size_t id = 0; ok && id + 1 < offsets.size(); id++) {
+			ok = offsets[id] < offsets[id + 1];
+		}
+		return ok;
+	}
+
+	size_t CorpusReader::size() {
+		return offsets.empty() ? 0 : offsets.size() - 1;
+	}
+
+	GameOptions CorpusReader::getOptions() {
+		return options;
+	}
+
+	// isSeeded(): true if a board is stored as its seed rather than its number
+	bool CorpusReader::isSeeded(size_t id) {
+		in.seekg(static_cast<std::streamoff>(offsets[id]));
+		return in.get() == 0;
+	}
+
+	/* Function Name: build()
+	 *
+	 * Function Description:
+	 * This function rebuilds a board from its record. A seeded board has its mines placed by the placer,
+	 * which rates it as a played board would be. A numbered board has its mines written straight into its
+	 * chunks and is not rated, as a loaded game is not
+	 *
+	 * Parameters:
+	 * The record parameter is the record
+	 * The size parameter is its size
+	 * The loop parameter is the loop the game will belong to
+	 * The game parameter receives the game
+	 * The firstClick parameter receives the first click
+	 *
+	 * return value:
+	 * true if the record was valid
+	 */
+	bool CorpusReader::build(const unsigned char* record, size_t size, GameLoop& loop, std::unique_ptr<Game>& game, Point& firstClick) {
+		auto get = [record](size_t at, int bytes) {
+			uint64_t value = 0;
+			for (int index = 0; index < bytes; index++) {
+				value |= static_cast<uint64_t>(record[at + static_cast<size_t>(index)]) << (index * 8);
+			}
+			return value;
+		};
+		bool seeded = size == 13 && record[0] == 0;
+		if (!seeded && (size != 5 + static_cast<size_t>(rankBytes) || record[0] != 1)) {
+			return false;
+		}
+		uint64_t click = get(seeded ? 9 : 1, 4);
+		if (click >= static_cast<uint64_t>(options.width) * options.height) {
+			return false;
+		}
+		firstClick = Point(static_cast<int>(click) % options.width, static_cast<int>(click) / options.width);
+		GameOptions boardOptions = options;
+		boardOptions.seed = seeded ? get(1, 8) : 0;
+		game.reset(new Game(loop, boardOptions));
+		game->firstMove = false;
+		Board& board = game->board;
+		if (seeded) {
+			RandomMinePlacer placer(board);
+			placer.placeMines(firstClick);
+			return true;
+		}
+		thread_local std::vector<int> found;
+		if (!LayoutCodec::decode(record + 5, rankBytes, options.width * options.height, options.mines, found)) {
+			return false;
+		}
+		board.unshare();
+		for (int cell : found) {
+			board.table->chunks[static_cast<size_t>(cell) >> Board::CHUNK_BITS]->types[static_cast<size_t>(cell) & (Board::CHUNK_SIZE - 1)] = SpaceType::MINE;
+		}
+		return true;
+	}
+
+	/* Function Name: load()
+	 *
+	 * Function Description:
+	 * This function rebuilds one board
+	 *
+	 * Parameters:
+	 * The id parameter is the board's number in the corpus, from 0
+	 * The loop parameter is the loop the game will belong to
+	 * The game parameter receives the game
+	 * The firstClick parameter receives the first click
+	 *
+	 * return value:
+	 * true if the board was read
+	 */
+	bool CorpusReader::load(size_t id, GameLoop& loop, std::unique_ptr<Game>& game, Point& firstClick) {
+		if (id >= size()) {
+			return false;
+		}
+		std::vector<unsigned char> record(static_cast<size_t>(offsets[id + 1] - offsets[id]));
+		in.clear();
+		in.seekg(static_cast<std::streamoff>(offsets[id]));
+		if (!in.read(reinterpret_cast<char*>(record.data()), static_cast<std::streamsize>(record.size()))) {
+			return false;
+		}
+		return build(record.data(), record.size(), loop, game, firstClick);
+	}
+
+	/* Function Name: loadAll()
+	 *
+	 * Function Description:
+	 * This function rebuilds a run of boards. Their records are read in one go and
+	 * the boards are rebuilt in batches on every core
+	 *
+	 * Parameters:
+	 * The first parameter is the number of the first board
+	 * The count parameter is how many boards
+	 * The loop parameter is the loop the games will belong to
+	 * The games parameter receives the games
+	 * The firstClicks parameter receives their first clicks
+	 *
+	 * return value:
+	 * true if every board was read
+	 */
+	bool CorpusReader::loadAll(size_t first, size_t count, GameLoop& loop, std::vector<std::unique_ptr<Game>>& games, std::vector<Point>& firstClicks) {
+		if (first > size() || count > size() - first) {
+			return false;
+		}
+		std::vector<unsigned char> records(static_cast<size_t>(offsets[first + count] - offsets[first]));
+		in.clear();
+		in.seekg(static_cast<std::streamoff>(offsets[first]));
+		if (!in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size()))) {
+			return false;
+		}
+		games.clear();
+		games.resize(count);
+		firstClicks.assign(count, Point(0, 0));
+		std::atomic<bool> ok(true);
+		const size_t batchSize = 256;
+		std::vector<std::function<void()>> batches;
+		for (size_t start = 0; start < count; start += batchSize) {
+			batches.push_back([&, start]() {
+				for (size_t index = start; index < std::min(count, start + batchSize); index++) {
+					size_t id = first + index;
+					if (!build(records.data() + (offsets[id] - offsets[first]), static_cast<size_t>(offsets[id + 1] - offsets[id]), loop, games[index], firstClicks[index])) {
+						ok = false;
+					}
+				}
+			});
+		}
+		WorkerPool::shared().runAll(batches);
+		return ok;
+	}
+
+#ifdef tracing
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Tracer
+	/////////////////////////////////////////////
+
+	Tracer::Tracer() : events(new Event[CAPACITY]), epoch(std::chrono::steady_clock::now()) {}
+
+	Tracer& Tracer::get() {
+		static Tracer* tracer = new Tracer(); // never destroyed, so it can still be written at exit
+		return *tracer;
+	}
+
+	// now(): microseconds since the tracer started
+	int64_t Tracer::now() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - get().epoch).count();
+	}
+
+	/* Function Name: record()
+	 *
+	 * Function Description:
+	 * This function claims the next slot of the ring buffer and fills it. The ticket is cleared
+	 * before the fields are written and set after, so a reader can tell a finished slot from a busy one
+	 *
+	 * Parameters:
+	 * The phase parameter is the trace event phase, 'X' for a timed scope and 'C' for a counter
+	 * The name parameter is the event name, a string literal
+	 * The argument parameter names the value, or is nullptr
+	 * The start and duration parameters are in microseconds
+	 * The value parameter is the value recorded with the event
+	 *
+	 * return value:
+	 * none
+	 */
+	void Tracer::record(char phase, const char* name, const char* argument, int64_t start, int64_t duration, int64_t value) {
+		Tracer& tracer = get();
+		thread_local uint32_t thread = tracer.threads.fetch_add(1, std::memory_order_relaxed);
+		uint64_t ticket = tracer.next.fetch_add(1, std::memory_order_relaxed);
+		Event& event = tracer.events[ticket & (CAPACITY - 1)];
+		event.ticket.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		event.name.store(name, std::memory_order_relaxed);
+		event.argument.store(argument, std::memory_order_relaxed);
+		event.start.store(start, std::memory_order_relaxed);
+		event.duration.store(duration, std::memory_order_relaxed);
+		event.value.store(value, std::memory_order_relaxed);
+		event.thread.store(thread, std::memory_order_relaxed);
+		event.phase.store(phase, std::memory_order_relaxed);
+		event.ticket.store(ticket + 1, std::memory_order_release);
+	}
+
+	void Tracer::counter(const char* name, int64_t value) {
+		record('C', name, nullptr, now(), 0, value);
+	}
+
+	/* Function Name: dump()
+	 *
+	 * Function Description:
+	 * This function writes every event still in the ring buffer as Chrome trace event JSON.
+	 * Recording carries on while it runs
+	 *
+	 * Parameters:
+	 * The path parameter is the file to write
+	 *
+	 * return value:
+	 * true if the file was written
+	 */
+	bool Tracer::dump(std::string path) {
+		Tracer& tracer = get();
+		std::ofstream out(path, std::ios::trunc);
+		out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		uint64_t last = tracer.next.load(std::memory_order_acquire);
+		bool first = true;
+		for (uint64_t ticket = last > CAPACITY ? last - CAPACITY : 0; ticket < last; ticket++) {
+			Event& event = tracer.events[ticket & (CAPACITY - 1)];
+			if (event.ticket.load(std::memory_order_acquire) != ticket + 1) {
+				continue;
+			}
+			const char* name = event.name.load(std::memory_order_relaxed);
+			const char* argument = event.argument.load(std::memory_order_relaxed);
+			int64_t start = event.start.load(std::memory_order_relaxed);
+			int64_t duration = event.duration.load(std::memory_order_relaxed);
+			int64_t value = event.value.load(std::memory_order_relaxed);
+			uint32_t thread = event.thread.load(std::memory_order_relaxed);
+			char phase = event.phase.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (event.ticket.load(std::memory_order_relaxed) != ticket + 1) {
+				continue; // overwritten while it was being read
+			}
+			out << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"ph\":\"" << phase
+				<< "\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << start;
+			if (phase == 'X') {
+				out << ",\"dur\":" << duration;
+			}
+			if (phase == 'C' || argument != nullptr) {
+				out << ",\"args\":{\"" << (argument != nullptr ? argument : name) << "\":" << value << "}";
+			}
+			out << "}";
+			first = false;
+		}
+		out << "\n]}\n";
+		return static_cast<bool>(out.flush());
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: TraceScope
+	/////////////////////////////////////////////
+
+	TraceScope::TraceScope(const char* name, const char* argument) : name(name), argument(argument), start(Tracer::now()) {}
+
+	TraceScope::~TraceScope() {
+		Tracer::record('X', name, argument, start, Tracer::now() - start, value);
+	}
+
+	inline void TraceScope::setValue(int64_t value) {
+		this->value = value;
+	}
+#endif
+}
+
+namespace Render {
+	// Renderer: Trivial virtual destructor
+	Renderer::~Renderer() {}
+
+#ifdef coroutines
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Session Task
+	/////////////////////////////////////////////
+
+	/* Class Name: SessionTask::promise_type
+	 *
+	 * Class Description:
+	 * This Class is what the compiler keeps in a SessionTask's frame: the task to go back to when it finishes, and
+	 * an exception it ended with. Frames are counted as they are allocated, to show what a session costs
+	 */
+	class SessionTask::promise_type {
+	public:
+		static std::atomic<size_t> frameBytes;
+		std::coroutine_handle<> continuation;
+		std::exception_ptr failure;
+		SessionTask get_return_object() {
+			return SessionTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend() noexcept {
+			return {};
+		}
+		FinalAwaiter final_suspend() noexcept;
+		void return_void() {}
+		void unhandled_exception() {
+			failure = std::current_exception();
+		}
+		static void* operator new(size_t size) {
+			frameBytes += size;
+			return ::operator new(size);
+		}
+#if defined(__GNUC__) && !defined(__clang__)
+		[[gnu::always_inline]] // GCC inlines operator new into each coroutine, and warns -Wmismatched-new-delete unless this is inlined too
+#endif
+		static void operator delete(void* frame, size_t size) {
+			frameBytes -= size;
+			::operator delete(frame);
+		}
+	};
+
+	std::atomic<size_t> SessionTask::promise_type::frameBytes{ 0 };
+
+	// SessionTask::FinalAwaiter: on finishing, carries on with the task that awaited this one, if any
+	class SessionTask::FinalAwaiter {
+	public:
+		bool await_ready() noexcept {
+			return false;
+		}
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finished) noexcept {
+			std::coroutine_handle<> continuation = finished.promise().continuation;
+			return continuation ? continuation : std::noop_coroutine();
+		}
+		void await_resume() noexcept {}
+	};
+
+	inline SessionTask::FinalAwaiter SessionTask::promise_type::final_suspend() noexcept {
+		return {};
+	}
+
+	SessionTask::SessionTask() : handle(nullptr) {}
+
+	SessionTask::SessionTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+	SessionTask::SessionTask(SessionTask&& other) noexcept : handle(other.handle) {
+		other.handle = nullptr;
+	}
+
+	SessionTask& SessionTask::operator = (SessionTask&& other) noexcept {
+		if (this != &other) {
+			if (handle) {
+				handle.destroy();
+			}
+			handle = other.handle;
+			other.handle = nullptr;
+		}
+		return *this;
+	}
+
+	SessionTask::~SessionTask() {
+		if (handle) {
+			handle.destroy(); // a suspended task frees the tasks it awaits with it
+		}
+	}
+
+	// start(): runs an outermost task until it first waits
+	void SessionTask::start() {
+		handle.resume();
+	}
+
+	bool SessionTask::isDone() {
+		return !handle || handle.done();
+	}
+
+	// rethrow(): passes on an exception the task finished with
+	void SessionTask::rethrow() {
+		if (handle && handle.done() && handle.promise().failure) {
+			std::rethrow_exception(handle.promise().failure);
+		}
+	}
+
+	bool SessionTask::await_ready() {
+		return false;
+	}
+
+	// await_suspend(): runs the awaited task straight away, which comes back here when it finishes
+	std::coroutine_handle<> SessionTask::await_suspend(std::coroutine_handle<> awaiting) {
+		handle.promise().continuation = awaiting;
+		return handle;
+	}
+
+	void SessionTask::await_resume() {
+		rethrow();
+	}
+
+	// getFrameBytes(): the bytes taken by every task frame alive
+	size_t SessionTask::getFrameBytes() {
+		return promise_type::frameBytes;
+	}
+#endif
+
+	// Render class implementations (Console)
+
+	// Things used for drawing to the screen
+#ifdef __cpp_char8_t // u8 strings are char8_t from C++20 on, the console takes them as bytes
+#define CONSOLE_TEXT(text) reinterpret_cast<const char*>(u8##text)
+#else
+#define CONSOLE_TEXT(text) u8##text
+#endif
+#define CONSOLE_H_BAR CONSOLE_TEXT("══")
+#define CONSOLE_H_HALF_BAR CONSOLE_TEXT("═")
+#define CONSOLE_V_BAR CONSOLE_TEXT("║")
+#define CONSOLE_TL_CORNER CONSOLE_TEXT("╔")
+#define CONSOLE_TR_CORNER CONSOLE_TEXT("╗")
+#define CONSOLE_BL_CORNER CONSOLE_TEXT("╚")
+#define CONSOLE_BR_CORNER CONSOLE_TEXT("╝")
+#define CONSOLE_VBOX CONSOLE_TEXT("██")
+#define CONSOLE_VSELECT CONSOLE_TEXT("▒")
+#define CONSOLE_FLAG CONSOLE_TEXT("√")
+#define CONSOLE_MINE CONSOLE_TEXT("Φ")
+#define CONSOLE_SAVE_FILE "minesweeper.sav"
+	constexpr char KEY_CLOSED = 4; // the key read once nothing more can be typed, what Ctrl-D types
+
+	// A console step waits for its keys and for the steps it starts. Without coroutines it is blocked until they are done
+#ifdef coroutines
+#define STEP_AWAIT co_await
+#define STEP_RETURN co_return
+#else
+#define STEP_AWAIT
+#define STEP_RETURN return SessionTask()
+#endif
+
+	// Colours of the compact board, from the 256 colour palette
+#define COMPACT_HIDDEN 244
+#define COMPACT_FLAG 226
+#define COMPACT_MINE 196
+	constexpr int COMPACT_NUMBERS[9] = { 0, 33, 40, 196, 63, 124, 44, 255, 250 };
+
+	ConsoleRenderer::ConsoleRenderer(ScriptedTerminal* terminal)
+		: selection(Logic::Point(0, 0)), arena(1 << 16), viewOrigin(Logic::Point(0, 0)), presented(0), terminal(terminal), out(std::cout),
+		session(false), seed(0), prompt(SessionPrompt::MENU), menuSelected(0), gamesStarted(0), playing(nullptr), leaving(false) {
+		this->selectionMode = SelectionMode::NONE;
+		this->lastAction = SelectionMode::REVEAL;
+		options.width = 20;
+		options.height = 20;
+		options.mines = 100;
+		options.minePlacerType = Logic::MinePlacerType::RANDOM;
+#ifdef coroutines
+		key = 0;
+#endif
+	}
+
+	// readKey(): the next key from the script if there is one, otherwise from the keyboard
+	char ConsoleRenderer::readKey() {
+		return terminal ? terminal->nextKey() : getCharacter();
+	}
+
+	// measure(): the size of the script's terminal if there is one, otherwise of the real one. A session has no terminal
+	bool ConsoleRenderer::measure(int& columns, int& rows) {
+		if (session) {
+			return false;
+		}
+		return terminal ? terminal->getSize(columns, rows) : getTerminalSize(columns, rows);
+	}
+
+	// nextSeed(): the seed of a new game, the script's or the session's next one, otherwise 0 for a random one
+	uint64_t ConsoleRenderer::nextSeed() {
+		if (terminal) {
+			return terminal->nextSeed();
+		}
+		return session ? seed++ : 0;
+	}
+
+	/* Function Name: saveGame()
+	 *
+	 * Function Description:
+	 * This function saves a game left unfinished to CONSOLE_SAVE_FILE. A script or a session keeps it in memory,
+	 * in the save format, instead: it then resumes only what it saved itself, and leaves the player's own save alone
+	 *
+	 * Parameters:
+	 * The game parameter is the game to save
+	 *
+	 * return value:
+	 * true if the game was saved
+	 */
+	bool ConsoleRenderer::saveGame(Logic::Game& game) {
+		if (!terminal && !session) {
+			return Logic::GameSerializer::save(game, CONSOLE_SAVE_FILE);
+		}
+		if (!Logic::GameSerializer::fits(game.getOptions())) {
+			return false;
+		}
+		std::ostringstream save;
+		Logic::GameSerializer::write(game, save, Logic::BoardFormat::SAVE);
+		saved = save.str();
+		return true;
+	}
+
+	// loadGame(): the game saveGame() saved last
+	bool ConsoleRenderer::loadGame(Logic::GameLoop& loop, std::unique_ptr<Logic::Game>& game) {
+		if (!terminal && !session) {
+			return Logic::GameSerializer::load(CONSOLE_SAVE_FILE, loop, game);
+		}
+		std::istringstream save(saved);
+		return !saved.empty() && Logic::GameSerializer::read(save, loop, game);
+	}
+
+	// removeSave(): forgets the saved game once it is finished, as a finished game cannot be resumed again
+	void ConsoleRenderer::removeSave() {
+		if (terminal || session) {
+			saved.clear();
+			return;
+		}
+		std::remove(CONSOLE_SAVE_FILE);
+	}
+
+#ifdef coroutines
+	// ConsoleRenderer::KeyAwaiter: parks the awaiting step on the console until feed() brings a key
+	class ConsoleRenderer::KeyAwaiter {
+	public:
+		ConsoleRenderer& console;
+		bool await_ready() noexcept {
+			return false;
+		}
+		void await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			console.waiting = awaiting;
+		}
+		char await_resume() noexcept {
+			return console.key;
+		}
+	};
+
+	// nextKey(): what a step awaits for its next key, showing which prompt it is at
+	inline ConsoleRenderer::KeyAwaiter ConsoleRenderer::nextKey(SessionPrompt prompt) {
+		this->prompt = prompt;
+		return KeyAwaiter{ *this };
+	}
+#else
+	// nextKey(): the next key for a step, waited for on the keyboard
+	inline char ConsoleRenderer::nextKey(SessionPrompt prompt) {
+		this->prompt = prompt;
+		return readKey();
+	}
+
+	// drive(): without coroutines a step has already run to its end when it returns
+	inline void ConsoleRenderer::drive(SessionTask) {}
+#endif
+
+	void ConsoleRenderer::initializeRender() {
+
+	}
+
+	/* Function Name: drawBoard()
+	 *
+	 * Function Description:
+	 * This starts a new screen with the board on it, which present() puts on the terminal.
+	 * When the terminal is too small for two columns a square, the board is drawn compactly instead,
+	 * cropped to the part around the selection if it still does not fit
+	 *
+	 * Parameters:
+	 * The game parameter references the Game class
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::drawBoard(Logic::Game& game) {
+		TRACE_SCOPE(scope, "drawBoard", "bytes");
+		if (out.rdbuf() == nullptr) {
+			return; // a session drawn nowhere
+		}
+		std::ostringstream frame; // the whole frame goes to the terminal in one write
+		Logic::Board& board = game.getBoard();
+		Logic::GameOptions options = game.getOptions();
+		int columns = 0, rows = 0;
+		int lineLength;
+		if (measure(columns, rows) && (options.width * 2 + 6 > columns || options.height + 10 > rows)) {
+			lineLength = drawCompactBoard(game, frame, columns, rows);
+		}
+		else {
+			lineLength = drawFullBoard(game, frame);
+		}
+
+		if (game.getState() == Logic::GameState::PLAYING) {
+			int64_t timeDifference = Logic::currentTimeSeconds() - game.getStartTime();
+			int flags = game.getRemainingFlags();
+			std::string time = "Time: " + std::to_string(timeDifference) + " seconds";
+			std::string output = "   Remaining Flags: " + std::to_string(flags);
+			if (lineLength >= static_cast<int>(output.size() + time.size())) {
+				output += std::string(lineLength - output.size() - time.size(), ' ');
+			}
+			else {
+				output += "\n   ";
+			}
+			output += time;
+			frame << output << std::endl;
+		}
+		if (!game.isFirstMove()) {
+			Logic::DifficultyProfile difficulty = board.getDifficulty();
+			frame << "   3BV: " << difficulty.threeBV << "   Openings: " << difficulty.openings
+				<< "   Forced Guesses: " << difficulty.forcedGuesses << "   Seed: " << options.seed << std::endl;
+		}
+
+		frame << std::endl;
+		std::string text = frame.str();
+		screen.str(text);
+		screen.seekp(0, std::ios::end);
+		presented = 0;
+		TRACE_VALUE(scope, text.size());
+	}
+
+	/* Function Name: drawFullBoard()
+	 *
+	 * Function Description:
+	 * This draws the whole board two columns a square, inside a box with every other row and column numbered
+	 *
+	 * Parameters:
+	 * The game parameter references the Game class
+	 * The frame parameter is where the board is drawn
+	 *
+	 * return value:
+	 * the width of the board in columns
+	 */
+	int ConsoleRenderer::drawFullBoard(Logic::Game& game, std::ostringstream& frame) {
+		Logic::Board& board = game.getBoard();
+		Logic::GameOptions options = game.getOptions();
+		Logic::GameState state = game.getState();
+		bool hex = options.topology == Logic::Topology::HEX; // odd rows sit half a square to the right
+		std::vector<std::string> lines;
+		std::string start, end, numbers, spikes;
+		for (int y = 0; y < options.height; y++) {
+			spikes = "    ";
+			numbers = "    ";
+			start = "   ";
+			start += CONSOLE_TL_CORNER;
+			end = "   ";
+			end += +CONSOLE_BL_CORNER;
+			std::string row;
+			if (y % 2 == 0) {
+				std::string strNum = std::to_string(y + 1);
+				if (strNum.size() == 1) {
+					strNum = "0" + strNum;
+				}
+				row += strNum + "-" + CONSOLE_V_BAR;
+			}
+			else {
+				row += "   ";
+				row += CONSOLE_V_BAR;
+			}
+			if (hex && y % 2 == 1) {
+				row += " ";
+			}
+			for (int x = 0; x < options.width; x++) {
+				bool color = selectionMode != SelectionMode::NONE && Logic::Point(x, y) == selection;
+				if (x % 2 == 0) {
+					std::string strNum = std::to_string(x + 1);
+					if (strNum.size() == 1) {
+						strNum = "0" + strNum;
+					}
+					numbers += strNum + "  ";
+					spikes += "|   ";
+				}
+				start += CONSOLE_H_BAR;
+				end += CONSOLE_H_BAR;
+				Logic::Space space = board.getSpaceAt(x, y);
+				std::string dispCount = std::to_string(space.getAdjacentMines());
+				if (dispCount == "0" || state == Logic::GameState::LOSS) {
+					dispCount = " ";
+				}
+				if (color) {
+					if (selectionMode == SelectionMode::REVEAL) {
+						row += RED;
+					}
+					else if (selectionMode == SelectionMode::CHORD) {
+						row += YELLOW_HILIGHT;
+					}
+					else {
+						row += GREEN;
+					}
+				}
+				switch (space.getType()) {
+				case Logic::SpaceType::EXPLODED_MINE:
+					row += CONSOLE_MINE;
+					break;
+				case Logic::SpaceType::REVEALED:
+					if (dispCount == " " && color) {
+						dispCount = CONSOLE_VSELECT;
+					}
+					row += dispCount;
+					break;
+				case Logic::SpaceType::MINE:
+				case Logic::SpaceType::EMPTY:
+					row += CONSOLE_VBOX;
+					break;
+				case Logic::SpaceType::FALSE_FLAG:
+				case Logic::SpaceType::FLAGGED_MINE:
+					row += CONSOLE_FLAG;
+					break;
+				default:
+					row += " ";
+				}
+				if (color) {
+					row += RESET;
+				}
+				if (space.getType() != Logic::SpaceType::EMPTY && space.getType() != Logic::SpaceType::MINE) {
+					row += " ";
+				}
+			}
+			if (hex && y % 2 == 0) {
+				row += " ";
+			}
+			row += CONSOLE_V_BAR;
+			lines.push_back(row);
+		}
+		if (hex) {
+			start += CONSOLE_H_HALF_BAR;
+			end += CONSOLE_H_HALF_BAR;
+		}
+		start += CONSOLE_TR_CORNER;
+		end += CONSOLE_BR_CORNER;
+		lines.insert(lines.begin(), start);
+		lines.insert(lines.begin(), spikes);
+		lines.insert(lines.begin(), numbers);
+		lines.push_back(end);
+
+		for (std::string line : lines) {
+			frame << line << std::endl;
+		}
+		const char* last = lines.back().c_str();
+		int length = 0;
+		while (*last) length += (*last++ & 0xc0) != 0x80;
+		return length;
+	}
+
+	/* Function Name: drawCompactBoard()
+	 *
+	 * Function Description:
+	 * This draws the board one column a square in plain ASCII, with a colour change only where the colour
+	 * of the squares changes rather than around every square. If the board is bigger than the terminal
+	 * only the part around the selection is drawn. Hex rows are not offset, there is no half column to use
+	 *
+	 * Parameters:
+	 * The game parameter references the Game class
+	 * The frame parameter is where the board is drawn
+	 * The columns and rows parameters are the size of the terminal
+	 *
+	 * return value:
+	 * the width of the board in columns
+	 */
+	int ConsoleRenderer::drawCompactBoard(Logic::Game& game, std::ostringstream& frame, int columns, int rows) {
+		Logic::Board& board = game.getBoard();
+		Logic::GameOptions options = game.getOptions();
+		Logic::GameState state = game.getState();
+		int labelWidth = static_cast<int>(std::to_string(options.height).size());
+		int viewWidth = std::max(1, std::min(options.width, columns - labelWidth - 2));
+		int viewHeight = std::max(1, std::min(options.height, rows - 9)); // ruler, status, prompts and the crop note
+		// Keep the selection on screen, moving the view by half a screen when it leaves
+		if (selection.x < viewOrigin.x || selection.x >= viewOrigin.x + viewWidth) {
+			viewOrigin.x = selection.x - viewWidth / 2;
+		}
+		if (selection.y < viewOrigin.y || selection.y >= viewOrigin.y + viewHeight) {
+			viewOrigin.y = selection.y - viewHeight / 2;
+		}
+		viewOrigin.x = std::max(0, std::min(viewOrigin.x, options.width - viewWidth));
+		viewOrigin.y = std::max(0, std::min(viewOrigin.y, options.height - viewHeight));
+
+		std::string ruler(static_cast<size_t>(labelWidth + 1 + viewWidth), ' ');
+		for (int x = viewOrigin.x; x < viewOrigin.x + viewWidth; x++) {
+			std::string number = std::to_string(x + 1);
+			size_t at = static_cast<size_t>(labelWidth + 1 + x - viewOrigin.x);
+			if ((x + 1) % 10 == 0 || x == viewOrigin.x) {
+				if (at + number.size() <= ruler.size() && ruler.compare(at > 0 ? at - 1 : at, number.size() + 1, std::string(number.size() + 1, ' ')) == 0) {
+					ruler.replace(at, number.size(), number);
+				}
+			}
+		}
+		ruler.erase(ruler.find_last_not_of(' ') + 1);
+		frame << ruler << std::endl;
+
+		std::string row;
+		for (int y = viewOrigin.y; y < viewOrigin.y + viewHeight; y++) {
+			std::string label = std::to_string(y + 1);
+			row.assign(static_cast<size_t>(labelWidth) - label.size(), ' ');
+			row += label;
+			row += '|';
+			int colour = 0; // the colour the terminal is in, 0 for none
+			for (int x = viewOrigin.x; x < viewOrigin.x + viewWidth; x++) {
+				Logic::Space space = board.getSpaceAt(x, y);
+				char glyph = ' ';
+				int wanted = colour; // a blank square can be drawn in any colour
+				switch (space.getType()) {
+				case Logic::SpaceType::EXPLODED_MINE:
+					glyph = '*';
+					wanted = COMPACT_MINE;
+					break;
+				case Logic::SpaceType::REVEALED:
+					if (space.getAdjacentMines() > 0 && state != Logic::GameState::LOSS) {
+						glyph = static_cast<char>('0' + space.getAdjacentMines());
+						wanted = COMPACT_NUMBERS[space.getAdjacentMines()];
+					}
+					break;
+				case Logic::SpaceType::MINE:
+				case Logic::SpaceType::EMPTY:
+					glyph = '#';
+					wanted = COMPACT_HIDDEN;
+					break;
+				case Logic::SpaceType::FALSE_FLAG:
+				case Logic::SpaceType::FLAGGED_MINE:
+					glyph = 'F';
+					wanted = COMPACT_FLAG;
+					break;
+				default:
+					break;
+				}
+				if (selectionMode != SelectionMode::NONE && Logic::Point(x, y) == selection) {
+					row += selectionMode == SelectionMode::REVEAL ? RED : selectionMode == SelectionMode::CHORD ? YELLOW_HILIGHT : GREEN;
+					row += "\u001b[7m";
+					row += glyph;
+					row += RESET;
+					colour = 0;
+					continue;
+				}
+				if (wanted != colour) {
+					row += "\u001b[38;5;" + std::to_string(wanted) + "m";
+					colour = wanted;
+				}
+				row += glyph;
+			}
+			if (colour != 0) {
+				row += RESET;
+			}
+			row += '|';
+			frame << row << '\n';
+		}
+		if (viewWidth < options.width || viewHeight < options.height) {
+			frame << "   Columns " << viewOrigin.x + 1 << "-" << viewOrigin.x + viewWidth << " of " << options.width
+				<< ", rows " << viewOrigin.y + 1 << "-" << viewOrigin.y + viewHeight << " of " << options.height << std::endl;
+		}
+		return labelWidth + 2 + viewWidth;
+	}
+
+	/* Function Name: promptForInput()
+	 *
+	 * Function Description:
+	 * This function prompts for all inputs and handles them, running the turn step on the keyboard. Returns true if the game was left
+	 *
+	 * Parameters:
+	 * The game parameter is passed by reference
+	 *
+	 * return value:
+	 * bool
+	 */
+	bool ConsoleRenderer::promptForInput(Logic::Game& game) {
+		drive(turn(game));
+		return leaving;
+	}
+
+	/* Function Name: turn()
+	 *
+	 * Function Description:
+	 * This step prompts for an action and the square to do it on, and does it. A hint, an undo or a move that
+	 * does nothing is a turn too. When the game is quit, saving it, or nothing more can be typed, leaving is set
+	 *
+	 * Parameters:
+	 * The game parameter is the game being played
+	 *
+	 * return value:
+	 * the step
+	 */
+	SessionTask ConsoleRenderer::turn(Logic::Game& game) {
+		enum class Command {
+			REVEAL, FLAG, CHORD, UNDO, HINT, ODDS, QUIT, INVALID
+		};
+		Logic::GameOptions options = game.getOptions();
+		Command selected = Command::INVALID;
+		char hackThatInput = 0;
+		while (selected == Command::INVALID) {
+			screen << "What action would you like to perform? Choose from (r)eveal, (f)lag, (c)hord, (u)ndo, (h)int, (p)robability hint, or (q)uit and save: ";
+			present();
+			char command = STEP_AWAIT nextKey(SessionPrompt::COMMAND);
+			if (command == 0) {
+				screen << "Please type something..." << std::endl;
+			}
+			switch (command) {
+			case 'r':
+				this->lastAction = SelectionMode::REVEAL;
+				selected = Command::REVEAL;
+				break;
+			case 'f':
+				if (game.isFirstMove()) {
+					screen << "You cannot set a flag on your first move!" << std::endl;
+					continue;
+				}
+				this->lastAction = SelectionMode::FLAG;
+				selected = Command::FLAG;
+				break;
+			case 'c':
+				if (game.isFirstMove()) {
+					screen << "You cannot chord on your first move!" << std::endl;
 					continue;
 				}
-				Point access = location.add(xOffset, yOffset);
-				if (access.x < 0 || access.y < 0 || access.x >= board.getOptions().width || access.y >= board.getOptions().height) {
+				this->lastAction = SelectionMode::CHORD;
+				selected = Command::CHORD;
+				break;
+			case 'u':
+				if (history.empty()) {
+					screen << "There is nothing to undo!" << std::endl;
+					continue;
+				}
+				selected = Command::UNDO;
+				break;
+			case 'h':
+				selected = Command::HINT;
+				break;
+			case 'p':
+				selected = Command::ODDS;
+				break;
+			case 'q':
+				selected = Command::QUIT;
+				break;
+			case KEY_CLOSED: // nothing more can be typed, so the game ends where it is without a save
+				leaving = true;
+				STEP_RETURN;
+#ifdef tracing
+			case 't':
+				screen << (Logic::Tracer::dump(TRACE_FILE) ? "The trace was written to " TRACE_FILE "." : "The trace could not be written.") << std::endl;
+				continue;
+#endif
+#if defined(windows) || defined(bash)
+			case 'w':
+			case 'a':
+			case 's':
+			case 'd':
+			case 72:
+			case 80:
+			case 75:
+			case 77:
+				hackThatInput = command;
+				switch (lastAction) {
+				case SelectionMode::FLAG:
+					selected = Command::FLAG;
+					break;
+				case SelectionMode::REVEAL:
+					selected = Command::REVEAL;
+					break;
+				case SelectionMode::CHORD:
+					selected = Command::CHORD;
+					break;
+				default:
+					break;
+				}
+				break;
+#endif
+			default:
+				screen << "That was not a valid command." << std::endl;
+				break;
+			}
+		}
+		if (selected == Command::QUIT) {
+			drawBoard(game);
+			if (!game.isFirstMove() && game.getState() == Logic::GameState::PLAYING) {
+				if (saveGame(game)) {
+					screen << "Your game was saved, choose Resume Game from the main menu to continue it." << std::endl;
+				}
+				else {
+					screen << "Your game could not be saved." << std::endl;
+				}
+			}
+			leaving = true;
+			STEP_RETURN;
+		}
+		if (selected == Command::UNDO) {
+			game.restore(history.back());
+			history.pop_back();
+			if (advisor) {
+				advisor->rebuild();
+			}
+			drawBoard(game);
+			STEP_RETURN;
+		}
+		if (selected == Command::HINT) {
+			showHint(game);
+			STEP_RETURN;
+		}
+		if (selected == Command::ODDS) {
+			showOdds(game);
+			STEP_RETURN;
+		}
+#if !defined(windows) && !defined(bash)
+		present();
+		out << "Now you will input the X and Y positions of the square to target." << std::endl;
+		int x = 0, y = 0;
+		while (x < 1 || x > options.width) {
+			out << "X: ";
+			std::cin >> x;
+			std::cin.clear();
+			std::cin.ignore(100000, '\n');
+			if (x < 1 || x > options.width) {
+				out << "You must enter a value in the range of the width (1-" << options.width << ")." << std::endl;
+			}
+		}
+		while (y < 1 || y > options.height) {
+			out << "Y: ";
+			std::cin >> y;
+			std::cin.clear();
+			std::cin.ignore(100000, '\n');
+			if (y < 1 || y > options.height) {
+				out << "You must enter a value in the range of the height (1-" << options.height << ")." << std::endl;
+			}
+		}
+		Logic::Point location(x - 1, y - 1);
+#else
+		this->selectionMode = (selected == Command::REVEAL ? SelectionMode::REVEAL : selected == Command::CHORD ? SelectionMode::CHORD : SelectionMode::FLAG);
+		while (true) {
+			if (!hackThatInput) {
+				drawBoard(game);
+				screen << "Use keys (w, a, s, d) to change selection and press (ENTER) to select square." << std::endl;
+				std::string exitStr = "r";
+				if (selected == Command::FLAG) {
+					exitStr = "f";
+				}
+				else if (selected == Command::CHORD) {
+					exitStr = "c";
+				}
+				screen << "Press (" << exitStr << ") to cancel selection." << std::endl;
+				present();
+			}
+			int xOffset = 0, yOffset = 0;
+			char input = hackThatInput;
+			if (!input) {
+				input = STEP_AWAIT nextKey(SessionPrompt::TARGET);
+			}
+			switch (input) {
+			case 10: // lunux enter (linefeed)
+			case 13: // windows enter (return)
+				goto finishSelection;
+				break;
+			case 'r':
+			case 'f':
+			case 'c':
+			case KEY_CLOSED:
+				selected = Command::INVALID;
+				goto finishSelection;
+				break;
+			case 72:
+			case 'w':
+				yOffset--;
+				break;
+			case 80:
+			case 's':
+				yOffset++;
+				break;
+			case 75:
+			case 'a':
+				xOffset--;
+				break;
+			case 77:
+			case 'd':
+				xOffset++;
+				break;
+			}
+			hackThatInput = 0;
+			Logic::Point newLoc = selection.add(xOffset, yOffset);
+			if (newLoc.x >= 0 && newLoc.y >= 0 && newLoc.x < options.width && newLoc.y < options.height) {
+				selection = newLoc;
+			}
+		}
+	finishSelection:
+		this->selectionMode = SelectionMode::NONE;
+		Logic::Point location = selection;
+#endif
+		Logic::ActionResult result = Logic::ActionResult::INVALID;
+		history.push_back(game.snapshot());
+		if (selected == Command::REVEAL) {
+			result = game.clickSpace(location);
+		}
+		else if (selected == Command::FLAG) {
+			result = game.flagSpace(location);
+		}
+		else if (selected == Command::CHORD) {
+			result = game.chordSpace(location);
+		}
+		if (result != Logic::ActionResult::OK && result != Logic::ActionResult::EXPLODED) {
+			history.pop_back(); // nothing changed, so there is nothing to undo
+		}
+		else if (advisor) {
+			advisor->moved(location);
+		}
+		drawBoard(game);
+		if (result == Logic::ActionResult::ALREADY_REVEALED) {
+			screen << "That square could not be revealed since it isn't hidden!" << std::endl;
+		}
+		else if (result == Logic::ActionResult::NO_FLAGS) {
+			screen << "That square could not be flagged as you have no remaining flags!" << std::endl;
+		}
+		else if (result == Logic::ActionResult::NOT_HIDDEN) {
+			screen << "That square could not be flagged as it is already revealed!" << std::endl;
+		}
+		else if (result == Logic::ActionResult::NOT_REVEALED) {
+			screen << "That square could not be chorded since it isn't revealed!" << std::endl;
+		}
+		else if (result == Logic::ActionResult::NOT_SATISFIED) {
+			screen << "That square could not be chorded as its number doesn't match the adjacent flags!" << std::endl;
+		}
+		else if (result == Logic::ActionResult::INVALID && selected == Command::FLAG && game.isFirstMove()) {
+			screen << "Squares can only be flagged after the first reveal!" << std::endl;
+		}
+		STEP_RETURN;
+	}
+
+	/* Function Name: showHint()
+	 *
+	 * Function Description:
+	 * This function suggests a move. Certain moves come from the solver, otherwise a quarter
+	 * second of sampling picks the safest square. The selection is moved onto the suggestion
+	 *
+	 * Parameters:
+	 * The game parameter is passed by reference
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::showHint(Logic::Game& game) {
+		Logic::PlayerView view(game.getBoard());
+		Logic::Hint hint = Logic::Solver(view).findHint();
+		int samples = 0;
+		if (!hint.certain && hint.action == Logic::HintAction::REVEAL) {
+			Logic::SampleEstimate estimate = Logic::MineSampler(view, game.getLoop().getScheduler()).estimate(250);
+			if (estimate.samples > 0) {
+				hint = estimate.bestMove(view);
+				samples = estimate.samples;
+			}
+		}
+		drawBoard(game);
+		if (hint.action == Logic::HintAction::NONE) {
+			screen << "There is no move to suggest." << std::endl;
+			return;
+		}
+		selection = hint.location;
+		const char* action = hint.action == Logic::HintAction::FLAG ? "flag" : hint.action == Logic::HintAction::CHORD ? "chord" : "reveal";
+		screen << "Hint: " << action << " the square at (" << hint.location.x + 1 << ", " << hint.location.y + 1 << ")";
+		if (hint.certain) {
+			screen << ", it is certain." << std::endl;
+		}
+		else {
+			screen << std::setprecision(1) << std::fixed << ", it has a " << hint.mineProbability * 100 << "% chance of being a bomb";
+			if (samples > 0) {
+				screen << " (" << samples << " sampled layouts)";
+			}
+			screen << "." << std::endl;
+		}
+	}
+
+	/* Function Name: showOdds()
+	 *
+	 * Function Description:
+	 * This function suggests the safest square and the square expected to open the most, from the chances
+	 * the advisor keeps up to date. The advisor is made the first time, so a game without the hint never pays
+	 * for it. The selection is moved onto the safest square
+	 *
+	 * Parameters:
+	 * The game parameter is passed by reference
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::showOdds(Logic::Game& game) {
+		auto start = std::chrono::steady_clock::now();
+		if (!advisor) {
+			advisor.reset(new Logic::Advisor(game.getBoard()));
+		}
+		double expected = 0.0;
+		Logic::Hint safest = advisor->safest();
+		Logic::Hint revealing = advisor->mostRevealing(expected);
+		long long elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		drawBoard(game);
+		if (safest.action == Logic::HintAction::NONE) {
+			screen << "There is no move to suggest." << std::endl;
+			return;
+		}
+		selection = safest.location;
+		screen << std::setprecision(1) << std::fixed;
+		screen << "Safest: (" << safest.location.x + 1 << ", " << safest.location.y + 1 << ") with a "
+			<< safest.mineProbability * 100 << "% chance of being a bomb." << std::endl;
+		screen << "Most revealing: (" << revealing.location.x + 1 << ", " << revealing.location.y + 1 << ") opening about "
+			<< expected << " squares with a " << revealing.mineProbability * 100 << "% chance of being a bomb." << std::endl;
+		screen << "Worked out in " << elapsed << " microseconds." << std::endl;
+	}
+
+	constexpr int minWH = 4;
+	constexpr int maxWH = 50;
+	constexpr int minMines = 2;
+
+	// OptionsSelector: Trivial virtual destructor
+	OptionsSelector::~OptionsSelector() {}
+
+	/* Function Name: promptForOptions()
+	 *
+	 * Function Description:
+	 * This function prompts for all options and handles them. Returns true if it is a proper input
+	 *
+	 *
+	 * return value:
+	 * options
+	 */
+	Logic::GameOptions ConsoleOptionsSelector::promptForOptions() {
+		Logic::GameOptions options;
+		options.minePlacerType = Logic::MinePlacerType::RANDOM;
+		std::cout << std::endl << " == New Game Options == " << std::endl;
+		do {
+			std::cout << "Please enter a board width (" << minWH << "-" << maxWH << "): ";
+			std::cin >> options.width;
+			std::cin.clear();
+			std::cin.ignore(100000, '\n');
+			if (options.width < minWH || options.width > maxWH) {
+				std::cout << "Please choose a width between " << minWH << " and " << maxWH << "." << std::endl;
+			}
+		} while (options.width < minWH || options.width > maxWH);
+		do {
+			std::cout << "Please enter a board height (" << minWH << "-" << maxWH << "): ";
+			std::cin >> options.height;
+			std::cin.clear();
+			std::cin.ignore(100000, '\n');
+			if (options.height < minWH || options.height > maxWH) {
+				std::cout << "Please choose a height between " << minWH << " and " << maxWH << "." << std::endl;
+			}
+		} while (options.height < minWH || options.height > maxWH);
+		int maxMines = options.width * options.height - 10; // buffer starting area
+		do {
+			std::cout << "Please enter a mine count (" << minWH << "-" << maxMines << ", recommended: " << static_cast<int>(maxMines * 0.12) << "): ";
+			std::cin >> options.mines;
+			std::cin.clear();
+			std::cin.ignore(100000, '\n');
+			if (options.mines < minMines || options.mines > maxMines) {
+				std::cout << "Please choose a mine count between " << minMines << " and " << maxMines << "." << std::endl;
+			}
+		} while (options.mines < minMines || options.mines > maxMines);
+		return options;
+	}
+
+	/* Function Name: displayMenu()
+	 *
+	 * Function Description:
+	 * This function shows the main menu until Exit is chosen, running the menu step on the keyboard
+	 *
+	 * Parameters:
+	 * The loop parameter is passed by reference
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::displayMenu(Logic::GameLoop& loop) {
+		drive(menu(loop));
+	}
+
+	/* Function Name: menu()
+	 *
+	 * Function Description:
+	 * This step is the main menu. From it a game is started or resumed, the options changed, or the statistics
+	 * and rules read, until Exit is chosen or nothing more can be typed
+	 *
+	 * Parameters:
+	 * The loop parameter keeps the statistics
+	 *
+	 * return value:
+	 * the step
+	 */
+	SessionTask ConsoleRenderer::menu(Logic::GameLoop& loop) {
+		constexpr const char* menuOptions[MENU_ITEMS] = { "Start Game ", "Resume Game", "Options    ", "Statistics ", "Rules      ", "Exit       " };
+		while (true) {
+			menuSelected = 0;
+			while (true) {
+				clear();
+				out << std::endl << WHITE_BOLD << " Minesweeper - Main Menu" << RESET << std::endl << std::endl;
+				for (int index = 0; index < MENU_ITEMS; index++) {
+					std::string result;
+					if (index == menuSelected) {
+						result += YELLOW_HILIGHT;
+						result += "=== ";
+					}
+					else {
+						result += "--- ";
+					}
+					result += menuOptions[index];
+					if (index == menuSelected) {
+						result += " === ";
+					}
+					else {
+						result += " --- ";
+					}
+					result += RESET;
+					out << result << std::endl;
+				}
+				out << std::endl << "Navigate the menu using the (w, s) keys, and make a selection by pressing (ENTER)." << std::endl << std::endl;
+				out << "(C) 2019" << std::endl;
+				out << "Game by [redacted for github] and [redacted for github]" << std::endl;
+				char key = STEP_AWAIT nextKey(SessionPrompt::MENU);
+				switch (key) {
+				case 72:
+				case 'w':
+					if (menuSelected == 0) {
+						break;
+					}
+					menuSelected--;
+					break;
+				case 80:
+				case 's':
+					if (menuSelected == MENU_ITEMS - 1) {
+						break;
+					}
+					menuSelected++;
+					break;
+				case 10: // lunux enter (linefeed)
+				case 13: // windows enter (return)
+					goto finishSelection;
+					break;
+				case KEY_CLOSED:
+					menuSelected = MENU_ITEMS - 1; // Exit
+					goto finishSelection;
+					break;
+				}
+			}
+		finishSelection:;
+			switch (menuSelected) {
+			case 0:
+			{ // Scope for some c++ transfer of control bypasses initialization
+				Logic::GameOptions seeded = options;
+				seeded.seed = nextSeed();
+				history.clear(); // the snapshots and the advisor still point into the arena
+				advisor.reset();
+				arena.reset();
+				Logic::Game game(loop, seeded, &arena);
+				selection = Logic::Point(0, 0);
+				STEP_AWAIT play(loop, game);
+				STEP_AWAIT result(SessionPrompt::RESULT);
+			}
+			break;
+			case 1:
+			{
+				std::unique_ptr<Logic::Game> game;
+				clear();
+				if (!loadGame(loop, game)) {
+					out << "There is no saved game to resume." << std::endl;
+					STEP_AWAIT result(SessionPrompt::PAGE);
+				}
+				else {
+					selection = Logic::Point(0, 0);
+					STEP_AWAIT play(loop, *game);
+					if (game->getState() != Logic::GameState::PLAYING) {
+						removeSave();
+					}
+					STEP_AWAIT result(SessionPrompt::RESULT);
+				}
+			}
+			break;
+			case 2:
+				STEP_AWAIT editOptions();
+				break;
+			case 3:
+				clear();
+				displayStats(loop);
+				STEP_AWAIT result(SessionPrompt::PAGE);
+				break;
+			case 4:
+				// Rules from http://www.freeminesweeper.org/help/minehelpinstructions.html
+				clear();
+				out << "A squares \"neighbours\" are the squares adjacent above, below, left, right, and all 4 diagonals." << std::endl;
+				out << "Squares on the sides of the board or in a corner have fewer neighbors. "
+					<< "The board does not wrap around the edges, unless you pick another board shape in the options:" << std::endl;
+				out << "   Torus: the edges wrap around, so every square has 8 neighbours." << std::endl;
+				out << "   Hex: odd rows sit half a square to the right and each square has the 6 neighbours touching it." << std::endl;
+				out << "   Knight: the neighbours are the 8 squares a chess knight could jump to." << std::endl;
+				out << "If you open a square with 0 neighboring bombs, all its neighbors will automatically open."
+					<< "This can cause a large area to automatically open." << std::endl;
+				out << "The first square you open is never a bomb." << std::endl;
+				out << "Chording a number that already has that many flags around it opens all of its other neighbours at once. "
+					<< "If one of those flags is wrong, a bomb is opened." << std::endl;
+				out << "If you mark a bomb incorrectly, you will have to correct the mistake before you can win. "
+					<< "Incorrect bomb marking doesn't kill you, but it can lead to mistakes which do." << std::endl;
+				STEP_AWAIT result(SessionPrompt::PAGE);
+				break;
+			case 5:
+				clear();
+				prompt = SessionPrompt::FINISHED;
+				STEP_RETURN;
+			}
+			if (options.mines >= options.width * options.height) {
+				options.mines = options.width * options.height - 1;
+			}
+		}
+	}
+
+	/* Function Name: editOptions()
+	 *
+	 * Function Description:
+	 * This step is the options menu, where the board size, the mine count and the board shape of the next
+	 * game are changed, until it goes back to the main menu
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * the step
+	 */
+	SessionTask ConsoleRenderer::editOptions() {
+		while (true) {
+			constexpr int maxOptionsSelected = 4;
+			int optionsSelected = 0;
+			while (true) {
+				clear();
+				out << std::endl << WHITE_BOLD << " Options" << RESET << std::endl << std::endl;
+				for (int index = 0; index < maxOptionsSelected + 1; index++) {
+					std::string result;
+					if (index == optionsSelected) {
+						result += YELLOW_HILIGHT;
+						result += "= ";
+					}
+					else {
+						result += "- ";
+					}
+					switch (index) {
+					case 0:
+						result += "Board Width: " + std::to_string(options.width);
+						break;
+					case 1:
+						result += "Board Height: " + std::to_string(options.height);
+						break;
+					case 2:
+						result += "Mine Count: " + std::to_string(options.mines);
+						break;
+					case 3:
+						result += "Board Shape: " + Logic::topologyName(options.topology);
+						break;
+					case 4:
+						result += "Back to Main Menu";
+						break;
+					}
+					result += RESET;
+					out << result << std::endl;
+				}
+				out << std::endl << "Navigate the menu using the (w, s) keys, and make a selection by pressing (ENTER)." << std::endl;
+				out << "Press (q) to return to the main menu." << std::endl;
+				char key = STEP_AWAIT nextKey(SessionPrompt::OPTIONS);
+				switch (key) {
+				case 72:
+				case 'w':
+					if (optionsSelected == 0) {
+						break;
+					}
+					optionsSelected--;
+					break;
+				case 80:
+				case 's':
+					if (optionsSelected == maxOptionsSelected) {
+						break;
+					}
+					optionsSelected++;
+					break;
+				case 10: // lunux enter (linefeed)
+				case 13: // windows enter (return)
+					goto finishOptionsSelection;
+					break;
+				case 'q':
+				case KEY_CLOSED:
+					STEP_RETURN;
+				}
+			}
+		finishOptionsSelection:;
+			const char* valueType = "Undefined";
+			int currentValue = 0;
+			int minValue = 0;
+			int maxValue = 0;
+			int editedValue = -1;
+			switch (optionsSelected) {
+			case 0:
+				valueType = "Board Width";
+				minValue = 3;
+				maxValue = 50;
+				currentValue = options.width;
+				break;
+			case 1:
+				valueType = "Board Height";
+				minValue = 3;
+				maxValue = 50;
+				currentValue = options.height;
+				break;
+			case 2:
+				valueType = "Mine Count";
+				minValue = 2;
+				maxValue = (options.width * options.height) - 8;
+				if (maxValue < minValue) {
+					maxValue = minValue;
+				}
+				currentValue = options.mines;
+				break;
+			case 3: // there are only a few shapes, so ENTER moves on to the next one
+				options.topology = static_cast<Logic::Topology>((static_cast<int>(options.topology) + 1) % 4);
+				continue;
+			case 4:
+				STEP_RETURN;
+			}
+			clear();
+			out << "You are editing the option \"" << valueType << "\". Current value: " << currentValue << std::endl;
+			STEP_AWAIT enterValue(editedValue, minValue, maxValue);
+			if (editedValue < 0) {
+				STEP_RETURN; // the main menu reads KEY_CLOSED next and exits
+			}
+			switch (optionsSelected) {
+			case 0:
+				options.width = editedValue;
+				break;
+			case 1:
+				options.height = editedValue;
+				break;
+			case 2:
+				options.mines = editedValue;
+			}
+		}
+	}
+
+	/* Function Name: enterValue()
+	 *
+	 * Function Description:
+	 * This step reads a number a key at a time, echoing the digits, until (ENTER) is pressed on a number in range.
+	 * (BACKSPACE) takes back a digit and other keys are ignored
+	 *
+	 * Parameters:
+	 * The value parameter receives the number, or -1 once nothing more can be typed
+	 * The minValue and maxValue parameters are the range
+	 *
+	 * return value:
+	 * the step
+	 */
+	SessionTask ConsoleRenderer::enterValue(int& value, int minValue, int maxValue) {
+		while (true) {
+			out << "Please enter a value between " << minValue << " and " << maxValue << ": " << std::flush;
+			std::string typed;
+			while (true) {
+				char key = STEP_AWAIT nextKey(SessionPrompt::VALUE);
+				if (key == KEY_CLOSED) {
+					out << std::endl;
+					value = -1;
+					STEP_RETURN;
+				}
+				if (key >= '0' && key <= '9' && typed.size() < 9) {
+					typed += key;
+					out << key << std::flush;
+				}
+				else if ((key == 8 || key == 127) && !typed.empty()) {
+					typed.pop_back();
+					out << "\b \b" << std::flush;
+				}
+				else if ((key == 10 || key == 13) && !typed.empty()) {
+					break;
+				}
+			}
+			out << std::endl;
+			value = std::stoi(typed);
+			if (value >= minValue && value <= maxValue) {
+				STEP_RETURN;
+			}
+			out << "That value was out of range." << std::endl;
+		}
+	}
+
+	// result(): waits for (ENTER) after a game or a page, to go back to the main menu
+	SessionTask ConsoleRenderer::result(SessionPrompt prompt) {
+		out << std::endl << "Press (ENTER) to return to the main menu." << std::endl;
+		while (true) {
+			char key = STEP_AWAIT nextKey(prompt);
+			if (key == 10 || key == 13 || key == KEY_CLOSED) {
+				STEP_RETURN;
+			}
+		}
+	}
+
+	/* Function Name: promptPlayAgain()
+	 *
+	 * Function Description:
+	 * This function prompts if user wants to play again
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * bool
+	 */
+	bool ConsoleRenderer::promptPlayAgain() {
+		out << std::endl << "Would you like to play again? (y/n): ";
+		int state = -1;
+		while (state == -1) {
+			char input = readKey();
+			switch (input) {
+			case 'y':
+				state = 1;
+				break;
+			case 'n':
+			case KEY_CLOSED:
+				state = 0;
+				break;
+			default:
+				out << "Please type (y) or (n)." << std::endl;
+				break;
+			}
+		}
+		clear();
+		return state;
+	}
+
+	/* Function Name: displayStats()
+	 *
+	 * Function Description:
+	 * This function displays the stats of past games
+	 *
+	 * Parameters:
+	 * The loop parameter is passed by reference
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::displayStats(Logic::GameLoop& loop) {
+		int gamesPlayed = loop.getWins() + loop.getLosses();
+		out << " == Player Stats == " << std::endl;
+		out << "Total spaces revealed: " << loop.getRevealed() << std::endl;
+		out << "Total mines exploded: " << loop.getExploded() << std::endl;
+		out << "Total spaces flagged: " << loop.getFlagged() << std::endl;
+		out << std::endl;
+		out << "Total games: " << gamesPlayed << std::endl;
+		out << "Total wins: " << loop.getWins() << std::endl;
+		out << "Total losses: " << loop.getLosses() << std::endl;
+		out << std::endl;
+		if (gamesPlayed > 0) {
+			out << std::setprecision(2) << std::fixed;
+			out << "Win percentage: " << (loop.getWins() / static_cast<double>(gamesPlayed)) * 100 << "%" << std::endl;
+			if (loop.getWinTimes().size() > 0) {
+				int64_t totalTime = 0;
+				for (int64_t time : loop.getWinTimes()) {
+					totalTime += time;
+				}
+				out << "Average time to win: " << (totalTime / static_cast<double>(loop.getWinTimes().size())) << " seconds" << std::endl;
+			}
+			out << "Loss percentage: " << (loop.getLosses() / static_cast<double>(gamesPlayed)) * 100 << "%" << std::endl;
+			if (loop.getLossTimes().size() > 0) {
+				int64_t totalTime = 0;
+				for (int64_t time : loop.getLossTimes()) {
+					totalTime += time;
+				}
+				out << "Average time to loss: " << (totalTime / static_cast<double>(loop.getLossTimes().size())) << " seconds" << std::endl;
+			}
+			out << std::endl;
+		}
+	}
+
+	/* Function Name: playGame()
+	 *
+	 * Function Description:
+	 * This funstion plays the game, running the play step on the keyboard
+	 *
+	 * Parameters:
+	 * The loop parameter is passed by reference
+	 * The game parameter is passed by reference
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::playGame(Logic::GameLoop& loop, Logic::Game& game) {
+		drive(play(loop, game));
+	}
+
+	/* Function Name: play()
+	 *
+	 * Function Description:
+	 * This step plays a game a turn at a time until it is won, lost or left, and counts it in the statistics
+	 *
+	 * Parameters:
+	 * The loop parameter keeps the statistics
+	 * The game parameter is the game to play
+	 *
+	 * return value:
+	 * the step
+	 */
+	SessionTask ConsoleRenderer::play(Logic::GameLoop& loop, Logic::Game& game) {
+		history.clear();
+		advisor.reset();
+		playing = &game;
+		gamesStarted++;
+		leaving = false;
+		drawBoard(game);
+		while (game.getState() == Logic::GameState::PLAYING && !leaving) {
+			STEP_AWAIT turn(game);
+		}
+		playing = nullptr;
+		present();
+		if (writer) {
+			writer->flush(); // the rest goes straight to the terminal
+		}
+		if (game.getState() == Logic::GameState::WIN) {
+			loop.addWin(Logic::currentTimeSeconds() - game.getStartTime());
+			out << R"( __   __           __        ___       _ )" << std::endl;
+			out << R"( \ \ / /__  _   _  \ \      / (_)_ __ | |)" << std::endl;
+			out << R"(  \ V / _ \| | | |  \ \ /\ / /| | '_ \| |)" << std::endl;
+			out << R"(   | | (_) | |_| |   \ V  V / | | | | |_|)" << std::endl;
+			out << R"(   |_|\___/ \__,_|    \_/\_/  |_|_| |_(_))" << std::endl;
+		}
+		else if (game.getState() == Logic::GameState::LOSS) {
+			loop.addLoss(Logic::currentTimeSeconds() - game.getStartTime());
+			if (game.getBoard().isDamaged()) {
+				out << "The saved game turned out to be damaged, so it has ended." << std::endl;
+			}
+			out << R"( __   __            _              _   )" << std::endl;
+			out << R"( \ \ / /__  _   _  | |    ___  ___| |_ )" << std::endl;
+			out << R"(  \ V / _ \| | | | | |   / _ \/ __| __|)" << std::endl;
+			out << R"(   | | (_) | |_| | | |__| (_) \__ \ |_ )" << std::endl;
+			out << R"(   |_|\___/ \__,_| |_____\___/|___/\__|)" << std::endl;
+		}
+		STEP_RETURN;
+	}
+
+	inline void ConsoleRenderer::clear() {
+		if (terminal || session) {
+			out << "\u001b[H\u001b[2J"; // what clear writes, without starting it
+			return;
+		}
+#ifdef windows
+		system("cls");
+#elif defined(bash)
+		system("clear");
+#endif
+	}
+
+	inline char getCharacter() {
+		TRACE_SCOPE(scope, "input wait", nullptr);
+		char result;
+#if defined(windows)
+		result = -32;
+		while (result == -32) {
+			result = static_cast<char>(_getch());
+		}
+#elif defined(bash)
+		// https://stackoverflow.com/a/9547954/4634429
+		struct termios old_tio, new_tio;
+		tcgetattr(STDIN_FILENO, &old_tio);
+		new_tio = old_tio;
+		new_tio.c_lflag &= (~ICANON & ~ECHO);
+		tcsetattr(STDIN_FILENO, TCSANOW, &new_tio);
+		int key = getchar();
+		tcsetattr(STDIN_FILENO, TCSANOW, &old_tio);
+		result = key == EOF ? KEY_CLOSED : static_cast<char>(key);
+#else
+		std::string buffer;
+		std::cin >> buffer;
+		if (std::cin.eof() && buffer.empty()) {
+			result = KEY_CLOSED;
+		}
+		else if (buffer.size() == 0) {
+			result = 0;
+		}
+		else {
+			result = buffer.at(0);
+		}
+#endif
+		return result;
+	}
+
+	/* Function Name: present()
+	 *
+	 * Function Description:
+	 * This function puts the screen on the terminal, through the frame writer where the terminal
+	 * understands cursor movement and directly otherwise. A session writes straight to its stream
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void ConsoleRenderer::present() {
+		std::string text = screen.str();
+		if (hasAdvancedRendering() && !session) {
+			if (!writer) {
+				writer.reset(new FrameWriter(terminal));
+			}
+			writer->publish(text);
+		}
+		else {
+			if (presented == 0) {
+				clear();
+			}
+			out << text.substr(presented) << std::flush;
+		}
+		presented = text.size();
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: FrameWriter
+	/////////////////////////////////////////////
+
+	FrameWriter::FrameWriter(ScriptedTerminal* terminal)
+		: back(0), front(1), middle(2), sequence(0), written(0), running(true), sleeping(false), stale(true), settling(false), terminal(terminal) {
+		thread = std::thread(&FrameWriter::run, this);
+		if (terminal) {
+			terminal->watch(this);
+		}
+	}
+
+	FrameWriter::~FrameWriter() {
+		if (terminal) {
+			terminal->forget(this);
+		}
+		running.store(false);
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			wake.notify_one();
+		}
+		thread.join();
+	}
+
+	/* Function Name: publish()
+	 *
+	 * Function Description:
+	 * This function hands a frame to the writer. It never waits: if the writer has not taken the
+	 * last frame yet, that frame is dropped for this one
+	 *
+	 * Parameters:
+	 * The text parameter is the whole screen
+	 *
+	 * return value:
+	 * none
+	 */
+	void FrameWriter::publish(std::string text) {
+		frames[back].text = std::move(text);
+		frames[back].sequence = ++sequence;
+		int previous = middle.exchange(back | FRESH);
+		back = previous & (FRESH - 1);
+		if (previous & FRESH) {
+			TRACE_COUNTER("dropped frames", 1);
+		}
+		if (sleeping.load()) { // only an idle writer is woken, so this lock is never held across a write
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			wake.notify_one();
+		}
+	}
+
+	// settle(): waits for the last frame published to be on the terminal, woken by the writer once it is
+	void FrameWriter::settle() {
+		if (written.load() == sequence) {
+			return;
+		}
+		std::unique_lock<std::mutex> lock(settleMutex);
+		settling.store(true); // the writer checks this after each frame, so either it wakes us or we see the frame
+		settled.wait(lock, [this]() { return written.load() == sequence; });
+		settling.store(false);
+	}
+
+	/* Function Name: flush()
+	 *
+	 * Function Description:
+	 * This function waits for the last frame published to be on the terminal, so the caller can write
+	 * to it directly. The next frame is then drawn in full
+	 *
+	 * Parameters:
+	 * none
+	 *
+	 * return value:
+	 * none
+	 */
+	void FrameWriter::flush() {
+		settle();
+		stale.store(true);
+	}
+
+	// run(): the writer thread, writes the newest frame whenever there is one
+	void FrameWriter::run() {
+		while (true) {
+			bool stopping = !running.load();
+			if (middle.load() & FRESH) {
+				front = middle.exchange(front) & (FRESH - 1);
+				write(frames[front].text);
+				written.store(frames[front].sequence);
+				if (settling.load()) {
+					std::lock_guard<std::mutex> lock(settleMutex);
+					settled.notify_one();
+				}
+				continue;
+			}
+			if (stopping) {
+				return;
+			}
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleeping.store(true);
+			if (!(middle.load() & FRESH) && running.load()) {
+				wake.wait(lock);
+			}
+			sleeping.store(false);
+		}
+	}
+
+	/* Function Name: write()
+	 *
+	 * Function Description:
+	 * This function puts a frame on the terminal. Lines that are already on the screen in the same place
+	 * are skipped, the others are written over. The last line is always written, which leaves the cursor
+	 * where the frame ends. If the frame is taller than the terminal, or what is on the screen is not
+	 * known, the whole frame is written from the top left corner
+	 *
+	 * Parameters:
+	 * The text parameter is the frame
+	 *
+	 * return value:
+	 * none
+	 */
+	void FrameWriter::write(const std::string& text) {
+		TRACE_SCOPE(scope, "write frame", "bytes");
+		std::vector<std::string> lines;
+		std::istringstream in(text);
+		for (std::string line; std::getline(in, line);) {
+			lines.push_back(line);
+		}
+		if (text.empty() || text.back() == '\n') {
+			lines.emplace_back();
+		}
+		int columns = 0, rows = 0;
+		bool sized = terminal ? terminal->getSize(columns, rows) : getTerminalSize(columns, rows);
+		std::vector<int> starts(lines.size());
+		int row = 1;
+		for (size_t index = 0; index < lines.size(); index++) {
+			starts[index] = row;
+			int length = 0; // columns taken, not counting colour changes
+			for (size_t at = 0; at < lines[index].size(); at++) {
+				if (lines[index][at] == '\u001b') {
+					while (++at < lines[index].size() && !(lines[index][at] >= '@' && lines[index][at] <= '~' && lines[index][at] != '['));
 					continue;
 				}
-				Space& space = board.getSpaceAt(access);
-				if (space.getType() == SpaceType::MINE || space.getType() == SpaceType::FLAGGED_MINE) {
-					count++;
-				}
+				length += (lines[index][at] & 0xc0) != 0x80;
+			}
+			row += sized ? std::max(1, (length + columns - 1) / columns) : 1;
+		}
+		bool full = stale.exchange(false) || !sized || row > rows;
+		std::string output = full ? "\u001b[H" : "";
+		for (size_t index = 0; index < lines.size(); index++) {
+			bool last = index + 1 == lines.size();
+			if (full) {
+				output += lines[index];
+				output += last ? "\u001b[J" : "\u001b[K\n";
+			}
+			else if (last || index >= shown.size() || shown[index] != lines[index] || shownRows[index] != starts[index]) {
+				output += "\u001b[" + std::to_string(starts[index]) + ";1H" + lines[index] + (last ? "\u001b[J" : "\u001b[K");
 			}
 		}
+		std::cout << output << std::flush;
+		shown.swap(lines);
+		shownRows.swap(starts);
+		TRACE_VALUE(scope, output.size());
+		TRACE_COUNTER("frame bytes", output.size());
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: ScriptedTerminal
+	/////////////////////////////////////////////
+
+	TerminalSink::TerminalSink() : bytes(0) {}
+
+	TerminalSink::int_type TerminalSink::overflow(int_type character) {
+		if (!traits_type::eq_int_type(character, traits_type::eof())) {
+			bytes.fetch_add(1, std::memory_order_relaxed);
+		}
+		return traits_type::not_eof(character);
+	}
+
+	std::streamsize TerminalSink::xsputn(const char*, std::streamsize count) {
+		bytes.fetch_add(static_cast<uint64_t>(count), std::memory_order_relaxed);
 		return count;
 	}
 
-	/* Function Name: click()
+	uint64_t TerminalSink::getBytes() {
+		return bytes.load(std::memory_order_relaxed);
+	}
+
+	ScriptedTerminal::ScriptedTerminal(std::streambuf& script, TerminalSink& sink, int columns, int rows, uint64_t seed)
+		: script(script), sink(sink), columns(columns), rows(rows), seed(seed), waiting(false), bytesBefore(0) {}
+
+	/* Function Name: nextKey()
 	 *
 	 * Function Description:
-	 * This function updates the state after the the point is chosen
+	 * This function hands the game the next key of the script. The frames of the key before it are
+	 * waited for first, and its latency and bytes recorded
 	 *
 	 * Parameters:
 	 * none
 	 *
 	 * return value:
-	 * true if someting was updated, false if not
+	 * the key, or KEY_CLOSED once the script has run out
 	 */
-	inline bool Space::click() {
-		if (type == SpaceType::MINE) {
-			board.getGame().getLoop().addExploded();
-			for (std::vector<Space>& row : board.getCols()) {
-				for (Space& space : row) {
-					if (space.getType() == SpaceType::MINE) {
-						space.setType(SpaceType::EXPLODED_MINE);
-					}
-					if (space.getType() == SpaceType::EMPTY || space.getType() == SpaceType::FALSE_FLAG) {
-						space.setType(SpaceType::REVEALED);
-					}
-				}
+	char ScriptedTerminal::nextKey() {
+		finish();
+		std::streambuf::int_type key = script.sbumpc();
+		if (std::streambuf::traits_type::eq_int_type(key, std::streambuf::traits_type::eof())) {
+			return KEY_CLOSED; // not recorded, the game is only being backed out of
+		}
+		records.push_back(KeyRecord{ static_cast<char>(key), 0, 0 });
+		waiting = true;
+		bytesBefore = sink.getBytes();
+		handedOut = std::chrono::steady_clock::now();
+		return static_cast<char>(key);
+	}
+
+	// finish(): records the key handed out last, once its frames are on the terminal
+	void ScriptedTerminal::finish() {
+		if (!waiting) {
+			return;
+		}
+		for (FrameWriter* writer : writers) {
+			writer->settle();
+		}
+		KeyRecord& record = records.back();
+		record.nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - handedOut).count();
+		record.bytes = sink.getBytes() - bytesBefore;
+		waiting = false;
+	}
+
+	bool ScriptedTerminal::getSize(int& columns, int& rows) {
+		columns = this->columns;
+		rows = this->rows;
+		return true;
+	}
+
+	// nextSeed(): the seed for the next game, so a script plays the same boards every time
+	uint64_t ScriptedTerminal::nextSeed() {
+		return seed++;
+	}
+
+	void ScriptedTerminal::watch(FrameWriter* writer) {
+		writers.push_back(writer);
+	}
+
+	void ScriptedTerminal::forget(FrameWriter* writer) {
+		writers.erase(std::remove(writers.begin(), writers.end(), writer), writers.end());
+	}
+
+	/* Function Name: report()
+	 *
+	 * Function Description:
+	 * This function writes the latency percentiles and the bytes written per key. Keys that only
+	 * leave a menu are counted too, so a script measures whatever it walks through
+	 *
+	 * Parameters:
+	 * The out parameter is the stream to write to
+	 *
+	 * return value:
+	 * none
+	 */
+	void ScriptedTerminal::report(std::ostream& out) {
+		std::vector<int64_t> latencies;
+		uint64_t bytes = 0, most = 0;
+		for (KeyRecord& record : records) {
+			latencies.push_back(record.nanos);
+			bytes += record.bytes;
+			most = std::max(most, record.bytes);
+		}
+		out << records.size() << " keys on a " << columns << "x" << rows << " terminal, " << bytes << " bytes written" << std::endl;
+		if (records.empty()) {
+			return;
+		}
+		std::sort(latencies.begin(), latencies.end());
+		auto percentile = [&latencies](double part) {
+			return latencies[std::min(latencies.size() - 1, static_cast<size_t>(part * static_cast<double>(latencies.size())))] / 1000.0;
+		};
+		double total = 0;
+		for (int64_t latency : latencies) {
+			total += static_cast<double>(latency);
+		}
+		out << std::fixed << std::setprecision(1) << "Latency: mean " << total / static_cast<double>(latencies.size()) / 1000.0 << " us, p50 " << percentile(0.5)
+			<< " us, p90 " << percentile(0.9) << " us, p99 " << percentile(0.99) << " us, max " << latencies.back() / 1000.0 << " us" << std::endl;
+		out << "Bytes: mean " << static_cast<double>(bytes) / static_cast<double>(records.size()) << " per key, max " << most << std::endl;
+	}
+
+	// writeRecords(): one line per key, the key's code, its latency in nanoseconds and its bytes
+	void ScriptedTerminal::writeRecords(std::ostream& out) {
+		out << "key,nanos,bytes\n";
+		for (KeyRecord& record : records) {
+			out << static_cast<int>(static_cast<unsigned char>(record.key)) << "," << record.nanos << "," << record.bytes << "\n";
+		}
+	}
+
+	/* Function Name: getTerminalSize()
+	 *
+	 * Function Description:
+	 * This function asks the terminal how big it is
+	 *
+	 * Parameters:
+	 * The columns and rows parameters receive the size
+	 *
+	 * return value:
+	 * false if the output is not a terminal or its size is unknown
+	 */
+	inline bool getTerminalSize(int& columns, int& rows) {
+#if defined(windows)
+		CONSOLE_SCREEN_BUFFER_INFO info;
+		if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+			return false;
+		}
+		columns = info.srWindow.Right - info.srWindow.Left + 1;
+		rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+		return true;
+#elif defined(bash)
+		struct winsize size;
+		if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) != 0 || size.ws_col == 0 || size.ws_row == 0) {
+			return false;
+		}
+		columns = size.ws_col;
+		rows = size.ws_row;
+		return true;
+#else
+		columns = rows = 0;
+		return false;
+#endif
+	}
+
+	inline bool ConsoleRenderer::hasAdvancedRendering() {
+#if defined(windows) || defined(bash)
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/* Function Name: runScript()
+	 *
+	 * Function Description:
+	 * This function plays the console game from a file of keys, or from standard input, on a terminal of a fixed size
+	 * that only counts what it is sent. It reports the latency and bytes of every key, and writes them per key to a CSV file:
+	 * minesweeper --script <file | -> [seed] [columns] [rows] [csv file]
+	 * For example printf '\nr\nfd\n' | minesweeper --script - starts a game, opens the corner and flags the square beside it
+	 * A game the script quits is saved in memory for the script's own Resume Game, so the save file in the directory is left alone
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runScript(int argc, char** argv) {
+		std::string path = argc > 2 ? argv[2] : "-";
+		uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : 1;
+		int columns = argc > 4 ? atoi(argv[4]) : 100;
+		int rows = argc > 5 ? atoi(argv[5]) : 40;
+		if (seed == 0 || columns < 1 || rows < 1) {
+			std::cout << "Use --script <file | -> [seed] [columns] [rows] [csv file], with a positive seed and size." << std::endl;
+			return 1;
+		}
+		std::ifstream file;
+		if (path != "-") {
+			file.open(path, std::ios::binary);
+			if (!file) {
+				std::cout << "Could not read \"" << path << "\"." << std::endl;
+				return 1;
 			}
-			return true;
 		}
-		if (type == SpaceType::EMPTY) {
-			type = SpaceType::REVEALED;
-			board.getGame().getLoop().addRevealed();
-			if (getAdjacentMines() == 0) {
-				for (std::vector<Space>& row : board.getCols()) {
-					for (Space& space : row) {
-						if (space.adjacentTo(*this)) {
-							space.click();
-						}
-					}
-				}
+		std::streambuf* input = std::cin.rdbuf();
+		if (file.is_open()) {
+			std::cin.rdbuf(file.rdbuf()); // number prompts read the script too
+		}
+		TerminalSink sink;
+		ScriptedTerminal script(*std::cin.rdbuf(), sink, columns, rows, seed);
+		std::streambuf* output = std::cout.rdbuf(&sink);
+		auto started = std::chrono::steady_clock::now();
+		{
+			Logic::GameLoop loop(RenderType::CONSOLE, &script);
+			loop.start(); // once the script runs out, KEY_CLOSED backs the game out to here
+			script.finish();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		std::cout.rdbuf(output);
+		std::cin.rdbuf(input);
+		script.report(std::cout);
+		std::cout << std::fixed << std::setprecision(3) << "Played in " << seconds << " s" << std::endl;
+		if (argc > 6) {
+			std::ofstream csv(argv[6]);
+			script.writeRecords(csv);
+			if (!csv) {
+				std::cout << "Could not write \"" << argv[6] << "\"." << std::endl;
+				return 1;
 			}
-			return true;
 		}
-		return false;
+		return 0;
 	}
 
-	/* Function Name: flag()
+#ifdef coroutines
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Console Session
+	/////////////////////////////////////////////
+
+	// nowhere(): the stream of a session that is not drawn, it drops whatever is written to it
+	std::ostream& nowhere() {
+		static std::ostream stream(nullptr);
+		return stream;
+	}
+
+	/* Function Name: ConsoleRenderer()
 	 *
 	 * Function Description:
-	 * This function updates the state for the flags after the the point is chosen
+	 * This constructs the console of a session, which plays the given options with games seeded one after another,
+	 * and draws to out without a frame writer, or nowhere when out is nullptr
+	 *
+	 * Parameters:
+	 * The options parameter is what Start Game plays
+	 * The seed parameter is the seed of the first game
+	 * The out parameter is the stream to draw to, or nullptr
+	 *
+	 * return value:
+	 * none
+	 */
+	ConsoleRenderer::ConsoleRenderer(Logic::GameOptions options, uint64_t seed, std::ostream* out)
+		: selection(Logic::Point(0, 0)), selectionMode(SelectionMode::NONE), lastAction(SelectionMode::REVEAL), arena(1 << 16), viewOrigin(Logic::Point(0, 0)),
+		presented(0), terminal(nullptr), out(out ? *out : nowhere()), session(true), seed(seed), options(options), prompt(SessionPrompt::MENU),
+		menuSelected(0), gamesStarted(0), playing(nullptr), leaving(false), key(0) {
+		if (out == nullptr) {
+			screen.setstate(std::ios::badbit); // the messages under the board are dropped too
+		}
+	}
+
+	// begin(): keeps a step as the console's task and runs it until it first waits for a key
+	void ConsoleRenderer::begin(SessionTask step) {
+		task = std::move(step);
+		task.start();
+		task.rethrow();
+	}
+
+	/* Function Name: drive()
+	 *
+	 * Function Description:
+	 * This function runs a step to its end on the keyboard, in a scheduler of one session whose keys are typed
+	 * by a KeyboardDriver. This is how the blocking console runs the same steps as --sessions
 	 *
 	 * Parameters:
+	 * The step parameter is the step to run
+	 *
+	 * return value:
 	 * none
+	 */
+	void ConsoleRenderer::drive(SessionTask step) {
+		begin(std::move(step));
+		SessionScheduler scheduler;
+		scheduler.add(*this, std::unique_ptr<SessionDriver>(new KeyboardDriver()));
+		scheduler.run();
+	}
+
+	// start(): begins a session at the main menu, which waits for its first key
+	void ConsoleRenderer::start(Logic::GameLoop& loop) {
+		begin(menu(loop));
+	}
+
+	/* Function Name: feed()
+	 *
+	 * Function Description:
+	 * This function gives the console a key. The step waiting for it runs until it, or a step it starts,
+	 * waits for the next key, or until the console's task is over
+	 *
+	 * Parameters:
+	 * The key parameter is the key
 	 *
 	 * return value:
-	 * true if someting was updated, false if not
+	 * none
 	 */
-	inline bool Space::flag() {
-		if (type == SpaceType::MINE) {
-			board.getGame().getLoop().addFlagged();
-			type = SpaceType::FLAGGED_MINE;
-			return true;
+	void ConsoleRenderer::feed(char key) {
+		std::coroutine_handle<> resumed = waiting;
+		if (!resumed || task.isDone()) {
+			return;
 		}
-		if (type == SpaceType::EMPTY) {
-			board.getGame().getLoop().addFlagged();
-			type = SpaceType::FALSE_FLAG;
-			return true;
+		this->key = key;
+		waiting = nullptr;
+		resumed.resume();
+		task.rethrow();
+	}
+
+	bool ConsoleRenderer::isFinished() {
+		return task.isDone();
+	}
+
+	SessionPrompt ConsoleRenderer::getPrompt() {
+		return prompt;
+	}
+
+	// getGame(): the game being played, nullptr between games
+	Logic::Game* ConsoleRenderer::getGame() {
+		return playing;
+	}
+
+	Logic::Point ConsoleRenderer::getSelection() {
+		return selection;
+	}
+
+	int ConsoleRenderer::getMenuSelected() {
+		return menuSelected;
+	}
+
+	int ConsoleRenderer::getMenuItems() {
+		return MENU_ITEMS;
+	}
+
+	int ConsoleRenderer::getGamesStarted() {
+		return gamesStarted;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Session Drivers
+	/////////////////////////////////////////////
+
+	// SessionDriver: Trivial virtual destructor
+	SessionDriver::~SessionDriver() {}
+
+	char KeyboardDriver::nextKey(ConsoleRenderer& console) {
+		return console.readKey();
+	}
+
+	ScriptDriver::ScriptDriver(std::shared_ptr<const std::string> keys) : keys(keys), position(0) {}
+
+	char ScriptDriver::nextKey(ConsoleRenderer&) {
+		return position < keys->size() ? (*keys)[position++] : 0;
+	}
+
+	BotDriver::BotDriver(std::unique_ptr<Logic::Strategy> strategy, int games) : strategy(std::move(strategy)), gamesLeft(games), gamesSeen(0), position(0) {}
+
+	char BotDriver::nextKey(ConsoleRenderer& console) {
+		if (position == planned.size()) {
+			planned.clear();
+			position = 0;
+			plan(console);
 		}
-		if (type == SpaceType::FALSE_FLAG) {
-			type = SpaceType::EMPTY;
-			return true;
+		return position < planned.size() ? planned[position++] : 0;
+	}
+
+	/* Function Name: plan()
+	 *
+	 * Function Description:
+	 * This function works out the keys for the prompt the console shows: the way to Start Game or Exit in the menu,
+	 * the strategy's move at the command prompt, and (ENTER) after a game
+	 *
+	 * Parameters:
+	 * The console parameter is the console to play
+	 *
+	 * return value:
+	 * none
+	 */
+	void BotDriver::plan(ConsoleRenderer& console) {
+		switch (console.getPrompt()) {
+		case SessionPrompt::MENU:
+		{
+			int target = gamesLeft > 0 ? 0 : console.getMenuItems() - 1; // Start Game, or Exit
+			planned.append(static_cast<size_t>(std::abs(target - console.getMenuSelected())), target < console.getMenuSelected() ? 'w' : 's');
+			planned += '\n';
+			break;
 		}
-		if (type == SpaceType::FLAGGED_MINE) {
-			type = SpaceType::MINE;
-			return true;
+		case SessionPrompt::COMMAND:
+		{
+			Logic::Game& game = *console.getGame();
+			if (console.getGamesStarted() != gamesSeen) {
+				gamesSeen = console.getGamesStarted();
+				strategy->newGame(game.getOptions().seed);
+			}
+			Logic::PlayerView view(game.getBoard());
+			Logic::Hint hint = strategy->nextMove(view);
+			if (hint.action == Logic::HintAction::NONE) {
+				planned = "q";
+				break;
+			}
+			planned += hint.action == Logic::HintAction::FLAG ? 'f' : hint.action == Logic::HintAction::CHORD ? 'c' : 'r';
+			Logic::Point selection = console.getSelection();
+			planned.append(static_cast<size_t>(std::abs(hint.location.x - selection.x)), hint.location.x < selection.x ? 'a' : 'd');
+			planned.append(static_cast<size_t>(std::abs(hint.location.y - selection.y)), hint.location.y < selection.y ? 'w' : 's');
+			planned += '\n';
+			break;
+		}
+		case SessionPrompt::RESULT:
+			gamesLeft--;
+			planned = "\n";
+			break;
+		default:
+			planned = "\n";
+			break;
 		}
-		return false;
 	}
 
-	/* Function Name: adjacentTo()
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Session Scheduler
+	/////////////////////////////////////////////
+
+	SessionScheduler::SessionScheduler() : keys(0), finished(0), stopped(0) {}
+
+	// add(): takes a started console, which is freed when it ends
+	void SessionScheduler::add(std::unique_ptr<ConsoleRenderer> console, std::unique_ptr<SessionDriver> driver) {
+		ConsoleRenderer* started = console.get();
+		ready.push_back(Entry{ started, std::move(console), std::move(driver) });
+	}
+
+	// add(): borrows a started console, which the caller keeps
+	void SessionScheduler::add(ConsoleRenderer& console, std::unique_ptr<SessionDriver> driver) {
+		ready.push_back(Entry{ &console, nullptr, std::move(driver) });
+	}
+
+	/* Function Name: run()
 	 *
 	 * Function Description:
-	 * This function checks if the space is adjacent to the spaces location
+	 * This function plays every console to its end, one key at a time in turn
 	 *
 	 * Parameters:
-	 * The space parameter is the position of the space object on the board
+	 * none
 	 *
 	 * return value:
-	 * if the location is adjacent to the current space
+	 * none
 	 */
-	inline bool Space::adjacentTo(Space space) {
-		return !(*this == space) && (abs(location.x - space.getLocation().x) <= 1 && abs(location.y - space.getLocation().y) <= 1);
+	void SessionScheduler::run() {
+		while (!ready.empty()) {
+			Entry entry = std::move(ready.front());
+			ready.pop_front();
+			char key = entry.driver->nextKey(*entry.console);
+			if (key != 0) {
+				entry.console->feed(key);
+				keys++;
+			}
+			if (key != 0 && !entry.console->isFinished()) {
+				ready.push_back(std::move(entry));
+				continue;
+			}
+			(key != 0 ? finished : stopped)++;
+		}
+	}
+
+	uint64_t SessionScheduler::getKeys() {
+		return keys;
+	}
+
+	int SessionScheduler::getFinished() {
+		return finished;
+	}
+
+	int SessionScheduler::getStopped() {
+		return stopped;
 	}
 
-	/* Function Name: operator == ()
+	/* Function Name: runSessions()
 	 *
 	 * Function Description:
-	 * This function changes the operator == to get location and check against the location
+	 * This function plays many consoles interleaved on this one thread, each driven by a strategy for a number
+	 * of games or by a file of keys, and reports the keys and games per second, and the coroutine frames and
+	 * ConsoleRenderer a session waiting at the menu takes. Its statistics and driver are not counted.
+	 * A single session is drawn as it is played:
+	 * minesweeper --sessions [sessions] [games each] [width] [height] [mines] [first seed] [solver | sampler | random | key file]
 	 *
 	 * Parameters:
-	 * The space parameter is the position of the space object on the board
+	 * The argc and argv parameters are the command line
 	 *
 	 * return value:
-	 * the updated operator
+	 * the process exit code
 	 */
-	inline bool Space::operator == (Space space) {
-		return space.getLocation() == location;
+	int runSessions(int argc, char** argv) {
+		int sessions = argc > 2 ? atoi(argv[2]) : 1000;
+		int games = argc > 3 ? atoi(argv[3]) : 5;
+		Logic::GameOptions options;
+		options.width = argc > 4 ? atoi(argv[4]) : 9;
+		options.height = argc > 5 ? atoi(argv[5]) : 9;
+		options.mines = argc > 6 ? atoi(argv[6]) : 10;
+		options.minePlacerType = Logic::MinePlacerType::RANDOM;
+		uint64_t firstSeed = argc > 7 ? strtoull(argv[7], nullptr, 10) : 1;
+		std::string player = argc > 8 ? argv[8] : "solver";
+		if (sessions < 1 || games < 1 || options.width < 1 || options.height < 1 || options.mines < 0 || firstSeed == 0) {
+			std::cout << "Use --sessions [sessions] [games each] [width] [height] [mines] [first seed] [solver | sampler | random | key file]" << std::endl;
+			return 1;
+		}
+		std::shared_ptr<const std::string> script;
+		if (!Logic::Strategy::create(player)) {
+			std::ifstream file(player, std::ios::binary);
+			if (!file) {
+				std::cout << "\"" << player << "\" is neither a strategy nor a file of keys." << std::endl;
+				return 1;
+			}
+			script = std::make_shared<const std::string>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		}
+		SessionScheduler scheduler;
+		std::vector<std::unique_ptr<Logic::GameLoop>> loops; // the statistics, kept after the sessions are freed
+		size_t framesBefore = SessionTask::getFrameBytes();
+		for (int index = 0; index < sessions; index++) {
+			std::unique_ptr<SessionDriver> driver(script ? static_cast<SessionDriver*>(new ScriptDriver(script))
+				: new BotDriver(Logic::Strategy::create(player), games));
+			loops.emplace_back(new Logic::GameLoop(RenderType::HEADLESS));
+			std::unique_ptr<ConsoleRenderer> console(new ConsoleRenderer(options, firstSeed + static_cast<uint64_t>(index) * static_cast<uint64_t>(games),
+				sessions == 1 ? &std::cout : nullptr));
+			console->start(*loops.back());
+			scheduler.add(std::move(console), std::move(driver));
+		}
+		size_t frameBytes = SessionTask::getFrameBytes() - framesBefore;
+		auto started = std::chrono::steady_clock::now();
+		scheduler.run();
+		int wins = 0, losses = 0;
+		for (std::unique_ptr<Logic::GameLoop>& loop : loops) {
+			wins += loop->getWins();
+			losses += loop->getLosses();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		std::cout << sessions << " sessions on one thread: " << scheduler.getFinished() << " exited, " << scheduler.getStopped() << " ran out of keys" << std::endl;
+		std::cout << wins + losses << " games, " << wins << " won, " << losses << " lost, " << scheduler.getKeys() << " keys in "
+			<< std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+		std::cout << std::setprecision(0) << scheduler.getKeys() / seconds << " keys/s, " << (wins + losses) / seconds << " games/s, "
+			<< frameBytes / sessions << " bytes of coroutine frames and a " << sizeof(ConsoleRenderer) << " byte ConsoleRenderer per session waiting at the menu" << std::endl;
+		return 0;
 	}
+#endif
+}
 
-	/* Function Name: getType()
+#ifdef epoll_server
+namespace Server { // Server class implementations
+	constexpr uint64_t LISTEN_TOKEN = 0;
+	constexpr uint64_t WAKE_TOKEN = 1;
+	constexpr uint64_t FIRST_SESSION_TOKEN = 2;
+	constexpr size_t MAX_LINE = 4096;
+	constexpr int MAX_SIDE = 1024;
+	constexpr size_t MAX_SESSION_ARENA = size_t(1) << 24; // a bigger arena is given back when its client leaves
+	constexpr int MAX_PENDING_HINTS = 1 << 12; // past this HINT is answered BUSY rather than queued
+
+	volatile sig_atomic_t stopRequested = 0;
+
+	void requestStop(int) {
+		stopRequested = 1;
+	}
+
+	inline bool setNonBlocking(int fd) {
+		int flags = fcntl(fd, F_GETFL, 0);
+		return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+	}
+
+	inline int64_t currentTimeNanos() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	const char* resultName(Logic::ActionResult result) {
+		switch (result) {
+		case Logic::ActionResult::OK: return "OK";
+		case Logic::ActionResult::INVALID: return "INVALID";
+		case Logic::ActionResult::NO_FLAGS: return "NO_FLAGS";
+		case Logic::ActionResult::EXPLODED: return "EXPLODED";
+		case Logic::ActionResult::ALREADY_REVEALED: return "ALREADY_REVEALED";
+		case Logic::ActionResult::NOT_HIDDEN: return "NOT_HIDDEN";
+		case Logic::ActionResult::NOT_REVEALED: return "NOT_REVEALED";
+		case Logic::ActionResult::NOT_SATISFIED: return "NOT_SATISFIED";
+		}
+		return "INVALID";
+	}
+
+	const char* stateName(Logic::GameState state) {
+		switch (state) {
+		case Logic::GameState::PLAYING: return "PLAYING";
+		case Logic::GameState::WIN: return "WIN";
+		case Logic::GameState::LOSS: return "LOSS";
+		}
+		return "PLAYING";
+	}
+
+	const char* hintActionName(Logic::HintAction action) {
+		switch (action) {
+		case Logic::HintAction::REVEAL: return "REVEAL";
+		case Logic::HintAction::FLAG: return "FLAG";
+		case Logic::HintAction::CHORD: return "CHORD";
+		default: return "NONE";
+		}
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Address
+	/////////////////////////////////////////////
+
+	Address::Address() : type(AddressType::UNIX), path("/tmp/minesweeper.sock"), port(0) {}
+
+	/* Function Name: parse()
 	 *
 	 * Function Description:
-	 * This function gets the type of space
+	 * This function reads an address of the form "unix:/path/to/socket" or "tcp:port"
 	 *
 	 * Parameters:
-	 * none
+	 * The text parameter is the address to read
+	 * The address parameter receives the result
 	 *
 	 * return value:
-	 * type
+	 * true if the text was a valid address
 	 */
-	inline SpaceType Space::getType() {
-		return type;
+	bool Address::parse(std::string text, Address& address) {
+		if (text.compare(0, 5, "unix:") == 0 && text.size() > 5) {
+			address.type = AddressType::UNIX;
+			address.path = text.substr(5);
+			return address.path.size() < sizeof(sockaddr_un::sun_path);
+		}
+		if (text.compare(0, 4, "tcp:") == 0 && text.size() > 4) {
+			address.type = AddressType::TCP;
+			address.port = atoi(text.c_str() + 4);
+			return address.port > 0 && address.port < 65536;
+		}
+		return false;
 	}
 
-	/* Function Name: getLocation()
+	/* Function Name: listenOn()
 	 *
 	 * Function Description:
-	 * This function gets the location
+	 * This function opens a non-blocking listening socket on the address
 	 *
 	 * Parameters:
 	 * none
 	 *
 	 * return value:
-	 * type
+	 * the socket, or -1 on failure
 	 */
-	inline Point Space::getLocation() {
-		return location;
+	int Address::listenOn() {
+		int fd = -1;
+		if (type == AddressType::UNIX) {
+			fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			sockaddr_un addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+			unlink(path.c_str());
+			if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+				perror("bind");
+				if (fd >= 0) close(fd);
+				return -1;
+			}
+		}
+		else {
+			fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			int reuse = 1;
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+			sockaddr_in addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(static_cast<uint16_t>(port));
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // localhost only
+			if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+				perror("bind");
+				if (fd >= 0) close(fd);
+				return -1;
+			}
+		}
+		if (listen(fd, SOMAXCONN) != 0) {
+			perror("listen");
+			close(fd);
+			return -1;
+		}
+		return fd;
 	}
 
-	/* Function Name: setType()
+	/* Function Name: connectTo()
 	 *
 	 * Function Description:
-	 * This function sets the type of space
+	 * This function connects to the address and makes the socket non-blocking once connected
 	 *
 	 * Parameters:
-	 * The type parameter is the type of space object on the board
+	 * none
 	 *
 	 * return value:
-	 * none
+	 * the socket, or -1 on failure
 	 */
-	inline void Space::setType(SpaceType type) {
-		this->type = type;
+	int Address::connectTo() {
+		int fd = -1;
+		int connected = -1;
+		if (type == AddressType::UNIX) {
+			fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+			sockaddr_un addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sun_family = AF_UNIX;
+			strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+			connected = fd < 0 ? -1 : connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+		}
+		else {
+			fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+			sockaddr_in addr;
+			memset(&addr, 0, sizeof(addr));
+			addr.sin_family = AF_INET;
+			addr.sin_port = htons(static_cast<uint16_t>(port));
+			addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			connected = fd < 0 ? -1 : connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+			int noDelay = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+		}
+		if (connected != 0 || !setNonBlocking(fd)) {
+			if (fd >= 0) close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	std::string Address::toString() {
+		if (type == AddressType::UNIX) {
+			return "unix:" + path;
+		}
+		return "tcp:" + std::to_string(port);
 	}
 
 	/////////////////////////////////////////////
-	// CLASS DEFINITION: Board
+	// CLASS DEFINITION: Session
 	/////////////////////////////////////////////
 
-	/* Function Name: Board()
+	Session::Session() : fd(-1), generation(0), arena(new Logic::GameArena(1 << 16)), hintPending(false), writeBlocked(false), closing(false) {}
+
+	/* Function Name: reset()
 	 *
 	 * Function Description:
-	 * This function creates the board
+	 * This function prepares a recycled session for a newly accepted client
 	 *
 	 * Parameters:
-	 * The options parameter is the options of the board
-	 * The game parameter is the reference to the game class
+	 * The fd parameter is the client socket
 	 *
 	 * return value:
 	 * none
 	 */
-	Board::Board(Game& game, GameOptions options) : game(game), options(options), invalid(*this, Point(-1, -1)) {
-		for (int x = 0; x < options.width; x++) {
-			std::vector<Space> row;
-			for (int y = 0; y < options.height; y++) {
-				Point location(x, y);
-				Space space(*this, location);
-				row.push_back(space);
+	void Session::reset(int fd) {
+		this->fd = fd;
+		generation++;
+		input.clear();
+		output.clear();
+		game.reset();
+		if (arena->getCapacity() > MAX_SESSION_ARENA) {
+			arena.reset(new Logic::GameArena(1 << 16)); // one huge board should not pin its memory to the slot
+		}
+		arena->reset();
+		hintPending = false;
+		writeBlocked = false;
+		closing = false;
+	}
+
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Game Server
+	/////////////////////////////////////////////
+
+	GameServer::GameServer(Logic::GameLoop& loop, Address address, int hintBudget)
+		: loop(loop), address(address), hintBudget(hintBudget), listenFd(-1), epollFd(-1), wakeFd(-1) {
+		this->activeSessions = 0;
+		this->gamesStarted = 0;
+		this->commandsHandled = 0;
+	}
+
+	GameServer::~GameServer() {
+		hints.cancel(); // no hint may complete after the eventfd is closed
+		loop.getScheduler().wait(hints);
+		for (std::unique_ptr<Session>& session : sessions) {
+			if (session->fd >= 0) {
+				close(session->fd);
 			}
-			cols.push_back(row);
 		}
+		if (listenFd >= 0) {
+			close(listenFd);
+			if (address.type == AddressType::UNIX) {
+				unlink(address.path.c_str());
+			}
+		}
+		if (epollFd >= 0) close(epollFd);
+		if (wakeFd >= 0) close(wakeFd);
 	}
 
-	/* Function Name: getSpaceAt()
+	/* Function Name: open()
 	 *
 	 * Function Description:
-	 * This gets the Space type at a location
+	 * This function opens the listening socket and the epoll instance
 	 *
 	 * Parameters:
-	 * The location parameter is a point type
+	 * none
 	 *
 	 * return value:
-	 * space
+	 * true if the server is ready to run
 	 */
-	Space& Board::getSpaceAt(Point location) {
-		if (location.x >= 0 && location.y >= 0 && location.x < options.width && location.y < options.height) {
-			Space& space = cols.at(static_cast<unsigned int>(location.x)).at(static_cast<unsigned int>(location.y));
-			if (space.getLocation() == location) {
-				return space;
-			}
+	bool GameServer::open() {
+		listenFd = address.listenOn();
+		epollFd = epoll_create1(EPOLL_CLOEXEC);
+		wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (listenFd < 0 || epollFd < 0 || wakeFd < 0) {
+			return false;
 		}
-		std::cout << "WARNING: ACCESSED INVALID SPACE AT (" << location.x << ", " << location.y << ")!" << std::endl;
-		return invalid;
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.u64 = LISTEN_TOKEN;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+		event.data.u64 = WAKE_TOKEN;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+		return true;
 	}
 
-	/* Function Name: getUsedFlags()
+	/* Function Name: run()
 	 *
 	 * Function Description:
-	 * This gets the number of flags used
+	 * This function runs the event loop until SIGINT or SIGTERM
 	 *
 	 * Parameters:
 	 * none
 	 *
 	 * return value:
-	 * space
+	 * none
 	 */
-	int Board::getUsedFlags() {
-		int count = 0;
-		for (std::vector<Space>& row : cols) {
-			for (Space& space : row) {
-				if (space.getType() == SpaceType::FALSE_FLAG || space.getType() == SpaceType::FLAGGED_MINE) {
-					count++;
+	void GameServer::run() {
+		std::vector<epoll_event> events(256);
+		while (!stopRequested) {
+			int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 250);
+			if (count < 0 && errno != EINTR) {
+				perror("epoll_wait");
+				return;
+			}
+			for (int index = 0; index < count; index++) {
+				uint64_t token = events[static_cast<size_t>(index)].data.u64;
+				uint32_t flags = events[static_cast<size_t>(index)].events;
+				if (token == LISTEN_TOKEN) {
+					acceptSessions();
+					continue;
+				}
+				if (token == WAKE_TOKEN) {
+					deliverHints();
+					continue;
+				}
+				uint32_t id = static_cast<uint32_t>(token - FIRST_SESSION_TOKEN);
+				if (flags & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {
+					readSession(id);
+				}
+				if ((flags & EPOLLOUT) && sessions[id]->fd >= 0) {
+					flush(id);
 				}
 			}
+			// slots closed during this batch are only reused once no stale events can refer to them
+			freeSessions.insert(freeSessions.end(), closedSessions.begin(), closedSessions.end());
+			closedSessions.clear();
 		}
-		return count;
-	}
-
-	inline Space& Board::getSpaceAt(int x, int y) {
-		Point location(x, y);
-		return getSpaceAt(location);
-	}
-
-	inline GameOptions Board::getOptions() {
-		return options;
-	}
-
-	inline std::vector<std::vector<Space>>& Board::getCols() {
-		return cols;
-	}
-
-	inline Game& Board::getGame() {
-		return game;
-	}
-
-	/////////////////////////////////////////////
-	// CLASS DEFINITION: Game
-	/////////////////////////////////////////////
-
-	Game::Game(GameLoop& loop, GameOptions options) : loop(loop), options(options), board(*this, options) {
-		this->firstMove = true;
-		this->startTime = currentTimeSeconds();
 	}
 
-	/* Function Name: clickSpace()
+	/* Function Name: acceptSessions()
 	 *
 	 * Function Description:
-	 * This determines what happens when you select a space
+	 * This function accepts every pending client and gives each one a session slot
 	 *
 	 * Parameters:
-	 * The location parameter is a point type
+	 * none
 	 *
 	 * return value:
-	 * ActionResult
+	 * none
 	 */
-	ActionResult Game::clickSpace(Point location) {
-		if (firstMove) {
-			this->firstMove = false;
-			if (options.minePlacerType == MinePlacerType::RANDOM) {
-				RandomMinePlacer placer(board);
-				placer.placeMines(location);
+	void GameServer::acceptSessions() {
+		while (true) {
+			int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0) {
+				if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+					perror("accept");
+				}
+				return;
 			}
+			if (address.type == AddressType::TCP) {
+				int noDelay = 1;
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+			}
+			uint32_t id;
+			if (!freeSessions.empty()) {
+				id = freeSessions.back();
+				freeSessions.pop_back();
+			}
+			else {
+				id = static_cast<uint32_t>(sessions.size());
+				sessions.emplace_back(new Session());
+			}
+			sessions[id]->reset(fd);
+			epoll_event event;
+			event.events = EPOLLIN | EPOLLRDHUP;
+			event.data.u64 = id + FIRST_SESSION_TOKEN;
+			epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+			activeSessions++;
 		}
-		Space& target = board.getSpaceAt(location);
-		if (!target.click()) {
-			return ActionResult::ALREADY_REVEALED;
-		}
-		if (target.getType() == SpaceType::EXPLODED_MINE) {
-			return ActionResult::EXPLODED;
-		}
-		return ActionResult::OK;
 	}
 
-	/* Function Name: flagSpace()
+	/* Function Name: readSession()
 	 *
 	 * Function Description:
-	 * This checks if there is a flag placed at a certain location
+	 * This function reads everything available from a client and handles the complete lines
 	 *
 	 * Parameters:
-	 * The location parameter is a point type
+	 * The id parameter is the session slot
 	 *
 	 * return value:
-	 * ActionResult
+	 * none
 	 */
-	ActionResult Game::flagSpace(Point location) {
-		Space& target = board.getSpaceAt(location);
-		if (!target.flag()) {
-			return ActionResult::NOT_HIDDEN;
+	void GameServer::readSession(uint32_t id) {
+		Session& session = *sessions[id];
+		char buffer[4096];
+		while (true) {
+			ssize_t count = read(session.fd, buffer, sizeof(buffer));
+			if (count > 0) {
+				session.input.append(buffer, static_cast<size_t>(count));
+				continue;
+			}
+			if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
+			}
+			if (count < 0 && errno == EINTR) {
+				continue;
+			}
+			closeSession(id); // end of stream or error
+			return;
 		}
-		return ActionResult::OK;
+		if (session.input.size() > MAX_LINE && session.input.find('\n') == std::string::npos) {
+			closeSession(id);
+			return;
+		}
+		processInput(id);
 	}
 
-	/* Function Name: getState()
+	/* Function Name: processInput()
 	 *
 	 * Function Description:
-	 * This checks the state of the game. If there are exploded mines, it returns a loss immediately.
-	 * If all flags are in the correct spot and all have been selected, the player wins
+	 * This function handles buffered command lines in order. It stops while a hint is being
+	 * computed so that replies always come back in the order the commands were sent
 	 *
 	 * Parameters:
-	 * none
+	 * The id parameter is the session slot
 	 *
 	 * return value:
-	 * ActionResult
+	 * none
 	 */
-	GameState Game::getState() {
-		int flags = 0;
-		for (std::vector<Space>& row : board.getCols()) {
-			for (Space& space : row) {
-				if (space.getType() == SpaceType::EXPLODED_MINE) {
-					return GameState::LOSS; // any exploded mine is an instant loss
-				}
-				if (space.getType() == SpaceType::FLAGGED_MINE) {
-					flags++;
-				}
+	void GameServer::processInput(uint32_t id) {
+		Session& session = *sessions[id];
+		size_t consumed = 0;
+		while (!session.hintPending && !session.closing) {
+			size_t end = session.input.find('\n', consumed);
+			if (end == std::string::npos) {
+				break;
 			}
+			std::string line = session.input.substr(consumed, end - consumed);
+			consumed = end + 1;
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			handleCommand(id, line);
 		}
-		if (flags == options.mines) { // all mines must be flagged for win state
-			return GameState::WIN;
-		}
-		return GameState::PLAYING;
-	}
-
-	inline int Game::getRemainingFlags() {
-		return options.mines - board.getUsedFlags();
-	}
-
-	inline Board& Game::getBoard() {
-		return board;
-	}
-
-	inline GameOptions Game::getOptions() {
-		return options;
+		session.input.erase(0, consumed);
+		flush(id);
 	}
 
-	inline int64_t Game::getStartTime() {
-		return startTime;
-	}
-
-	inline GameLoop& Game::getLoop() {
-		return loop;
-	}
-
-	inline bool Game::isFirstMove() {
-		return firstMove;
-	}
-
-	// MinePlacer: Trivia virtual destructor
-	MinePlacer::~MinePlacer() {}
-
-	/////////////////////////////////////////////
-	// CLASS DEFINITION: Random Mine Placer
-	/////////////////////////////////////////////
-
-	RandomMinePlacer::RandomMinePlacer(Board& board) : MinePlacer(board) {}
-
-	/* Function Name: placeMines()
+	/* Function Name: handleCommand()
 	 *
 	 * Function Description:
-	 * Places mines on the board
+	 * This function runs one client command. The commands are:
+	 * NEW <width> <height> <mines>, CLICK <x> <y>, FLAG <x> <y>, CHORD <x> <y>, BOARD, HINT, STATS and QUIT.
+	 * Co-ordinates start at zero. HINT is answered BUSY while too many hints are queued, and can be sent again
 	 *
 	 * Parameters:
-	 * The clear parameter is a point type
+	 * The id parameter is the session slot
+	 * The line parameter is the command
 	 *
 	 * return value:
 	 * none
 	 */
-	void RandomMinePlacer::placeMines(Logic::Point clear) {
-		GameOptions options = board.getOptions();
-		int minesToPlace = options.mines;
-		if (minesToPlace > options.width * options.height - 1) {
-			minesToPlace = options.width * options.height - 1;
+	void GameServer::handleCommand(uint32_t id, std::string line) {
+		Session& session = *sessions[id];
+		std::istringstream stream(line);
+		std::string command;
+		stream >> command;
+		commandsHandled++;
+		if (command == "NEW") {
+			Logic::GameOptions options;
+			options.minePlacerType = Logic::MinePlacerType::RANDOM;
+			if (!(stream >> options.width >> options.height >> options.mines) || options.width < 2 || options.height < 2
+				|| options.width > MAX_SIDE || options.height > MAX_SIDE || options.mines < 1 || options.mines >= options.width * options.height) {
+				session.output += "ERR usage: NEW <width 2-1024> <height 2-1024> <mines>\n";
+				return;
+			}
+			session.game.reset(); // the old game is gone before its arena is rewound
+			session.arena->reset();
+			session.game.reset(new Logic::Game(loop, options, session.arena.get()));
+			gamesStarted++;
+			session.output += "GAME " + std::to_string(options.width) + " " + std::to_string(options.height) + " " + std::to_string(options.mines) + "\n";
+		}
+		else if (command == "QUIT") {
+			session.output += "BYE\n";
+			session.closing = true;
 		}
-		while (minesToPlace > 0) {
-			std::vector<Space*> notMined;
-			for (std::vector<Space>& row : board.getCols()) {
-				for (Space& space : row) {
-					if (space.getType() != SpaceType::MINE) {
-						notMined.push_back(&space);
+		else if (command == "STATS") {
+			session.output += "STATS sessions=" + std::to_string(activeSessions) + " games=" + std::to_string(gamesStarted)
+				+ " wins=" + std::to_string(loop.getWins()) + " losses=" + std::to_string(loop.getLosses())
+				+ " commands=" + std::to_string(commandsHandled) + "\n";
+		}
+		else if (!session.game) {
+			session.output += "ERR no game, send NEW first\n";
+		}
+		else if (command == "BOARD") {
+			Logic::GameOptions options = session.game->getOptions();
+			session.output += "BOARD " + std::to_string(options.width) + " " + std::to_string(options.height) + " "
+				+ Logic::PlayerView(session.game->getBoard()).encode() + "\n";
+		}
+		else if (command == "HINT" && hints.getPending() >= MAX_PENDING_HINTS) {
+			session.output += "BUSY\n";
+		}
+		else if (command == "HINT") { // deferred, as a full queue would otherwise run it here on the event loop
+			session.hintPending = true;
+			Logic::PlayerView view(session.game->getBoard());
+			uint32_t generation = session.generation;
+			loop.getScheduler().defer([this, id, generation, view]() {
+				HintResult result;
+				result.session = id;
+				result.generation = generation;
+				Logic::PlayerView seen = view;
+				result.hint = Logic::Solver(seen).findHint();
+				if (!result.hint.certain && result.hint.action == Logic::HintAction::REVEAL && hintBudget > 0) {
+					Logic::SampleEstimate estimate = Logic::MineSampler(seen, loop.getScheduler()).estimate(hintBudget);
+					if (estimate.samples > 0) {
+						result.hint = estimate.bestMove(seen);
 					}
 				}
-			}
-			Space& space = *notMined.at(static_cast<unsigned int>(rand()) % notMined.size());
-			if (space.getType() != SpaceType::MINE && !(space.getLocation() == clear)) {
-				if (notMined.size() > 9 && space.adjacentTo(board.getSpaceAt(clear))) { // avoid putting mines around starting location at all cost
-					continue;
+				{
+					std::lock_guard<std::mutex> lock(completedMutex);
+					completed.push_back(result);
 				}
-				space.setType(SpaceType::MINE);
-				minesToPlace--;
-			}
+				uint64_t one = 1;
+				ssize_t written = write(wakeFd, &one, sizeof(one));
+				(void)written;
+			}, hints);
 		}
-	}
-
-	/////////////////////////////////////////////
-	// CLASS DEFINITION: Game Loop
-	/////////////////////////////////////////////
-
-	GameLoop::GameLoop(Render::RenderType renderType) : renderType(renderType) {
-		if (renderType == Render::RenderType::CONSOLE) {
-			this->optionsSelector = new Render::ConsoleOptionsSelector();
+		else if (command == "CLICK" || command == "FLAG" || command == "CHORD") {
+			Logic::Game& game = *session.game;
+			int x = -1, y = -1;
+			stream >> x >> y;
+			if (x < 0 || y < 0 || x >= game.getOptions().width || y >= game.getOptions().height) {
+				session.output += "ERR co-ordinates out of range\n";
+				return;
+			}
+			if (game.getState() != Logic::GameState::PLAYING) {
+				session.output += "ERR game is over\n";
+				return;
+			}
+			if (command == "FLAG" && game.isFirstMove()) {
+				session.output += "ERR the first move must be a reveal\n";
+				return;
+			}
+			Logic::ActionResult result;
+			if (command == "CLICK") {
+				result = game.clickSpace(Logic::Point(x, y));
+			}
+			else if (command == "FLAG") {
+				result = game.flagSpace(Logic::Point(x, y));
+			}
+			else {
+				result = game.chordSpace(Logic::Point(x, y));
+			}
+			Logic::GameState state = game.getState();
+			if (state == Logic::GameState::WIN) {
+				loop.addWin(Logic::currentTimeSeconds() - game.getStartTime());
+			}
+			else if (state == Logic::GameState::LOSS) {
+				loop.addLoss(Logic::currentTimeSeconds() - game.getStartTime());
+			}
+			session.output += std::string("RESULT ") + resultName(result) + " " + stateName(state) + "\n";
+		}
+		else {
+			session.output += "ERR unknown command\n";
 		}
 	}
 
-	GameLoop::~GameLoop() {
-		delete optionsSelector;
-	}
-
-	/* Function Name: start()
+	/* Function Name: deliverHints()
 	 *
 	 * Function Description:
-	 * This function starts the game
+	 * This function sends finished hints back to their sessions and resumes their input
+	 *
+	 * Parameters:
+	 * none
 	 *
 	 * return value:
 	 * none
 	 */
-	void GameLoop::start() {
-		Render::Renderer* renderer = nullptr;
-		if (renderType == Render::RenderType::CONSOLE) {
-			renderer = new Render::ConsoleRenderer();
+	void GameServer::deliverHints() {
+		uint64_t value;
+		while (read(wakeFd, &value, sizeof(value)) > 0) {}
+		std::vector<HintResult> results;
+		{
+			std::lock_guard<std::mutex> lock(completedMutex);
+			results.swap(completed);
 		}
-
-		if (renderer->hasAdvancedRendering()) {
-			renderer->displayMenu(*this);
-		}
-		else {
-			while (true) {
-				GameOptions options = optionsSelector->promptForOptions();
-				Game game(*this, options);
-				renderer->playGame(*this, game);
-				if (!renderer->promptPlayAgain()) {
-					break;
-				}
+		for (HintResult& result : results) {
+			Session& session = *sessions[result.session];
+			if (session.fd < 0 || session.generation != result.generation) {
+				continue; // the client went away while the hint was computed
 			}
-			renderer->displayStats(*this);
+			session.hintPending = false;
+			session.output += std::string("HINT ") + hintActionName(result.hint.action) + " " + std::to_string(result.hint.location.x)
+				+ " " + std::to_string(result.hint.location.y) + " " + (result.hint.certain ? "1" : "0") + "\n";
+			processInput(result.session);
 		}
-
-		delete renderer;
-		std::cout << "Press (ENTER) to exit..." << std::endl;
-		Render::getCharacter();
-	}
-
-	inline void GameLoop::addExploded() {
-		exploded++;
-	}
-
-	inline void GameLoop::addFlagged() {
-		flagged++;
-	}
-
-	inline void GameLoop::addRevealed() {
-		revealed++;
-	}
-
-	inline void GameLoop::addWin(int64_t time) {
-		wins++;
-		winTimes.push_back(time);
-	}
-
-	inline void GameLoop::addLoss(int64_t time) {
-		losses++;
-		lossTimes.push_back(time);
-	}
-
-	inline std::vector<int64_t>& GameLoop::getWinTimes() {
-		return winTimes;
-	}
-
-	inline std::vector<int64_t>& GameLoop::getLossTimes() {
-		return lossTimes;
-	}
-
-	inline int GameLoop::getWins() {
-		return wins;
-	}
-
-	inline int GameLoop::getLosses() {
-		return losses;
-	}
-
-	inline int  GameLoop::getFlagged() {
-		return flagged;
-	}
-
-	inline int GameLoop::getExploded() {
-		return exploded;
-	}
-
-	inline int GameLoop::getRevealed() {
-		return revealed;
-	}
-}
-
-namespace Render {
-	// Renderer: Trivial virtual destructor
-	Renderer::~Renderer() {}
-
-	// Render class implementations (Console)
-
-	// Things used for drawing to the screen
-#define CONSOLE_H_BAR u8"══"
-#define CONSOLE_V_BAR u8"║"
-#define CONSOLE_TL_CORNER u8"╔"
-#define CONSOLE_TR_CORNER u8"╗"
-#define CONSOLE_BL_CORNER u8"╚"
-#define CONSOLE_BR_CORNER u8"╝"
-#define CONSOLE_VBOX u8"██"
-#define CONSOLE_VSELECT u8"▒"
-#define CONSOLE_FLAG u8"√"
-#define CONSOLE_MINE u8"Φ"
-
-	ConsoleRenderer::ConsoleRenderer() : selection(Logic::Point(0, 0)) {
-		this->selectionMode = SelectionMode::NONE;
-		this->lastAction = SelectionMode::REVEAL;
-	}
-
-	void ConsoleRenderer::initializeRender() {
-
 	}
 
-	/* Function Name: drawBoard()
+	/* Function Name: flush()
 	 *
 	 * Function Description:
-	 * This outputs the board
+	 * This function writes as much pending output as the socket accepts. When the socket is full
+	 * the session waits for EPOLLOUT instead of blocking the loop
 	 *
 	 * Parameters:
-	 * The game parameter references the Game class
+	 * The id parameter is the session slot
 	 *
 	 * return value:
 	 * none
 	 */
-	void ConsoleRenderer::drawBoard(Logic::Game& game) {
-		Logic::Board& board = game.getBoard();
-		Logic::GameOptions options = game.getOptions();
-		Logic::GameState state = game.getState();
-		std::vector<std::string> lines;
-		std::string start, end, numbers, spikes;
-		for (int y = 0; y < options.height; y++) {
-			spikes = "    ";
-			numbers = "    ";
-			start = "   ";
-			start += CONSOLE_TL_CORNER;
-			end = "   ";
-			end += +CONSOLE_BL_CORNER;
-			std::string row;
-			if (y % 2 == 0) {
-				std::string strNum = std::to_string(y + 1);
-				if (strNum.size() == 1) {
-					strNum = "0" + strNum;
-				}
-				row += strNum + "-" + CONSOLE_V_BAR;
+	void GameServer::flush(uint32_t id) {
+		Session& session = *sessions[id];
+		size_t written = 0;
+		while (written < session.output.size()) {
+			ssize_t count = send(session.fd, session.output.data() + written, session.output.size() - written, MSG_NOSIGNAL);
+			if (count > 0) {
+				written += static_cast<size_t>(count);
+				continue;
 			}
-			else {
-				row += "   ";
-				row += CONSOLE_V_BAR;
+			if (count < 0 && errno == EINTR) {
+				continue;
 			}
-			for (int x = 0; x < options.width; x++) {
-				bool color = selectionMode != SelectionMode::NONE && Logic::Point(x, y) == selection;
-				if (x % 2 == 0) {
-					std::string strNum = std::to_string(x + 1);
-					if (strNum.size() == 1) {
-						strNum = "0" + strNum;
-					}
-					numbers += strNum + "  ";
-					spikes += "|   ";
-				}
-				start += CONSOLE_H_BAR;
-				end += CONSOLE_H_BAR;
-				Logic::Space& space = board.getSpaceAt(x, y);
-				std::string dispCount = std::to_string(space.getAdjacentMines());
-				if (dispCount == "0" || state == Logic::GameState::LOSS) {
-					dispCount = " ";
-				}
-				if (color) {
-					if (selectionMode == SelectionMode::REVEAL) {
-						row += RED;
-					}
-					else {
-						row += GREEN;
-					}
-				}
-				switch (space.getType()) {
-				case Logic::SpaceType::EXPLODED_MINE:
-					row += CONSOLE_MINE;
-					break;
-				case Logic::SpaceType::REVEALED:
-					if (dispCount == " " && color) {
-						dispCount = CONSOLE_VSELECT;
-					}
-					row += dispCount;
-					break;
-				case Logic::SpaceType::MINE:
-				case Logic::SpaceType::EMPTY:
-					row += CONSOLE_VBOX;
-					break;
-				case Logic::SpaceType::FALSE_FLAG:
-				case Logic::SpaceType::FLAGGED_MINE:
-					row += CONSOLE_FLAG;
-					break;
-				default:
-					row += " ";
-				}
-				if (color) {
-					row += RESET;
-				}
-				if (space.getType() != Logic::SpaceType::EMPTY && space.getType() != Logic::SpaceType::MINE) {
-					row += " ";
-				}
+			if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				break;
 			}
-			row += CONSOLE_V_BAR;
-			lines.push_back(row);
+			closeSession(id);
+			return;
 		}
-		start += CONSOLE_TR_CORNER;
-		end += CONSOLE_BR_CORNER;
-		lines.insert(lines.begin(), start);
-		lines.insert(lines.begin(), spikes);
-		lines.insert(lines.begin(), numbers);
-		lines.push_back(end);
-
-		for (std::string line : lines) {
-			std::cout << line << std::endl;
+		session.output.erase(0, written);
+		bool blocked = !session.output.empty();
+		if (blocked != session.writeBlocked) {
+			session.writeBlocked = blocked;
+			epoll_event event;
+			event.events = EPOLLIN | EPOLLRDHUP | (blocked ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+			event.data.u64 = id + FIRST_SESSION_TOKEN;
+			epoll_ctl(epollFd, EPOLL_CTL_MOD, session.fd, &event);
 		}
+		if (!blocked && session.closing) {
+			closeSession(id);
+		}
+	}
 
-		if (game.getState() == Logic::GameState::PLAYING) {
-			int64_t timeDifference = Logic::currentTimeSeconds() - game.getStartTime();
-			int flags = game.getRemainingFlags();
-			std::string time = "Time: " + std::to_string(timeDifference) + " seconds";
-			std::string output = "   Remaining Flags: " + std::to_string(flags);
-			if (game.getOptions().width >= 20) {
-				struct Helper {
-					static unsigned int stringLen(std::string str) {
-						const char* s = str.c_str();
-						int len = 0;
-						while (*s) len += (*s++ & 0xc0) != 0x80;
-						return len;
-					}
-				};
-				unsigned int maxLineLen = Helper::stringLen(lines.at(lines.size() - 1));
-				unsigned int spaces = maxLineLen - Helper::stringLen(output) - Helper::stringLen(time);
-				for (unsigned int i = 0; i < spaces; i++) {
-					output += " ";
-				}
-			}
-			else {
-				output += "\n   ";
-			}
-			output += time;
-			std::cout << output << std::endl;
+	void GameServer::closeSession(uint32_t id) {
+		Session& session = *sessions[id];
+		if (session.fd < 0) {
+			return;
 		}
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, session.fd, nullptr);
+		close(session.fd);
+		session.reset(-1);
+		activeSessions--;
+		closedSessions.push_back(id);
+	}
 
-		std::cout << std::endl;
+	void GameServer::printStats() {
+		std::cout << "Games started: " << gamesStarted << std::endl;
+		std::cout << "Commands handled: " << commandsHandled << std::endl;
+		std::cout << "Peak sessions: " << sessions.size() << std::endl;
+		std::cout << "Wins: " << loop.getWins() << ", losses: " << loop.getLosses() << std::endl;
 	}
 
-	/* Function Name: promptForInput()
+	/////////////////////////////////////////////
+	// CLASS DEFINITION: Load Generator
+	/////////////////////////////////////////////
+
+	LoadGenerator::LoadGenerator(Address address, int clientCount, int gamesPerClient, Logic::GameOptions options)
+		: address(address), clientCount(clientCount), gamesPerClient(gamesPerClient), options(options), epollFd(-1) {
+		this->wins = 0;
+		this->losses = 0;
+		this->errors = 0;
+		this->finished = 0;
+		this->requests = 0;
+	}
+
+	/* Function Name: run()
 	 *
 	 * Function Description:
-	 * This function prompts for all inputs and handles them. Returns true if it is a proper input
+	 * This function connects every client, plays all their games concurrently on one epoll loop
+	 * and prints a report
 	 *
 	 * Parameters:
-	 * The game parameter is passed by reference
+	 * none
 	 *
 	 * return value:
-	 * bool
+	 * 0 on success, 1 if the server could not be reached
 	 */
-	bool ConsoleRenderer::promptForInput(Logic::Game& game) {
-		enum class Command {
-			REVEAL, FLAG, QUIT, INVALID
-		};
-		Logic::GameOptions options = game.getOptions();
-		Command selected = Command::INVALID;
-		char hackThatInput = 0;
-		while (selected == Command::INVALID) {
-			std::cout << "What action would you like to perform? Choose from (r)eveal, (f)lag, or (q)uit: ";
-			char command = getCharacter();
-			if (command == 0) {
-				std::cout << "Please type something..." << std::endl;
+	int LoadGenerator::run() {
+		epollFd = epoll_create1(EPOLL_CLOEXEC);
+		clients.resize(static_cast<size_t>(clientCount));
+		for (size_t index = 0; index < clients.size(); index++) {
+			Client& client = clients[index];
+			client.fd = address.connectTo();
+			client.gamesLeft = gamesPerClient;
+			client.sentAt = 0;
+			client.writeBlocked = false;
+			if (client.fd < 0) {
+				std::cout << "Could not connect client " << index << " to " << address.toString() << std::endl;
+				return 1;
 			}
-			switch (command) {
-			case 'r':
-				this->lastAction = SelectionMode::REVEAL;
-				selected = Command::REVEAL;
-				break;
-			case 'f':
-				if (game.isFirstMove()) {
-					std::cout << "You cannot set a flag on your first move!" << std::endl;
+			epoll_event event;
+			event.events = EPOLLIN | EPOLLRDHUP;
+			event.data.u64 = index;
+			epoll_ctl(epollFd, EPOLL_CTL_ADD, client.fd, &event);
+		}
+		int64_t start = currentTimeNanos();
+		std::string newGame = "NEW " + std::to_string(options.width) + " " + std::to_string(options.height) + " " + std::to_string(options.mines);
+		for (Client& client : clients) {
+			request(client, newGame);
+		}
+		std::vector<epoll_event> events(256);
+		while (finished < clientCount) {
+			int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 1000);
+			for (int index = 0; index < count; index++) {
+				Client& client = clients[static_cast<size_t>(events[static_cast<size_t>(index)].data.u64)];
+				if (client.fd < 0) {
 					continue;
 				}
-				this->lastAction = SelectionMode::FLAG;
-				selected = Command::FLAG;
-				break;
-			case 'q':
-				selected = Command::QUIT;
-				break;
-#if defined(windows) || defined(bash)
-			case 'w':
-			case 'a':
-			case 's':
-			case 'd':
-			case 72:
-			case 80:
-			case 75:
-			case 77:
-				hackThatInput = command;
-				switch (lastAction) {
-				case SelectionMode::FLAG:
-					selected = Command::FLAG;
-					break;
-				case SelectionMode::REVEAL:
-					selected = Command::REVEAL;
-					break;
-				default:
-					break;
+				if (events[static_cast<size_t>(index)].events & EPOLLOUT) {
+					flush(client);
 				}
-				break;
-#endif
-			default:
-				std::cout << "That was not a valid command." << std::endl;
+				char buffer[4096];
+				ssize_t read = recv(client.fd, buffer, sizeof(buffer), 0);
+				if (read == 0 || (read < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+					close(client.fd);
+					client.fd = -1;
+					finished++;
+					continue;
+				}
+				if (read > 0) {
+					client.input.append(buffer, static_cast<size_t>(read));
+				}
+				size_t end;
+				while (client.fd >= 0 && (end = client.input.find('\n')) != std::string::npos) {
+					std::string line = client.input.substr(0, end);
+					client.input.erase(0, end + 1);
+					handleReply(client, line);
+				}
+			}
+		}
+		double seconds = (currentTimeNanos() - start) / 1e9;
+		close(epollFd);
+		std::sort(latencies.begin(), latencies.end());
+		auto percentile = [this](double p) {
+			if (latencies.empty()) return 0.0;
+			return latencies[static_cast<size_t>(p * (latencies.size() - 1))] / 1000.0;
+		};
+		std::cout << std::setprecision(2) << std::fixed;
+		std::cout << " == Load Generator Report == " << std::endl;
+		std::cout << "Clients: " << clientCount << ", games per client: " << gamesPerClient << std::endl;
+		std::cout << "Games played: " << wins + losses << " (" << wins << " wins, " << losses << " losses), errors: " << errors << std::endl;
+		std::cout << "Requests: " << requests << " in " << seconds << " seconds (" << requests / seconds << " requests/s, "
+			<< (wins + losses) / seconds << " games/s)" << std::endl;
+		std::cout << "Latency (us): p50 " << percentile(0.5) << ", p90 " << percentile(0.9) << ", p99 " << percentile(0.99)
+			<< ", max " << percentile(1.0) << std::endl;
+		return 0;
+	}
+
+	void LoadGenerator::request(Client& client, std::string line) {
+		requests++;
+		client.sentAt = currentTimeNanos();
+		client.output += line + "\n";
+		flush(client);
+	}
+
+	void LoadGenerator::flush(Client& client) {
+		while (!client.output.empty()) {
+			ssize_t count = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+			if (count <= 0) {
 				break;
 			}
+			client.output.erase(0, static_cast<size_t>(count));
 		}
-		if (selected == Command::QUIT) {
-			clear();
-			drawBoard(game);
-			return true;
+		bool blocked = !client.output.empty();
+		if (blocked != client.writeBlocked) {
+			client.writeBlocked = blocked;
+			epoll_event event;
+			event.events = EPOLLIN | EPOLLRDHUP | (blocked ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+			event.data.u64 = static_cast<uint64_t>(&client - clients.data());
+			epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
 		}
-#if !defined(windows) && !defined(bash)
-		std::cout << "Now you will input the X and Y positions of the square to target." << std::endl;
-		int x = 0, y = 0;
-		while (x < 1 || x > options.width) {
-			std::cout << "X: ";
-			std::cin >> x;
-			std::cin.clear();
-			std::cin.ignore(100000, '\n');
-			if (x < 1 || x > options.width) {
-				std::cout << "You must enter a value in the range of the width (1-" << options.width << ")." << std::endl;
-			}
+	}
+
+	/* Function Name: handleReply()
+	 *
+	 * Function Description:
+	 * This function reacts to one server reply: ask for a hint, again while the server is busy, follow it,
+	 * and start the next game when the current one ends
+	 *
+	 * Parameters:
+	 * The client parameter is the client that received the reply
+	 * The line parameter is the reply
+	 *
+	 * return value:
+	 * none
+	 */
+	void LoadGenerator::handleReply(Client& client, std::string line) {
+		latencies.push_back(currentTimeNanos() - client.sentAt);
+		std::istringstream stream(line);
+		std::string reply;
+		stream >> reply;
+		if (reply == "GAME") {
+			request(client, "HINT");
 		}
-		while (y < 1 || y > options.height) {
-			std::cout << "Y: ";
-			std::cin >> y;
-			std::cin.clear();
-			std::cin.ignore(100000, '\n');
-			if (y < 1 || y > options.height) {
-				std::cout << "You must enter a value in the range of the height (1-" << options.height << ")." << std::endl;
+		else if (reply == "HINT") {
+			std::string action;
+			int x, y;
+			stream >> action >> x >> y;
+			if (action == "REVEAL") {
+				request(client, "CLICK " + std::to_string(x) + " " + std::to_string(y));
+			}
+			else if (action == "FLAG") {
+				request(client, "FLAG " + std::to_string(x) + " " + std::to_string(y));
+			}
+			else if (action == "CHORD") {
+				request(client, "CHORD " + std::to_string(x) + " " + std::to_string(y));
+			}
+			else {
+				errors++;
+				request(client, "QUIT");
 			}
 		}
-		Logic::Point location(x - 1, y - 1);
-#else
-		this->selectionMode = (selected == Command::REVEAL ? SelectionMode::REVEAL : SelectionMode::FLAG);
-		while (true) {
-			if (!hackThatInput) {
-				clear();
-				drawBoard(game);
-				std::cout << "Use keys (w, a, s, d) to change selection and press (ENTER) to select square." << std::endl;
-				std::string exitStr = "r";
-				if (selected == Command::FLAG) {
-					exitStr = "f";
-				}
-				std::cout << "Press (" << exitStr << ") to cancel selection." << std::endl;
+		else if (reply == "RESULT") {
+			std::string result, state;
+			stream >> result >> state;
+			if (state == "PLAYING") {
+				request(client, "HINT");
+				return;
 			}
-			int xOffset = 0, yOffset = 0;
-			char input = hackThatInput ? hackThatInput : getCharacter();
-			switch (input) {
-			case 10: // lunux enter (linefeed)
-			case 13: // windows enter (return)
-				goto finishSelection;
-				break;
-			case 'r':
-			case 'f':
-				selected = Command::INVALID;
-				goto finishSelection;
-				break;
-			case 72:
-			case 'w':
-				yOffset--;
-				break;
-			case 80:
-			case 's':
-				yOffset++;
-				break;
-			case 75:
-			case 'a':
-				xOffset--;
-				break;
-			case 77:
-			case 'd':
-				xOffset++;
-				break;
+			if (state == "WIN") {
+				wins++;
 			}
-			hackThatInput = 0;
-			Logic::Point newLoc = selection.add(xOffset, yOffset);
-			if (newLoc.x >= 0 && newLoc.y >= 0 && newLoc.x < options.width && newLoc.y < options.height) {
-				selection = newLoc;
+			else {
+				losses++;
+			}
+			client.gamesLeft--;
+			if (client.gamesLeft > 0) {
+				request(client, "NEW " + std::to_string(options.width) + " " + std::to_string(options.height) + " " + std::to_string(options.mines));
+			}
+			else {
+				request(client, "QUIT");
 			}
 		}
-	finishSelection:
-		this->selectionMode = SelectionMode::NONE;
-		Logic::Point location = selection;
-#endif
-		Logic::ActionResult result = Logic::ActionResult::INVALID;
-		if (selected == Command::REVEAL) {
-			result = game.clickSpace(location);
+		else if (reply == "BUSY") {
+			request(client, "HINT");
 		}
-		else if (selected == Command::FLAG) {
-			result = game.flagSpace(location);
+		else if (reply == "BYE") {
+			close(client.fd);
+			client.fd = -1;
+			finished++;
 		}
-		clear();
-		drawBoard(game);
-		if (result == Logic::ActionResult::ALREADY_REVEALED) {
-			std::cout << "That square could not be revealed since it isn't hidden!" << std::endl;
+		else {
+			if (errors++ < 10) {
+				std::cout << "Server error: " << line << std::endl;
+			}
+			request(client, "QUIT");
 		}
-		else if (result == Logic::ActionResult::NO_FLAGS) {
-			std::cout << "That square could not be flagged as you have no remaining flags!" << std::endl;
+	}
+
+	/* Function Name: runServer()
+	 *
+	 * Function Description:
+	 * This function starts the game server: minesweeper --server [address] [workers] [hint budget in ms].
+	 * Hints run on the shared scheduler, and [workers] sizes it unless --threads already has
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runServer(int argc, char** argv) {
+		Address address;
+		if (argc > 2 && !Address::parse(argv[2], address)) {
+			std::cout << "Invalid address \"" << argv[2] << "\", use unix:/path or tcp:port" << std::endl;
+			return 1;
 		}
-		else if (result == Logic::ActionResult::NOT_HIDDEN) {
-			std::cout << "That square could not be flagged as it is already revealed!" << std::endl;
+		if (argc > 3) {
+			Logic::WorkerPool::configure(static_cast<unsigned int>(std::max(1, atoi(argv[3]))), false);
 		}
-		return false;
+		int hintBudget = argc > 4 ? atoi(argv[4]) : 5;
+		signal(SIGINT, requestStop);
+		signal(SIGTERM, requestStop);
+		signal(SIGPIPE, SIG_IGN);
+		Logic::GameLoop loop(Render::RenderType::HEADLESS);
+		GameServer server(loop, address, hintBudget);
+		if (!server.open()) {
+			return 1;
+		}
+		std::cout << "Listening on " << address.toString() << " with " << loop.getScheduler().getThreadCount() << " hint workers, (CTRL+C) to stop." << std::endl;
+		server.run();
+		server.printStats();
+		return 0;
 	}
 
-	constexpr int minWH = 4;
-	constexpr int maxWH = 50;
-	constexpr int minMines = 2;
-
-	// OptionsSelector: Trivial virtual destructor
-	OptionsSelector::~OptionsSelector() {}
-
-	/* Function Name: promptForOptions()
+	/* Function Name: runLoadGenerator()
 	 *
 	 * Function Description:
-	 * This function prompts for all options and handles them. Returns true if it is a proper input
+	 * This function starts the load generator:
+	 * minesweeper --loadgen [address] [clients] [games per client] [width] [height] [mines]
 	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
 	 *
 	 * return value:
-	 * options
+	 * the process exit code
 	 */
-	Logic::GameOptions ConsoleOptionsSelector::promptForOptions() {
+	int runLoadGenerator(int argc, char** argv) {
+		Address address;
+		if (argc > 2 && !Address::parse(argv[2], address)) {
+			std::cout << "Invalid address \"" << argv[2] << "\", use unix:/path or tcp:port" << std::endl;
+			return 1;
+		}
+		int clientCount = argc > 3 ? atoi(argv[3]) : 100;
+		int games = argc > 4 ? atoi(argv[4]) : 10;
 		Logic::GameOptions options;
+		options.width = argc > 5 ? atoi(argv[5]) : 16;
+		options.height = argc > 6 ? atoi(argv[6]) : 16;
+		options.mines = argc > 7 ? atoi(argv[7]) : 40;
 		options.minePlacerType = Logic::MinePlacerType::RANDOM;
-		std::cout << std::endl << " == New Game Options == " << std::endl;
-		do {
-			std::cout << "Please enter a board width (" << minWH << "-" << maxWH << "): ";
-			std::cin >> options.width;
-			std::cin.clear();
-			std::cin.ignore(100000, '\n');
-			if (options.width < minWH || options.width > maxWH) {
-				std::cout << "Please choose a width between " << minWH << " and " << maxWH << "." << std::endl;
-			}
-		} while (options.width < minWH || options.width > maxWH);
-		do {
-			std::cout << "Please enter a board height (" << minWH << "-" << maxWH << "): ";
-			std::cin >> options.height;
-			std::cin.clear();
-			std::cin.ignore(100000, '\n');
-			if (options.height < minWH || options.height > maxWH) {
-				std::cout << "Please choose a height between " << minWH << " and " << maxWH << "." << std::endl;
-			}
-		} while (options.height < minWH || options.height > maxWH);
-		int maxMines = options.width * options.height - 10; // buffer starting area
-		do {
-			std::cout << "Please enter a mine count (" << minWH << "-" << maxMines << ", recommended: " << static_cast<int>(maxMines * 0.12) << "): ";
-			std::cin >> options.mines;
-			std::cin.clear();
-			std::cin.ignore(100000, '\n');
-			if (options.mines < minMines || options.mines > maxMines) {
-				std::cout << "Please choose a mine count between " << minMines << " and " << maxMines << "." << std::endl;
-			}
-		} while (options.mines < minMines || options.mines > maxMines);
-		return options;
+		if (clientCount < 1 || games < 1) {
+			std::cout << "Clients and games must be positive." << std::endl;
+			return 1;
+		}
+		signal(SIGPIPE, SIG_IGN);
+		LoadGenerator generator(address, clientCount, games, options);
+		return generator.run();
 	}
+}
+#endif
 
-	/* Function Name: displayMenu()
+// STATELESS FUNCTIONS
+namespace Logic {
+	inline int64_t currentTimeSeconds() {
+		// https://stackoverflow.com/a/19555298/4634429
+		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+
+	inline int popCount(unsigned int value) {
+		int count = 0;
+		for (; value; value &= value - 1) {
+			count++;
+		}
+		return count;
+	}
+
+	// the index of the lowest set bit of a non-zero value, with a de Bruijn sequence so every compiler gets it
+	inline int lowestBit(uint64_t value) {
+		static const int table[64] = {
+			0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4, 62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+			63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11, 46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+		};
+		return table[((value & (~value + 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+	}
+
+	// natural log of the binomial coefficient, -infinity style sentinel when k is out of range
+	inline double logChoose(int n, int k) {
+		if (k < 0 || k > n) {
+			return -1e300;
+		}
+		return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+	}
+
+	/* Function Name: sampleHypergeometric()
 	 *
 	 * Function Description:
-	 * This function prompts for all options and handles them. Returns true if it is a proper input
+	 * This function draws how many of the successes land in a sample taken without replacement.
+	 * It inverts the distribution starting at the mode and stepping outwards, so it takes about one
+	 * step per standard deviation and the probabilities never underflow on huge boards
 	 *
 	 * Parameters:
-	 * The loop parameter is passed by reference
+	 * The random parameter is the generator to draw from
+	 * The population parameter is the number of items
+	 * The successes parameter is how many of them count
+	 * The draws parameter is the size of the sample
 	 *
 	 * return value:
-	 * options
+	 * the number of successes in the sample
 	 */
-	void ConsoleRenderer::displayMenu(Logic::GameLoop& loop) {
-		constexpr int maxSelected = 4;
-		constexpr const char* menuOptions[maxSelected + 1] = { "Start Game", "Options   ", "Statistics", "Rules     ", "Exit      " };
-		Logic::GameOptions options;
-		options.width = 20;
-		options.height = 20;
-		options.mines = 100;
-		options.minePlacerType = Logic::MinePlacerType::RANDOM;
-		while (true) {
-			int selected = 0;
-			while (true) {
-				clear();
-				std::cout << std::endl << WHITE_BOLD << " Minesweeper - Main Menu" << RESET << std::endl << std::endl;
-				for (int index = 0; index < maxSelected + 1; index++) {
-					std::string result;
-					if (index == selected) {
-						result += YELLOW_HILIGHT;
-						result += "=== ";
-					}
-					else {
-						result += "--- ";
-					}
-					result += menuOptions[index];
-					if (index == selected) {
-						result += " === ";
-					}
-					else {
-						result += " --- ";
-					}
-					result += RESET;
-					std::cout << result << std::endl;
-				}
-				std::cout << std::endl << "Navigate the menu using the (w, s) keys, and make a selection by pressing (ENTER)." << std::endl << std::endl;
-				std::cout << "(C) 2019" << std::endl;
-				std::cout << "Game by [redacted for github] and [redacted for github]" << std::endl;
-				switch (getCharacter()) {
-				case 72:
-				case 'w':
-					if (selected == 0) {
-						break;
-					}
-					selected--;
-					break;
-				case 80:
-				case 's':
-					if (selected == maxSelected) {
-						break;
-					}
-					selected++;
-					break;
-				case 10: // lunux enter (linefeed)
-				case 13: // windows enter (return)
-					goto finishSelection;
-					break;
+	int sampleHypergeometric(std::mt19937_64& random, int population, int successes, int draws) {
+		int low = std::max(0, draws - (population - successes)), high = std::min(draws, successes);
+		if (low >= high) {
+			return low;
+		}
+		int mode = static_cast<int>((static_cast<double>(draws) + 1) * (static_cast<double>(successes) + 1) / (static_cast<double>(population) + 2));
+		mode = std::min(std::max(mode, low), high);
+		// P(k + 1) / P(k)
+		auto ratio = [population, successes, draws](int k) {
+			return (static_cast<double>(successes - k) * (draws - k)) / (static_cast<double>(k + 1) * (population - successes - draws + k + 1));
+		};
+		double target = static_cast<double>(random() >> 11) * (1.0 / 9007199254740992.0); // 53 random bits, the same everywhere
+		double peak = std::exp(logChoose(successes, mode) + logChoose(population - successes, draws - mode) - logChoose(population, draws));
+		target -= peak;
+		double up = peak, down = peak;
+		int above = mode, below = mode;
+		while (target > 0 && (above < high || below > low)) {
+			if (above < high) {
+				up *= ratio(above++);
+				target -= up;
+				if (target <= 0) {
+					return above;
 				}
 			}
-		finishSelection:;
-			switch (selected) {
-			case 0:
-			{ // Scope for some c++ transfer of control bypasses initialization
-				Logic::Game game(loop, options);
-				selection = Logic::Point(0, 0);
-				playGame(loop, game);
-				std::cout << std::endl << "Press (ENTER) to return to the main menu." << std::endl;
-				while (true) {
-					switch (getCharacter()) {
-					case 10: case 13:
-						goto returnToMainMenu;
-						break;
-					}
+			if (below > low) {
+				down /= ratio(--below);
+				target -= down;
+				if (target <= 0) {
+					return below;
 				}
 			}
-			break;
-			case 1:
-			{
-				while (true) {
-					constexpr int maxOptionsSelected = 3;
-					int optionsSelected = 0;
-					while (true) {
-						clear();
-						std::cout << std::endl << WHITE_BOLD << " Options" << RESET << std::endl << std::endl;
-						for (int index = 0; index < maxOptionsSelected + 1; index++) {
-							std::string result;
-							if (index == optionsSelected) {
-								result += YELLOW_HILIGHT;
-								result += "= ";
-							}
-							else {
-								result += "- ";
-							}
-							switch (index) {
-							case 0:
-								result += "Board Width: " + std::to_string(options.width);
-								break;
-							case 1:
-								result += "Board Height: " + std::to_string(options.height);
-								break;
-							case 2:
-								result += "Mine Count: " + std::to_string(options.mines);
-								break;
-							case 3:
-								result += "Back to Main Menu";
-								break;
-							}
-							result += RESET;
-							std::cout << result << std::endl;
-						}
-						std::cout << std::endl << "Navigate the menu using the (w, s) keys, and make a selection by pressing (ENTER)." << std::endl;
-						std::cout << "Press (q) to return to the main menu." << std::endl;
-						switch (getCharacter()) {
-						case 72:
-						case 'w':
-							if (optionsSelected == 0) {
-								break;
-							}
-							optionsSelected--;
-							break;
-						case 80:
-						case 's':
-							if (optionsSelected == maxOptionsSelected) {
-								break;
-							}
-							optionsSelected++;
-							break;
-						case 10: // lunux enter (linefeed)
-						case 13: // windows enter (return)
-							goto finishOptionsSelection;
-							break;
-						case 'q':
-							goto returnToMainMenu;
-							break;
-						}
-					}
-				finishOptionsSelection:;
-					const char* valueType = "Undefined";
-					int currentValue = 0;
-					int minValue = 0;
-					int maxValue = 0;
-					int editedValue = -1;
-					switch (optionsSelected) {
-					case 0:
-						valueType = "Board Width";
-						minValue = 3;
-						maxValue = 50;
-						currentValue = options.width;
-						break;
-					case 1:
-						valueType = "Board Height";
-						minValue = 3;
-						maxValue = 50;
-						currentValue = options.height;
-						break;
-					case 2:
-						valueType = "Mine Count";
-						minValue = 2;
-						maxValue = (options.width * options.height) - 8;
-						if (maxValue < minValue) {
-							maxValue = minValue;
-						}
-						currentValue = options.mines;
-						break;
-					case 3:
-						goto returnToMainMenu;
-						break;
-					}
-					clear();
-					std::cout << "You are editing the option \"" << valueType << "\". Current value: " << currentValue << std::endl;
-					do {
-						std::cout << "Please enter a value between " << minValue << " and " << maxValue << ": ";
-						std::cin >> editedValue;
-						std::cin.clear();
-						std::cin.ignore(100000, '\n');
-						if (editedValue < minValue || editedValue > maxValue) {
-							std::cout << "That value was out of range." << std::endl;
-						}
-					} while (editedValue < minValue || editedValue > maxValue);
-					switch (optionsSelected) {
-					case 0:
-						options.width = editedValue;
-						break;
-					case 1:
-						options.height = editedValue;
-						break;
-					case 2:
-						options.mines = editedValue;
+		}
+		return mode; // only reached when rounding leaves a sliver of probability unassigned
+	}
+
+	std::string topologyName(Topology topology) {
+		switch (topology) {
+		case Topology::TORUS:
+			return "Torus";
+		case Topology::HEX:
+			return "Hex";
+		case Topology::KNIGHT:
+			return "Knight";
+		default:
+			return "Square";
+		}
+	}
+
+	bool parseTopology(std::string name, Topology& topology) {
+		for (Topology candidate : { Topology::SQUARE, Topology::TORUS, Topology::HEX, Topology::KNIGHT }) {
+			std::string candidateName = topologyName(candidate);
+			if (name.size() == candidateName.size() && std::equal(name.begin(), name.end(), candidateName.begin(),
+				[](char a, char b) { return tolower(a) == tolower(b); })) {
+				topology = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/* Function Name: runCalibration()
+	 *
+	 * Function Description:
+	 * This function generates many boards from consecutive seeds and reports how their difficulty is spread:
+	 * minesweeper --calibrate [width] [height] [mines] [boards] [first seed] [square | torus | hex | knight]
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runCalibration(int argc, char** argv) {
+		GameOptions options;
+		options.width = argc > 2 ? atoi(argv[2]) : 30;
+		options.height = argc > 3 ? atoi(argv[3]) : 16;
+		options.mines = argc > 4 ? atoi(argv[4]) : 99;
+		options.minePlacerType = MinePlacerType::RANDOM;
+		int boards = argc > 5 ? atoi(argv[5]) : 10000;
+		uint64_t firstSeed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 1;
+		if (argc > 7 && !parseTopology(argv[7], options.topology)) {
+			std::cout << "Unknown board shape \"" << argv[7] << "\", use square, torus, hex or knight." << std::endl;
+			return 1;
+		}
+		if (options.width < 1 || options.height < 1 || options.mines < 0 || boards < 1 || firstSeed == 0) {
+			std::cout << "Width, height, boards and the first seed must be positive." << std::endl;
+			return 1;
+		}
+		std::vector<DifficultyProfile> profiles(static_cast<size_t>(boards));
+		WorkerPool& pool = WorkerPool::shared(); // the boards place their mines and rate themselves on it too
+		const int batchSize = 256;
+		std::vector<std::function<void()>> batches;
+		for (int first = 0; first < boards; first += batchSize) {
+			batches.push_back([&, first]() {
+				GameLoop loop(Render::RenderType::HEADLESS); // the counters are not shared between threads
+				GameArena arena(1 << 16);
+				for (int index = first; index < std::min(boards, first + batchSize); index++) {
+					GameOptions seeded = options;
+					seeded.seed = firstSeed + static_cast<uint64_t>(index);
+					{
+						Game game(loop, seeded, &arena);
+						game.clickSpace(Point(options.width / 2, options.height / 2));
+						profiles[static_cast<size_t>(index)] = game.getBoard().getDifficulty();
 					}
+					arena.reset();
 				}
+			});
+		}
+		auto started = std::chrono::steady_clock::now();
+		pool.runAll(batches);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+		std::vector<int> threeBV, openings, guesses;
+		int depths[3] = { 0, 0, 0 };
+		for (DifficultyProfile& profile : profiles) {
+			threeBV.push_back(profile.threeBV);
+			openings.push_back(profile.openings);
+			guesses.push_back(profile.forcedGuesses);
+			depths[std::min(2, std::max(0, profile.ruleDepth))]++;
+		}
+		auto report = [boards](std::string name, std::vector<int>& values) {
+			std::sort(values.begin(), values.end());
+			double sum = 0.0;
+			for (int value : values) sum += value;
+			auto percentile = [&values](double fraction) { return values[static_cast<size_t>(fraction * (values.size() - 1))]; };
+			std::cout << name << ": mean " << sum / boards << ", p10 " << percentile(0.1) << ", p50 " << percentile(0.5)
+				<< ", p90 " << percentile(0.9) << ", max " << values.back() << std::endl;
+		};
+		std::cout << boards << " " << topologyName(options.topology) << " boards of " << options.width << "x" << options.height << " with " << options.mines
+			<< " mines, seeds " << firstSeed << " to " << firstSeed + static_cast<uint64_t>(boards) - 1 << std::endl;
+		report("3BV", threeBV);
+		report("Openings", openings);
+		report("Forced guesses", guesses);
+		std::cout << "Rule depth: " << depths[0] << " none, " << depths[1] << " single, " << depths[2] << " subset" << std::endl;
+		std::cout << "Forced guesses histogram:" << std::endl;
+		for (int count = 0; count <= std::min(guesses.back(), 9); count++) {
+			long boardsWith = count < 9
+				? std::count(guesses.begin(), guesses.end(), count)
+				: std::count_if(guesses.begin(), guesses.end(), [](int value) { return value >= 9; });
+			std::cout << "   " << (count < 9 ? std::to_string(count) + " " : std::string("9+")) << " "
+				<< std::string(static_cast<size_t>(60 * boardsWith / boards), '#') << " " << boardsWith << std::endl;
+		}
+		std::cout << static_cast<int>(boards / seconds) << " boards/s on " << pool.getThreadCount() << " threads" << std::endl;
+		return 0;
+	}
+
+	/* Function Name: runTournament()
+	 *
+	 * Function Description:
+	 * This function plays strategies against each other on the same boards and reports the results:
+	 * minesweeper --tournament <solver,sampler,random> [boards] [width] [height] [mines] [first seed] [checkpoint file]
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runTournament(int argc, char** argv) {
+		std::vector<std::string> strategies;
+		std::istringstream names(argc > 2 ? argv[2] : "solver,sampler,random");
+		for (std::string name; std::getline(names, name, ',');) {
+			if (!Strategy::create(name)) {
+				std::cout << "Unknown strategy \"" << name << "\", use solver, sampler or random." << std::endl;
+				return 1;
 			}
-			break;
-			case 2:
-			{
-				clear();
-				displayStats(loop);
-				std::cout << std::endl << "Press (ENTER) to return to the main menu." << std::endl;
-				while (true) {
-					switch (getCharacter()) {
-					case 10: case 13:
-						goto returnToMainMenu;
-						break;
-					}
-				}
+			strategies.push_back(name);
+		}
+		GameOptions options;
+		int boards = argc > 3 ? atoi(argv[3]) : 1000;
+		options.width = argc > 4 ? atoi(argv[4]) : 30;
+		options.height = argc > 5 ? atoi(argv[5]) : 16;
+		options.mines = argc > 6 ? atoi(argv[6]) : 99;
+		options.minePlacerType = MinePlacerType::RANDOM;
+		uint64_t firstSeed = argc > 7 ? strtoull(argv[7], nullptr, 10) : 1;
+		if (strategies.empty() || options.width < 1 || options.height < 1 || options.mines < 1 || boards < 1 || firstSeed == 0) {
+			std::cout << "Width, height, mines, boards and the first seed must be positive." << std::endl;
+			return 1;
+		}
+		Tournament tournament(options, boards, firstSeed, strategies, argc > 8 ? argv[8] : "");
+		auto started = std::chrono::steady_clock::now();
+		if (!tournament.run()) {
+			std::cout << "The checkpoint \"" << argv[8] << "\" belongs to a different tournament." << std::endl;
+			return 1;
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		tournament.report(std::cout);
+		std::cout << std::fixed << std::setprecision(1) << "Played in " << seconds << " s on " << WorkerPool::shared().getThreadCount() << " threads" << std::endl;
+		return 0;
+	}
 
+	/* Function Name: runRace()
+	 *
+	 * Function Description:
+	 * This function races strategies against each other on one board and shows the leaderboard while they play.
+	 * Each player moves for a short turn at a time on the shared scheduler, so there can be more players than cores.
+	 * A player named human is the person at the console, who types moves such as r 3 4 while the bots play:
+	 * minesweeper --race <human,solver,sampler,random,...> [width] [height] [mines] [seed]
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runRace(int argc, char** argv) {
+		std::vector<std::string> names;
+		std::vector<std::unique_ptr<Strategy>> strategies; // nullptr for the human
+		int human = -1;
+		std::istringstream list(argc > 2 ? argv[2] : "solver,sampler,random");
+		for (std::string name; std::getline(list, name, ',');) {
+			if (name == "human" && human < 0) {
+				human = static_cast<int>(names.size());
+				strategies.push_back(nullptr);
+				names.push_back(name + "#" + std::to_string(names.size() + 1));
+				continue;
 			}
-			break;
-			case 3:
-			{
-				// Rules from http://www.freeminesweeper.org/help/minehelpinstructions.html
-				clear();
-				std::cout << "A squares \"neighbours\" are the squares adjacent above, below, left, right, and all 4 diagonals." << std::endl;
-				std::cout << "Squares on the sides of the board or in a corner have fewer neighbors. "
-					<< "The board does not wrap around the edges." << std::endl;
-				std::cout << "If you open a square with 0 neighboring bombs, all its neighbors will automatically open."
-					<< "This can cause a large area to automatically open." << std::endl;
-				std::cout << "The first square you open is never a bomb." << std::endl;
-				std::cout << "If you mark a bomb incorrectly, you will have to correct the mistake before you can win. "
-					<< "Incorrect bomb marking doesn't kill you, but it can lead to mistakes which do." << std::endl;
-				std::cout << std::endl << "Press (ENTER) to return to the main menu." << std::endl;
-				while (true) {
-					switch (getCharacter()) {
-					case 10: case 13:
-						goto returnToMainMenu;
-						break;
+			strategies.push_back(Strategy::create(name));
+			if (!strategies.back()) {
+				std::cout << "Unknown strategy \"" << name << "\", use human (once), solver, sampler or random." << std::endl;
+				return 1;
+			}
+			names.push_back(name + "#" + std::to_string(names.size() + 1));
+		}
+		GameOptions options;
+		options.width = argc > 3 ? atoi(argv[3]) : 30;
+		options.height = argc > 4 ? atoi(argv[4]) : 16;
+		options.mines = argc > 5 ? atoi(argv[5]) : 99;
+		options.seed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 0;
+		if (names.empty() || options.width < 1 || options.height < 1 || options.mines < 1 || options.mines >= options.width * options.height) {
+			std::cout << "The board needs a positive size and fewer mines than squares." << std::endl;
+			return 1;
+		}
+		Race race(options, Point(options.width / 2, options.height / 2), names);
+		options = race.getOptions();
+		WorkerPool& pool = WorkerPool::shared();
+		CancelToken racing;
+		std::atomic<int> playing(race.getPlayerCount() - (human >= 0 ? 1 : 0)); // the bots still playing
+		std::vector<std::function<void()>> turns(static_cast<size_t>(race.getPlayerCount()));
+		for (int player = 0; player < race.getPlayerCount(); player++) {
+			if (player == human) {
+				continue;
+			}
+			strategies[static_cast<size_t>(player)]->newGame(options.seed);
+			turns[static_cast<size_t>(player)] = [&race, &strategies, &playing, &pool, &racing, &turns, player] {
+				Game& game = race.getGame(player);
+				Strategy& strategy = *strategies[static_cast<size_t>(player)];
+				auto turnEnd = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+				while (game.getState() == GameState::PLAYING && std::chrono::steady_clock::now() < turnEnd) {
+					Hint played;
+					ActionResult result = playStrategyMove(game, strategy, played);
+					race.recordMove(player);
+					if (result != ActionResult::OK && result != ActionResult::EXPLODED) {
+						playing--; // the strategy is stuck and drops out
+						return;
 					}
 				}
+				if (game.getState() == GameState::PLAYING) {
+					pool.defer(turns[static_cast<size_t>(player)], racing); // behind the other players' turns
+					return;
+				}
+				playing--;
+			};
+			pool.defer(turns[static_cast<size_t>(player)], racing);
+		}
+		auto leaderboard = [&race, &options](bool finished) {
+			std::ostringstream out;
+			out << "Race on a " << options.width << "x" << options.height << " board with " << options.mines << " mines, seed " << options.seed
+				<< (finished ? ", finished" : "") << std::endl << std::endl;
+			int place = 1;
+			for (RaceStanding& standing : race.getStandings()) {
+				const char* state = standing.state == GameState::WIN ? "won" : standing.state == GameState::PLAYING ? "playing" : "lost";
+				out << std::setw(3) << place++ << ". " << std::left << std::setw(14) << standing.name << std::setw(8) << state << std::right
+					<< std::fixed << std::setprecision(1) << std::setw(6) << standing.revealed * 100.0 / standing.safe << "%"
+					<< std::setw(9) << standing.millis / 1000.0 << " s" << std::setw(8) << standing.moves << " moves" << std::endl;
 			}
-			case 4:
-				clear();
-				return;
+			return out.str();
+		};
+		if (human >= 0) {
+			// the human plays on this thread with line commands, and sees the leaderboard after every move
+			Game& game = race.getGame(human);
+			std::string message = "The first click is made. Type r, f or c and a column and row, such as r 3 4, or q to give up.";
+			while (game.getState() == GameState::PLAYING) {
+				std::cout << leaderboard(false) << std::endl;
+				std::string view = PlayerView(game.getBoard()).encode();
+				for (int y = 0; y < options.height; y++) {
+					std::cout << std::setw(4) << y + 1 << " " << view.substr(static_cast<size_t>(y) * options.width, static_cast<size_t>(options.width)) << std::endl;
+				}
+				std::cout << message << std::endl << "> " << std::flush;
+				std::string line;
+				if (!std::getline(std::cin, line)) {
+					break;
+				}
+				std::istringstream command(line);
+				char action = 0;
+				int x = 0, y = 0;
+				command >> action;
+				if (action == 'q') {
+					break;
+				}
+				if (!(command >> x >> y) || (action != 'r' && action != 'f' && action != 'c')) {
+					message = "Use r, f or c and a column and row, such as r 3 4, or q to give up.";
+					continue;
+				}
+				Point location(x - 1, y - 1);
+				ActionResult result = action == 'r' ? game.clickSpace(location) : action == 'f' ? game.flagSpace(location) : game.chordSpace(location);
+				race.recordMove(human);
+				message = result == ActionResult::OK || result == ActionResult::EXPLODED ? "" : "That move is not allowed there.";
 			}
-		returnToMainMenu:;
-			if (options.mines >= options.width * options.height) {
-				options.mines = options.width * options.height - 1;
+		}
+		int columns, rows;
+		{
+			std::unique_ptr<Render::FrameWriter> writer;
+			if (Render::getTerminalSize(columns, rows)) {
+				writer.reset(new Render::FrameWriter(nullptr));
+			}
+			while (playing.load() > 0) {
+				if (writer) {
+					writer->publish(leaderboard(false));
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			}
+			if (writer) {
+				writer->flush();
 			}
 		}
+		pool.wait(racing);
+		std::cout << leaderboard(true);
+		std::cout << std::endl << "Overlay bytes:";
+		for (int player = 0; player < race.getPlayerCount(); player++) {
+			std::cout << (player == 0 ? " " : ", ") << names[static_cast<size_t>(player)] << " " << race.getOverlayBytes(player);
+		}
+		std::cout << "; the players share the board's " << race.getChunkCount() << " chunks and copied " << race.countPrivateChunks() << " of them." << std::endl;
+		return 0;
 	}
 
-	/* Function Name: promptPlayAgain()
+	/* Function Name: runFuzz()
 	 *
 	 * Function Description:
-	 * This function prompts if user wants to play again
+	 * This function plays random inputs through the Fuzzer on every core until the time is up, and writes
+	 * any input that fails a check to fuzz-failure-<seed>-<task>.bin. Given a file, it plays that input instead:
+	 * minesweeper --fuzz [seconds] [seed] [input file]
 	 *
 	 * Parameters:
-	 * none
+	 * The argc and argv parameters are the command line
 	 *
 	 * return value:
-	 * bool
+	 * the process exit code, 1 if a check failed
 	 */
-	bool ConsoleRenderer::promptPlayAgain() {
-		std::cout << std::endl << "Would you like to play again? (y/n): ";
-		int state = -1;
-		while (state == -1) {
-			char input = getCharacter();
-			switch (input) {
-			case 'y':
-				state = 1;
-				break;
-			case 'n':
-				state = 0;
-				break;
-			default:
-				std::cout << "Please type (y) or (n)." << std::endl;
-				break;
+	int runFuzz(int argc, char** argv) {
+		double seconds = argc > 2 ? atof(argv[2]) : 10;
+		uint64_t seed = argc > 3 ? strtoull(argv[3], nullptr, 10) : static_cast<uint64_t>(time(nullptr));
+		if (argc > 4) {
+			std::ifstream file(argv[4], std::ios::binary);
+			std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			if (!file) {
+				std::cout << "Could not read \"" << argv[4] << "\"." << std::endl;
+				return 1;
 			}
+			Fuzzer fuzzer;
+			bool passed = fuzzer.run(input.data(), input.size());
+			std::cout << (passed ? "Passed" : "Failed at " + fuzzer.getFailure()) << std::endl;
+			return passed ? 0 : 1;
 		}
-		clear();
-		return state;
+		WorkerPool& pool = WorkerPool::shared();
+		auto started = std::chrono::steady_clock::now();
+		auto deadline = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+		std::atomic<int64_t> runs(0);
+		CancelToken failed; // the first failure stops every worker
+		std::mutex report;
+		std::vector<std::function<void()>> tasks;
+		for (unsigned int task = 0; task < pool.getThreadCount(); task++) {
+			tasks.push_back([&, task] {
+				std::mt19937_64 random(seed + task);
+				Fuzzer fuzzer;
+				while (!failed.isCancelled() && std::chrono::steady_clock::now() < deadline) {
+					std::vector<uint8_t> input = Fuzzer::generate(random);
+					runs.fetch_add(1, std::memory_order_relaxed);
+					if (!fuzzer.run(input.data(), input.size())) {
+						failed.cancel();
+						std::string path = "fuzz-failure-" + std::to_string(seed) + "-" + std::to_string(task) + ".bin";
+						std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(input.data()), static_cast<std::streamsize>(input.size()));
+						std::lock_guard<std::mutex> lock(report);
+						std::cout << "Failed at " << fuzzer.getFailure() << ", the input is in " << path << std::endl;
+					}
+				}
+			});
+		}
+		pool.runAll(tasks, failed);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		std::cout << runs.load() << " inputs from seed " << seed << " in " << std::fixed << std::setprecision(1) << elapsed << " s, "
+			<< static_cast<int64_t>(runs.load() / elapsed) << "/s on " << pool.getThreadCount() << " threads" << std::endl;
+		return failed.isCancelled() ? 1 : 0;
 	}
 
-	/* Function Name: displayStats()
+	/* Function Name: runDifferential()
 	 *
 	 * Function Description:
-	 * This function displays the stats of past games
+	 * This function plays seeded games on the optimised Game and on the ReferenceGame side by side on every core.
+	 * At the first difference the moves are shrunk, printed and written to diff-<seed>.txt; given a file instead,
+	 * it replays that file:
+	 * minesweeper --diff [games] [width] [height] [mines] [first seed] [square | torus | hex | knight] [moves per game]
+	 * minesweeper --diff <reproducer file>
 	 *
 	 * Parameters:
-	 * The loop parameter is passed by reference
+	 * The argc and argv parameters are the command line
 	 *
 	 * return value:
-	 * none
+	 * the process exit code, 1 if the games differed
 	 */
-	void ConsoleRenderer::displayStats(Logic::GameLoop& loop) {
-		int gamesPlayed = loop.getWins() + loop.getLosses();
-		std::cout << " == Player Stats == " << std::endl;
-		std::cout << "Total spaces revealed: " << loop.getRevealed() << std::endl;
-		std::cout << "Total mines exploded: " << loop.getExploded() << std::endl;
-		std::cout << "Total spaces flagged: " << loop.getFlagged() << std::endl;
-		std::cout << std::endl;
-		std::cout << "Total games: " << gamesPlayed << std::endl;
-		std::cout << "Total wins: " << loop.getWins() << std::endl;
-		std::cout << "Total losses: " << loop.getLosses() << std::endl;
-		std::cout << std::endl;
-		if (gamesPlayed > 0) {
-			std::cout << std::setprecision(2) << std::fixed;
-			std::cout << "Win percentage: " << (loop.getWins() / static_cast<double>(gamesPlayed)) * 100 << "%" << std::endl;
-			if (loop.getWinTimes().size() > 0) {
-				int64_t totalTime = 0;
-				for (int64_t time : loop.getWinTimes()) {
-					totalTime += time;
-				}
-				std::cout << "Average time to win: " << (totalTime / static_cast<double>(loop.getWinTimes().size())) << " seconds" << std::endl;
+	int runDifferential(int argc, char** argv) {
+		if (argc == 3 && std::string(argv[2]).find_first_not_of("0123456789") != std::string::npos) {
+			std::ifstream file(argv[2]);
+			GameOptions options;
+			std::vector<DiffAction> actions;
+			if (!Differential::read(file, options, actions)) {
+				std::cout << "\"" << argv[2] << "\" is not a reproducer." << std::endl;
+				return 1;
 			}
-			std::cout << "Loss percentage: " << (loop.getLosses() / static_cast<double>(gamesPlayed)) * 100 << "%" << std::endl;
-			if (loop.getLossTimes().size() > 0) {
-				int64_t totalTime = 0;
-				for (int64_t time : loop.getLossTimes()) {
-					totalTime += time;
-				}
-				std::cout << "Average time to loss: " << (totalTime / static_cast<double>(loop.getLossTimes().size())) << " seconds" << std::endl;
+			GameLoop loop(Render::RenderType::HEADLESS);
+			Differential differential(options);
+			if (differential.replay(actions, loop, nullptr)) {
+				std::cout << "The game matches the reference over all " << actions.size() << " moves." << std::endl;
+				return 0;
 			}
-			std::cout << std::endl;
+			std::cout << "Move " << differential.getStep() << " of " << actions.size() << ": " << differential.getDivergence() << std::endl;
+			return 1;
+		}
+		GameOptions options;
+		int games = argc > 2 ? atoi(argv[2]) : 100000;
+		options.width = argc > 3 ? atoi(argv[3]) : 16;
+		options.height = argc > 4 ? atoi(argv[4]) : 16;
+		options.mines = argc > 5 ? atoi(argv[5]) : 40;
+		uint64_t firstSeed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 1;
+		int moves = argc > 8 ? atoi(argv[8]) : 64;
+		if ((argc > 7 && !parseTopology(argv[7], options.topology)) || games < 1 || moves < 1 || firstSeed == 0
+			|| options.width < 1 || options.height < 1 || options.mines < 1 || options.mines >= options.width * options.height) {
+			std::cout << "Use --diff [games] [width] [height] [mines] [first seed] [square | torus | hex | knight] [moves per game]" << std::endl;
+			return 1;
+		}
+		options.minePlacerType = static_cast<int64_t>(options.width) * options.height >= 1 << 20 ? MinePlacerType::PARALLEL_RANDOM : MinePlacerType::RANDOM;
+		options.parallelReveal = 64; // so cascades on small boards take the parallel path where there are cores for it
+		constexpr int BATCH = 256;
+		std::atomic<uint64_t> diverged(UINT64_MAX); // the lowest seed that differed, so the report does not depend on timing
+		std::atomic<int64_t> played(0);
+		std::vector<std::function<void()>> tasks;
+		for (int first = 0; first < games; first += BATCH) {
+			tasks.push_back([&, first] {
+				GameLoop loop(Render::RenderType::HEADLESS);
+				GameArena arena(1 << 16);
+				for (int index = first; index < std::min(games, first + BATCH); index++) {
+					GameOptions seeded = options;
+					seeded.seed = firstSeed + static_cast<uint64_t>(index);
+					if (seeded.seed > diverged.load(std::memory_order_relaxed)) {
+						return;
+					}
+					std::vector<DiffAction> actions = Differential::generate(seeded, moves);
+					Differential differential(seeded);
+					bool agreed = differential.replay(actions, loop, &arena);
+					played.fetch_add(differential.getStep(), std::memory_order_relaxed);
+					if (!agreed) {
+						uint64_t lowest = diverged.load();
+						while (seeded.seed < lowest && !diverged.compare_exchange_weak(lowest, seeded.seed)) {}
+						return;
+					}
+				}
+			});
 		}
+		auto started = std::chrono::steady_clock::now();
+		WorkerPool::shared().runAll(tasks);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		std::cout << played.load() << " moves in " << std::fixed << std::setprecision(1) << seconds << " s, "
+			<< static_cast<int64_t>(played.load() * 60 / seconds) << " moves/min on " << WorkerPool::shared().getThreadCount() << " threads" << std::endl;
+		if (diverged.load() == UINT64_MAX) {
+			std::cout << "The game matched the reference in all " << games << " games." << std::endl;
+			return 0;
+		}
+		options.seed = diverged.load();
+		GameLoop loop(Render::RenderType::HEADLESS);
+		Differential differential(options);
+		std::vector<DiffAction> actions = differential.shrink(Differential::generate(options, moves), loop, nullptr);
+		std::string path = "diff-" + std::to_string(options.seed) + ".txt";
+		std::ofstream file(path);
+		Differential::write(options, actions, file);
+		std::cout << "Seed " << options.seed << " differs at move " << differential.getStep() << " of the " << actions.size() << " below: "
+			<< differential.getDivergence() << std::endl;
+		Differential::write(options, actions, std::cout);
+		std::cout << "Written to " << path << ", replay it with --diff " << path << std::endl;
+		return 1;
 	}
 
-	/* Function Name: playGame()
+	/* Function Name: runExport()
 	 *
 	 * Function Description:
-	 * This funstion plays the game
+	 * This function generates a board, opens its centre and writes it to standard output.
+	 * Boards of a million squares or more have their mines placed in parallel tiles:
+	 * minesweeper --export [json | binary | save] [width] [height] [mines] [seed] [square | torus | hex | knight]
 	 *
 	 * Parameters:
-	 * The loop parameter is passed by reference
-	 * The game parameter is passed by reference
+	 * The argc and argv parameters are the command line
 	 *
 	 * return value:
-	 * none
+	 * the process exit code
 	 */
-	void ConsoleRenderer::playGame(Logic::GameLoop& loop, Logic::Game& game) {
-		clear();
-		drawBoard(game);
-		while (game.getState() == Logic::GameState::PLAYING) {
-			if (promptForInput(game)) {
-				break;
-			}
+	int runExport(int argc, char** argv) {
+		std::string format = argc > 2 ? argv[2] : "json";
+		GameOptions options;
+		options.width = argc > 3 ? atoi(argv[3]) : 30;
+		options.height = argc > 4 ? atoi(argv[4]) : 16;
+		options.mines = argc > 5 ? atoi(argv[5]) : 99;
+		options.seed = argc > 6 ? strtoull(argv[6], nullptr, 10) : 0;
+		if ((format != "json" && format != "binary" && format != "save") || (argc > 7 && !parseTopology(argv[7], options.topology))) {
+			std::cerr << "Use --export [json | binary | save] [width] [height] [mines] [seed] [square | torus | hex | knight]" << std::endl;
+			return 1;
 		}
-		if (game.getState() == Logic::GameState::WIN) {
-			loop.addWin(Logic::currentTimeSeconds() - game.getStartTime());
-			std::cout << R"( __   __           __        ___       _ )" << std::endl;
-			std::cout << R"( \ \ / /__  _   _  \ \      / (_)_ __ | |)" << std::endl;
-			std::cout << R"(  \ V / _ \| | | |  \ \ /\ / /| | '_ \| |)" << std::endl;
-			std::cout << R"(   | | (_) | |_| |   \ V  V / | | | | |_|)" << std::endl;
-			std::cout << R"(   |_|\___/ \__,_|    \_/\_/  |_|_| |_(_))" << std::endl;
+		if (options.width < 1 || options.height < 1 || options.mines < 0) {
+			std::cerr << "Width and height must be positive." << std::endl;
+			return 1;
 		}
-		else if (game.getState() == Logic::GameState::LOSS) {
-			loop.addLoss(Logic::currentTimeSeconds() - game.getStartTime());
-			std::cout << R"( __   __            _              _   )" << std::endl;
-			std::cout << R"( \ \ / /__  _   _  | |    ___  ___| |_ )" << std::endl;
-			std::cout << R"(  \ V / _ \| | | | | |   / _ \/ __| __|)" << std::endl;
-			std::cout << R"(   | | (_) | |_| | | |__| (_) \__ \ |_ )" << std::endl;
-			std::cout << R"(   |_|\___/ \__,_| |_____\___/|___/\__|)" << std::endl;
+		if (!GameSerializer::fits(options)) {
+			std::cerr << "Boards of more than " << GameSerializer::getMaxSquares() << " squares cannot be loaded back." << std::endl;
+			return 1;
 		}
+		options.minePlacerType = static_cast<int64_t>(options.width) * options.height >= 1 << 20 ? MinePlacerType::PARALLEL_RANDOM : MinePlacerType::RANDOM;
+		GameLoop loop(Render::RenderType::HEADLESS);
+		Game game(loop, options);
+		game.clickSpace(Point(options.width / 2, options.height / 2));
+		GameSerializer::write(game, std::cout, format == "json" ? BoardFormat::JSON : format == "save" ? BoardFormat::SAVE : BoardFormat::BINARY);
+		return std::cout ? 0 : 1;
 	}
 
-	inline void ConsoleRenderer::clear() {
-#ifdef windows
-		system("cls");
-#elif defined(bash)
-		system("clear");
-#endif
+	/* Function Name: runConvert()
+	 *
+	 * Function Description:
+	 * This function loads a game written in any format and writes it again to standard output:
+	 * minesweeper --convert <file | -> [json | binary | save]
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runConvert(int argc, char** argv) {
+		std::string format = argc > 3 ? argv[3] : "json";
+		if (argc < 3 || (format != "json" && format != "binary" && format != "save")) {
+			std::cerr << "Use --convert <file | -> [json | binary | save]" << std::endl;
+			return 1;
+		}
+		std::string path = argv[2];
+		GameLoop loop(Render::RenderType::HEADLESS);
+		std::unique_ptr<Game> game;
+		if (!(path == "-" ? GameSerializer::read(std::cin, loop, game) : GameSerializer::load(path, loop, game))) {
+			std::cerr << "\"" << path << "\" is not a valid saved game." << std::endl;
+			return 1;
+		}
+		GameSerializer::write(*game, std::cout, format == "json" ? BoardFormat::JSON : format == "save" ? BoardFormat::SAVE : BoardFormat::BINARY);
+		return std::cout ? 0 : 1;
 	}
 
-	inline char getCharacter() {
-		char result;
-#if defined(windows)
-		result = -32;
-		while (result == -32) {
-			result = static_cast<char>(_getch());
+	/* Function Name: runCorpus()
+	 *
+	 * Function Description:
+	 * This function writes the boards of consecutive seeds, opened from their centre, to a corpus, then reads them all
+	 * back and reports the size and speed. "ranks" stores every board as its number, as layouts from elsewhere would be:
+	 * minesweeper --corpus <file> [boards] [width] [height] [mines] [first seed] [square | torus | hex | knight] [seeds | ranks]
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runCorpus(int argc, char** argv) {
+		GameOptions options;
+		int boards = argc > 3 ? atoi(argv[3]) : 100000;
+		options.width = argc > 4 ? atoi(argv[4]) : 30;
+		options.height = argc > 5 ? atoi(argv[5]) : 16;
+		options.mines = argc > 6 ? atoi(argv[6]) : 99;
+		options.minePlacerType = MinePlacerType::RANDOM;
+		uint64_t firstSeed = argc > 7 ? strtoull(argv[7], nullptr, 10) : 1;
+		std::string storage = argc > 9 ? argv[9] : "seeds";
+		if (argc < 3 || (argc > 8 && !parseTopology(argv[8], options.topology)) || (storage != "seeds" && storage != "ranks")) {
+			std::cerr << "Use --corpus <file> [boards] [width] [height] [mines] [first seed] [square | torus | hex | knight] [seeds | ranks]" << std::endl;
+			return 1;
 		}
-#elif defined(bash)
-		// https://stackoverflow.com/a/9547954/4634429
-		struct termios old_tio, new_tio;
-		tcgetattr(STDIN_FILENO, &old_tio);
-		new_tio = old_tio;
-		new_tio.c_lflag &= (~ICANON & ~ECHO);
-		tcsetattr(STDIN_FILENO, TCSANOW, &new_tio);
-		result = getchar();
-		tcsetattr(STDIN_FILENO, TCSANOW, &old_tio);
-#else
-		std::string buffer;
-		std::cin >> buffer;
-		if (buffer.size() == 0) {
-			result = 0;
+		if (options.width < 1 || options.height < 1 || options.mines < 0 || boards < 1 || firstSeed == 0) {
+			std::cerr << "Width, height, boards and the first seed must be positive." << std::endl;
+			return 1;
 		}
-		else {
-			result = buffer.at(0);
+		if (static_cast<int64_t>(options.width) * options.height > LayoutCodec::MAX_CELLS) {
+			std::cerr << "A corpus board can have at most " << LayoutCodec::MAX_CELLS << " squares." << std::endl;
+			return 1;
 		}
-#endif
-		return result;
+		std::string path = argv[2];
+		CorpusWriter writer;
+		if (!writer.create(path, options)) {
+			std::cerr << "\"" << path << "\" could not be written." << std::endl;
+			return 1;
+		}
+		Point centre(options.width / 2, options.height / 2);
+		size_t cells = static_cast<size_t>(options.width) * options.height;
+		const int blockSize = 4096, batchSize = 256;
+		std::vector<char> planes(storage == "ranks" ? static_cast<size_t>(blockSize) * cells : 0);
+		auto started = std::chrono::steady_clock::now();
+		for (int block = 0; block < boards; block += blockSize) {
+			int count = std::min(blockSize, boards - block);
+			if (storage == "ranks") { // the seeds are only used to make layouts here
+				std::vector<std::function<void()>> batches;
+				for (int first = 0; first < count; first += batchSize) {
+					batches.push_back([&, first]() {
+						GameLoop loop(Render::RenderType::HEADLESS);
+						GameArena arena(1 << 16);
+						for (int index = first; index < std::min(count, first + batchSize); index++) {
+							GameOptions seeded = options;
+							seeded.seed = firstSeed + static_cast<uint64_t>(block + index);
+							{
+								Game game(loop, seeded, &arena);
+								RandomMinePlacer placer(game.getBoard());
+								placer.placeMines(centre);
+								for (size_t cell = 0; cell < cells; cell++) {
+									planes[static_cast<size_t>(index) * cells + cell] = game.getBoard().getType(static_cast<int>(cell)) == SpaceType::MINE;
+								}
+							}
+							arena.reset();
+						}
+					});
+				}
+				WorkerPool::shared().runAll(batches);
+			}
+			for (int index = 0; index < count; index++) {
+				if (storage == "seeds") {
+					writer.addSeeded(firstSeed + static_cast<uint64_t>(block + index), centre);
+				}
+				else {
+					writer.addLayout(std::vector<char>(planes.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(index) * cells),
+						planes.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(index + 1) * cells)), centre);
+				}
+			}
+		}
+		if (!writer.close()) {
+			std::cerr << "\"" << path << "\" could not be written." << std::endl;
+			return 1;
+		}
+		double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+		CorpusReader reader;
+		if (!reader.open(path)) {
+			std::cerr << "\"" << path << "\" could not be read back." << std::endl;
+			return 1;
+		}
+		GameLoop loop(Render::RenderType::HEADLESS);
+		std::vector<std::unique_ptr<Game>> games;
+		std::vector<Point> firstClicks;
+		started = std::chrono::steady_clock::now();
+		for (size_t first = 0; first < reader.size(); first += blockSize) {
+			if (!reader.loadAll(first, std::min(static_cast<size_t>(blockSize), reader.size() - first), loop, games, firstClicks)) {
+				std::cerr << "Board " << first << " onwards could not be read back." << std::endl;
+				return 1;
+			}
+		}
+		double readSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		double bytes = static_cast<double>(file.tellg());
+		std::cout << reader.size() << " " << topologyName(options.topology) << " boards of " << options.width << "x" << options.height
+			<< " with " << reader.getOptions().mines << " mines stored as " << storage << " in " << static_cast<long long>(bytes) << " bytes" << std::endl;
+		std::cout << std::setprecision(1) << std::fixed << bytes / reader.size() << " bytes a board with the index, "
+			<< LayoutCodec::boundBits(static_cast<int>(cells), reader.getOptions().mines) / 8 << " for a layout at the combinatorial bound" << std::endl;
+		std::cout << reader.size() / writeSeconds << " boards/s written, "
+			<< reader.size() / readSeconds << " boards/s rebuilt on " << WorkerPool::shared().getThreadCount() << " threads" << std::endl;
+		return 0;
 	}
 
-	inline bool ConsoleRenderer::hasAdvancedRendering() {
-#if defined(windows) || defined(bash)
-		return true;
-#else
-		return false;
-#endif
+	/* Function Name: runLayout()
+	 *
+	 * Function Description:
+	 * This function describes a corpus, or draws one of its boards with * for a mine and o for the first click:
+	 * minesweeper --layout <corpus file> [board id]
+	 *
+	 * Parameters:
+	 * The argc and argv parameters are the command line
+	 *
+	 * return value:
+	 * the process exit code
+	 */
+	int runLayout(int argc, char** argv) {
+		if (argc < 3) {
+			std::cerr << "Use --layout <corpus file> [board id]" << std::endl;
+			return 1;
+		}
+		CorpusReader reader;
+		if (!reader.open(argv[2])) {
+			std::cerr << "\"" << argv[2] << "\" is not a valid corpus." << std::endl;
+			return 1;
+		}
+		GameOptions options = reader.getOptions();
+		if (argc < 4) {
+			std::cout << reader.size() << " " << topologyName(options.topology) << " boards of " << options.width << "x" << options.height
+				<< " with " << options.mines << " mines" << std::endl;
+			return 0;
+		}
+		size_t id = static_cast<size_t>(strtoull(argv[3], nullptr, 10));
+		GameLoop loop(Render::RenderType::HEADLESS);
+		std::unique_ptr<Game> game;
+		Point firstClick(0, 0);
+		if (!reader.load(id, loop, game, firstClick)) {
+			std::cerr << "Board " << id << " could not be read, the corpus has " << reader.size() << " boards." << std::endl;
+			return 1;
+		}
+		std::cout << "Board " << id << ", stored as " << (reader.isSeeded(id) ? "seed " + std::to_string(game->getOptions().seed) : std::string("its number"))
+			<< ", first click (" << firstClick.x + 1 << ", " << firstClick.y + 1 << ")" << std::endl;
+		for (int y = 0; y < options.height; y++) {
+			for (int x = 0; x < options.width; x++) {
+				std::cout << (Point(x, y) == firstClick ? 'o' : game->getBoard().getType(Point(x, y)) == SpaceType::MINE ? '*' : '.');
+			}
+			std::cout << std::endl;
+		}
+		return 0;
 	}
 }
 
-// STATELESS FUNCTIONS
-namespace Logic {
-	inline int64_t currentTimeSeconds() {
-		// https://stackoverflow.com/a/19555298/4634429
-		return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+#ifdef fuzzing
+// LLVMFuzzerTestOneInput(): the entry point for libFuzzer, which stops at the first input that fails a check
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	Logic::Fuzzer fuzzer;
+	if (!fuzzer.run(data, size)) {
+		std::cerr << fuzzer.getFailure() << std::endl;
+		abort();
 	}
+	return 0;
 }
-
+#else
 /* Function Name: main()
  *
  * Function Description:
- * maximizes te console window to the size of the screen and starts the loop
+ * maximizes te console window to the size of the screen and starts the loop,
+ * or runs one of the command line modes
  *
  * return value:
  * 0
  */
-int main() {
+int main(int argc, char** argv) {
+	srand(static_cast<unsigned int>(time(nullptr)));
+#ifdef tracing
+	std::atexit([] { Logic::Tracer::dump(TRACE_FILE); });
+#endif
+	unsigned int threads = 0;
+	bool pinned = false;
+	int skipped = 0; // scheduler options come before the mode and are taken off the command line
+	while (argc - skipped > 1) {
+		std::string option = argv[skipped + 1];
+		if (option == "--pin") {
+			pinned = true;
+			skipped++;
+		}
+		else if (option == "--threads" && argc - skipped > 2 && atoi(argv[skipped + 2]) > 0) {
+			threads = static_cast<unsigned int>(atoi(argv[skipped + 2]));
+			skipped += 2;
+		}
+		else {
+			break;
+		}
+	}
+	if (threads > 0 || pinned) {
+		Logic::WorkerPool::configure(threads, pinned);
+	}
+	argv[skipped] = argv[0];
+	argv += skipped;
+	argc -= skipped;
+	if (argc > 1) {
+		std::string mode = argv[1];
+		if (mode == "--calibrate") {
+			return Logic::runCalibration(argc, argv);
+		}
+		if (mode == "--tournament") {
+			return Logic::runTournament(argc, argv);
+		}
+		if (mode == "--race") {
+			return Logic::runRace(argc, argv);
+		}
+		if (mode == "--fuzz") {
+			return Logic::runFuzz(argc, argv);
+		}
+		if (mode == "--diff") {
+			return Logic::runDifferential(argc, argv);
+		}
+		if (mode == "--script") {
+			return Render::runScript(argc, argv);
+		}
+		if (mode == "--export") {
+			return Logic::runExport(argc, argv);
+		}
+		if (mode == "--convert") {
+			return Logic::runConvert(argc, argv);
+		}
+		if (mode == "--corpus") {
+			return Logic::runCorpus(argc, argv);
+		}
+		if (mode == "--layout") {
+			return Logic::runLayout(argc, argv);
+		}
+		if (mode == "--sessions") {
+#ifdef coroutines
+			return Render::runSessions(argc, argv);
+#else
+			std::cout << "--sessions needs coroutines, build with -std=c++20." << std::endl;
+			return 1;
+#endif
+		}
+#ifdef epoll_server
+		if (mode == "--server") {
+			return Server::runServer(argc, argv);
+		}
+		if (mode == "--loadgen") {
+			return Server::runLoadGenerator(argc, argv);
+		}
+#endif
+		std::cout << "Unknown option \"" << mode << "\"." << std::endl;
+		std::cout << "Usage: minesweeper [--threads count] [--pin] [mode]" << std::endl;
+		std::cout << "       minesweeper --calibrate [width] [height] [mines] [boards] [first seed] [square | torus | hex | knight]" << std::endl;
+		std::cout << "       minesweeper --tournament <solver,sampler,random> [boards] [width] [height] [mines] [first seed] [checkpoint file]" << std::endl;
+		std::cout << "       minesweeper --race <human,solver,sampler,random,...> [width] [height] [mines] [seed]" << std::endl;
+		std::cout << "       minesweeper --fuzz [seconds] [seed] [input file]" << std::endl;
+		std::cout << "       minesweeper --diff [games] [width] [height] [mines] [first seed] [square | torus | hex | knight] [moves per game]" << std::endl;
+		std::cout << "       minesweeper --diff <reproducer file>" << std::endl;
+		std::cout << "       minesweeper --script <file | -> [seed] [columns] [rows] [csv file]" << std::endl;
+		std::cout << "       minesweeper --export [json | binary | save] [width] [height] [mines] [seed] [square | torus | hex | knight]" << std::endl;
+		std::cout << "       minesweeper --convert <file | -> [json | binary | save]" << std::endl;
+		std::cout << "       minesweeper --corpus <file> [boards] [width] [height] [mines] [first seed] [square | torus | hex | knight] [seeds | ranks]" << std::endl;
+		std::cout << "       minesweeper --layout <corpus file> [board id]" << std::endl;
+		std::cout << "       minesweeper --sessions [sessions] [games each] [width] [height] [mines] [first seed] [solver | sampler | random | key file]" << std::endl;
+#ifdef epoll_server
+		std::cout << "       minesweeper --server [unix:/path | tcp:port] [workers] [hint budget ms]" << std::endl;
+		std::cout << "       minesweeper --loadgen [unix:/path | tcp:port] [clients] [games] [width] [height] [mines]" << std::endl;
+#endif
+		return 1;
+	}
+
 #ifdef windows
 	SetConsoleOutputCP(65001);
 	ShowWindow(GetConsoleWindow(), SW_MAXIMIZE);
 #endif
 
-	srand(static_cast<unsigned int>(time(nullptr)));
 	Logic::GameLoop gameLoop(Render::RenderType::CONSOLE);
 	gameLoop.start();
 
 	return 0;
 }
+#endif